@@ -0,0 +1,256 @@
+/*
+ * CloudLayer.h
+ * Billboard impostor clouds for the legacy (fixed-function) renderer
+ *
+ * A few cloud shapes are rasterized once into an RGBA texture atlas at
+ * startup (same puff layout the old sphere clouds used). Every cloud is
+ * then a camera-facing textured quad, and the whole sky is drawn with a
+ * single glDrawArrays call.
+ * - Per-cloud scale, atlas variant and drift phase
+ * - Visibility flags so day/night cloud cover can be toggled per cloud
+ * - One shared tint for time-of-day coloring
+ */
+
+#ifndef CLOUD_LAYER_H
+#define CLOUD_LAYER_H
+
+#include <GL/glut.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// ============================================================================
+// ATLAS LAYOUT
+// ============================================================================
+
+const int CLOUD_ATLAS_COLS = 2;
+const int CLOUD_ATLAS_ROWS = 2;
+const int CLOUD_VARIANTS = CLOUD_ATLAS_COLS * CLOUD_ATLAS_ROWS;
+const int CLOUD_TILE_W = 128;
+const int CLOUD_TILE_H = 64;
+const int CLOUD_PUFFS = 5;
+
+// Cloud quad size in local units (multiplied by per-cloud scale)
+// Puffs span x = -1.5..1.5 and y = -0.7..0.7, see getCloudPuff()
+const float CLOUD_HALF_W = 1.6f;
+const float CLOUD_HALF_H = 0.8f;
+
+/**
+ * Puff layout for one atlas variant.
+ * Variant 0 is the original 5-sphere cloud, the others are small
+ * variations of it so the sky does not look stamped.
+ * @param variant: Atlas tile index
+ * @param i: Puff index (0..CLOUD_PUFFS-1)
+ * @param px, py, radius: Output puff center and radius (local units)
+ */
+inline void getCloudPuff(int variant, int i, float& px, float& py, float& radius) {
+    px = -1.0f + i * 0.5f;
+    py = sin(i * 0.8f + variant * 1.3f) * 0.2f;
+    radius = (variant == 0) ? 0.5f : 0.5f * (0.85f + 0.3f * fabs(sin(i * 1.7f + variant)));
+}
+
+struct CloudBillboard {
+    float x, y, z;
+    float scale;
+    float driftPhase;
+    int variant;
+    int requiredFlags;    // 0 = always visible, otherwise any matching flag
+};
+
+// ============================================================================
+// CLOUD LAYER
+// ============================================================================
+
+class CloudLayer {
+public:
+    CloudLayer() : atlasTexture(0), density(1.0f) {
+        tint[0] = tint[1] = tint[2] = 1.0f;
+    }
+
+    /**
+     * Add a cloud to the sky
+     * @param x, y, z: Cloud center
+     * @param scale: Size multiplier (1.0 = original sphere cloud size)
+     * @param requiredFlags: Scene flags the cloud needs to be visible (0 = always)
+     */
+    void add(float x, float y, float z, float scale, int requiredFlags = 0) {
+        CloudBillboard cloud;
+        cloud.x = x;
+        cloud.y = y;
+        cloud.z = z;
+        cloud.scale = scale;
+        cloud.requiredFlags = requiredFlags;
+        cloud.variant = (int)clouds.size() % CLOUD_VARIANTS;
+        cloud.driftPhase = (float)clouds.size() * 2.39996f;  // Golden angle spreads phases
+        clouds.push_back(cloud);
+    }
+
+    void clear() { clouds.clear(); }
+    GLuint texture() const { return atlasTexture; }
+
+    void setTint(float r, float g, float b) {
+        tint[0] = r; tint[1] = g; tint[2] = b;
+    }
+
+    // Fraction of the clouds drawn (0..1), thinned evenly across the sky
+    void setDensity(float fraction) { density = fraction; }
+
+    /**
+     * Rasterize the cloud shapes into the atlas texture.
+     * Needs a current GL context (call from init()).
+     */
+    void createAtlas() {
+        const int width = CLOUD_TILE_W * CLOUD_ATLAS_COLS;
+        const int height = CLOUD_TILE_H * CLOUD_ATLAS_ROWS;
+        std::vector<unsigned char> pixels(width * height * 4, 0);
+
+        for (int v = 0; v < CLOUD_VARIANTS; v++) {
+            int tileX = (v % CLOUD_ATLAS_COLS) * CLOUD_TILE_W;
+            int tileY = (v / CLOUD_ATLAS_COLS) * CLOUD_TILE_H;
+
+            for (int ty = 0; ty < CLOUD_TILE_H; ty++) {
+                for (int tx = 0; tx < CLOUD_TILE_W; tx++) {
+                    // Texel center in cloud-local units
+                    float lx = ((tx + 0.5f) / CLOUD_TILE_W * 2.0f - 1.0f) * CLOUD_HALF_W;
+                    float ly = ((ty + 0.5f) / CLOUD_TILE_H * 2.0f - 1.0f) * CLOUD_HALF_H;
+
+                    float coverage = 0.0f;
+                    float shade = 0.0f;
+                    float nearest = -1.0f;
+                    float closest = 1e30f;      // Outside all puffs: distance to the closest one
+                    float outsideShade = 1.0f;
+
+                    for (int i = 0; i < CLOUD_PUFFS; i++) {
+                        float px, py, r;
+                        getCloudPuff(v, i, px, py, r);
+                        float dx = (lx - px) / r;
+                        float dy = (ly - py) / r;
+                        float d2 = dx*dx + dy*dy;
+                        if (d2 >= 1.0f) {
+                            // Shade of the puff's rim, so filtering and mipmaps
+                            // blend the edges with cloud color instead of black
+                            if (d2 < closest) {
+                                closest = d2;
+                                outsideShade = cloudShade(dy / sqrt(d2));
+                            }
+                            continue;
+                        }
+
+                        // Soft edge instead of the hard sphere silhouette
+                        float edge = std::min(1.0f, (1.0f - d2) * 4.0f);
+                        coverage = std::max(coverage, edge);
+
+                        // Front-most puff surface decides the shading (light from above)
+                        float nz = sqrt(1.0f - d2);
+                        if (nz * r > nearest) {
+                            nearest = nz * r;
+                            shade = cloudShade(dy);
+                        }
+                    }
+                    if (nearest < 0.0f) shade = outsideShade;
+
+                    unsigned char* p = &pixels[((tileY + ty) * width + tileX + tx) * 4];
+                    unsigned char c = (unsigned char)(std::min(1.0f, shade) * 255.0f);
+                    p[0] = c;
+                    p[1] = c;
+                    p[2] = c;
+                    p[3] = (unsigned char)(coverage * 0.8f * 255.0f);  // Same 0.8 alpha as the sphere clouds
+                }
+            }
+        }
+
+        if (!atlasTexture) glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gluBuild2DMipmaps(GL_TEXTURE_2D, 4, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    /**
+     * Draw all visible clouds as one batch of camera-facing quads.
+     * Expects the atlas bound, texturing and blending enabled by the caller
+     * (the render queue does this for the cloud item).
+     * @param sceneFlags: Currently active scene flags (day/night cover)
+     * @param time: Animation time used for drift
+     */
+    void draw(int sceneFlags, float time) {
+        // Camera right/up axes straight from the view matrix
+        GLfloat m[16];
+        glGetFloatv(GL_MODELVIEW_MATRIX, m);
+        float right[3] = {m[0], m[4], m[8]};
+        float up[3] = {m[1], m[5], m[9]};
+        float forward[3] = {m[2], m[6], m[10]};  // Points towards the viewer
+
+        // Back-to-front inside the batch (larger view depth first)
+        visible.clear();
+        for (size_t i = 0; i < clouds.size(); i++) {
+            const CloudBillboard& c = clouds[i];
+            if (c.requiredFlags && !(c.requiredFlags & sceneFlags)) continue;
+            if ((int)((i + 1) * density) == (int)(i * density)) continue;
+            float drift = sin(time * 0.1f + c.driftPhase) * 1.5f;
+            float depth = (c.x + drift) * forward[0] + c.y * forward[1] + c.z * forward[2];
+            visible.push_back(std::make_pair(depth, (int)i));
+        }
+        std::sort(visible.begin(), visible.end());
+
+        vertices.resize(visible.size() * 4 * 3);
+        texCoords.resize(visible.size() * 4 * 2);
+
+        for (size_t n = 0; n < visible.size(); n++) {
+            const CloudBillboard& c = clouds[visible[n].second];
+            float cx = c.x + sin(time * 0.1f + c.driftPhase) * 1.5f;
+            float w = CLOUD_HALF_W * c.scale;
+            float h = CLOUD_HALF_H * c.scale;
+
+            static const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+            float u0 = (float)(c.variant % CLOUD_ATLAS_COLS) / CLOUD_ATLAS_COLS;
+            float v0 = (float)(c.variant / CLOUD_ATLAS_COLS) / CLOUD_ATLAS_ROWS;
+
+            for (int k = 0; k < 4; k++) {
+                float sx = corners[k][0] * w;
+                float sy = corners[k][1] * h;
+                float* vtx = &vertices[(n * 4 + k) * 3];
+                vtx[0] = cx + right[0] * sx + up[0] * sy;
+                vtx[1] = c.y + right[1] * sx + up[1] * sy;
+                vtx[2] = c.z + right[2] * sx + up[2] * sy;
+
+                float* uv = &texCoords[(n * 4 + k) * 2];
+                uv[0] = u0 + (corners[k][0] * 0.5f + 0.5f) / CLOUD_ATLAS_COLS;
+                uv[1] = v0 + (corners[k][1] * 0.5f + 0.5f) / CLOUD_ATLAS_ROWS;
+            }
+        }
+
+        if (visible.empty()) return;
+
+        glColor4f(tint[0], tint[1], tint[2], 1.0f);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+        glTexCoordPointer(2, GL_FLOAT, 0, &texCoords[0]);
+        glDrawArrays(GL_QUADS, 0, (GLsizei)(visible.size() * 4));
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+
+private:
+    std::vector<CloudBillboard> clouds;
+    GLuint atlasTexture;
+    float tint[3];
+    float density;
+
+    // Brightness of a puff texel, lit from above (dy = -1 bottom .. 1 top).
+    // Stays close to 1 so the default white tint gives white clouds
+    static float cloudShade(float dy) {
+        return 0.9f + 0.1f * dy;
+    }
+
+    // Per-frame scratch buffers (kept to avoid reallocating every frame)
+    std::vector<std::pair<float, int> > visible;
+    std::vector<float> vertices;
+    std::vector<float> texCoords;
+};
+
+#endif // CLOUD_LAYER_H
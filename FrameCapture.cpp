@@ -0,0 +1,513 @@
+/*
+ * FrameCapture.cpp
+ * PBO readback ring, encoder workers, PNG and I420 writers
+ */
+
+#include "FrameCapture.h"
+#include <cstring>
+#include <csignal>
+
+#ifdef _WIN32
+#define CAPTURE_POPEN(cmd) _popen(cmd, "wb")
+#define CAPTURE_PCLOSE(pipe) _pclose(pipe)
+#else
+#define CAPTURE_POPEN(cmd) popen(cmd, "w")
+#define CAPTURE_PCLOSE(pipe) pclose(pipe)
+#endif
+
+// ============================================================================
+// PNG ENCODER
+// ============================================================================
+// No zlib in the build, so this writes a single fixed-Huffman deflate
+// block. Rows use the Up filter, which turns the large flat areas of the
+// scene (sky, grass, court) into runs of zeros, and runs are coded as
+// distance-1 matches. Much smaller than stored blocks and fast enough to
+// keep up at 60 FPS with a few workers.
+
+static uint32_t crcTable[256];
+
+static void initCrcTable() {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crcTable[n] = c;
+    }
+}
+
+static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t adler32(const uint8_t* data, size_t length) {
+    uint32_t a = 1, b = 0;
+    while (length > 0) {
+        size_t block = length < 5552 ? length : 5552;   // No overflow before the modulo
+        length -= block;
+        while (block--) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Deflate writes bits LSB first; Huffman codes go MSB first
+struct BitWriter {
+    std::vector<uint8_t>& out;
+    uint32_t bits;
+    int count;
+
+    explicit BitWriter(std::vector<uint8_t>& target) : out(target), bits(0), count(0) {}
+
+    void put(uint32_t value, int length) {
+        bits |= value << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back((uint8_t)bits);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void putCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+        put(reversed, length);
+    }
+
+    void flush() {
+        if (count > 0) out.push_back((uint8_t)bits);
+        bits = 0;
+        count = 0;
+    }
+};
+
+// Fixed Huffman literal/length alphabet (RFC 1951, 3.2.6)
+static void putSymbol(BitWriter& writer, int symbol) {
+    if (symbol < 144) writer.putCode(0x30 + symbol, 8);
+    else if (symbol < 256) writer.putCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280) writer.putCode(symbol - 256, 7);
+    else writer.putCode(0xC0 + symbol - 280, 8);
+}
+
+static const int LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const int LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+// Repeat of the previous byte, length 3..258
+static void putRun(BitWriter& writer, int length) {
+    int code = 28;
+    while (LENGTH_BASE[code] > length) code--;
+    putSymbol(writer, 257 + code);
+    if (LENGTH_EXTRA[code] > 0) writer.put(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+    writer.putCode(0, 5);   // Distance code 0 = distance 1
+}
+
+static void deflateRuns(const uint8_t* data, size_t length, std::vector<uint8_t>& out) {
+    BitWriter writer(out);
+    writer.put(1, 1);   // Final block
+    writer.put(1, 2);   // Fixed Huffman
+    size_t i = 0;
+    while (i < length) {
+        size_t run = 0;
+        if (i > 0) {
+            while (run < 258 && i + run < length && data[i + run] == data[i - 1]) run++;
+        }
+        if (run >= 3) {
+            putRun(writer, (int)run);
+            i += run;
+        } else {
+            putSymbol(writer, data[i]);
+            i++;
+        }
+    }
+    putSymbol(writer, 256);   // End of block
+    writer.flush();
+}
+
+static void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+static void appendChunk(std::vector<uint8_t>& out, const char* type,
+                        const uint8_t* data, size_t length) {
+    appendBigEndian(out, (uint32_t)length);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (length > 0) out.insert(out.end(), data, data + length);
+    appendBigEndian(out, crc32(&out[start], length + 4));
+}
+
+/**
+ * Encode RGBA pixels (bottom row first, as read from GL) as an RGB PNG
+ * @param scratch, compressed: Reused between frames to avoid reallocating
+ */
+static void encodePng(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& scratch,
+                      std::vector<uint8_t>& compressed, std::vector<uint8_t>& png) {
+    size_t stride = (size_t)width * 3 + 1;
+    scratch.resize(stride * height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = rgba + (size_t)(height - 1 - y) * width * 4;
+        const uint8_t* above = y > 0 ? rgba + (size_t)(height - y) * width * 4 : NULL;
+        uint8_t* dst = &scratch[y * stride];
+        *dst++ = 2;   // Up filter
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 3; c++) {
+                *dst++ = (uint8_t)(src[x * 4 + c] - (above ? above[x * 4 + c] : 0));
+            }
+        }
+    }
+
+    compressed.clear();
+    compressed.push_back(0x78);   // zlib header: deflate, 32K window
+    compressed.push_back(0x01);
+    deflateRuns(&scratch[0], scratch.size(), compressed);
+    appendBigEndian(compressed, adler32(&scratch[0], scratch.size()));
+
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    uint8_t header[13];
+    header[0] = (uint8_t)(width >> 24); header[1] = (uint8_t)(width >> 16);
+    header[2] = (uint8_t)(width >> 8);  header[3] = (uint8_t)width;
+    header[4] = (uint8_t)(height >> 24); header[5] = (uint8_t)(height >> 16);
+    header[6] = (uint8_t)(height >> 8);  header[7] = (uint8_t)height;
+    header[8] = 8;    // Bit depth
+    header[9] = 2;    // RGB
+    header[10] = header[11] = header[12] = 0;
+
+    png.clear();
+    png.insert(png.end(), SIGNATURE, SIGNATURE + 8);
+    appendChunk(png, "IHDR", header, sizeof(header));
+    appendChunk(png, "IDAT", &compressed[0], compressed.size());
+    appendChunk(png, "IEND", NULL, 0);
+}
+
+// ============================================================================
+// I420 CONVERSION
+// ============================================================================
+
+// BT.601 limited range, chroma averaged over 2x2 blocks; output top row first
+static void convertI420(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+    size_t lumaSize = (size_t)width * height;
+    size_t chromaWidth = width / 2;
+    out.resize(lumaSize + 2 * chromaWidth * (height / 2));
+    uint8_t* yPlane = &out[0];
+    uint8_t* uPlane = yPlane + lumaSize;
+    uint8_t* vPlane = uPlane + chromaWidth * (height / 2);
+
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = rgba + (size_t)(height - 1 - y) * width * 4;
+        uint8_t* dst = yPlane + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int r = src[x * 4], g = src[x * 4 + 1], b = src[x * 4 + 2];
+            dst[x] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int y = 0; y < height / 2; y++) {
+        const uint8_t* row0 = rgba + (size_t)(height - 1 - 2 * y) * width * 4;
+        const uint8_t* row1 = row0 - (size_t)width * 4;
+        for (size_t x = 0; x < chromaWidth; x++) {
+            const uint8_t* p[4] = {row0 + x * 8, row0 + x * 8 + 4, row1 + x * 8, row1 + x * 8 + 4};
+            int r = 0, g = 0, b = 0;
+            for (int i = 0; i < 4; i++) {
+                r += p[i][0];
+                g += p[i][1];
+                b += p[i][2];
+            }
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            uPlane[y * chromaWidth + x] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[y * chromaWidth + x] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+// ============================================================================
+// RESAMPLING
+// ============================================================================
+
+// Bilinear, RGBA in and out (row order is kept)
+static void resampleRgba(const uint8_t* src, int srcWidth, int srcHeight,
+                         uint8_t* dst, int dstWidth, int dstHeight) {
+    for (int y = 0; y < dstHeight; y++) {
+        float sy = (y + 0.5f) * srcHeight / dstHeight - 0.5f;
+        if (sy < 0.0f) sy = 0.0f;
+        int y0 = (int)sy;
+        int y1 = y0 + 1 < srcHeight ? y0 + 1 : y0;
+        int fy = (int)((sy - y0) * 256.0f);
+        const uint8_t* row0 = src + (size_t)y0 * srcWidth * 4;
+        const uint8_t* row1 = src + (size_t)y1 * srcWidth * 4;
+        uint8_t* out = dst + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; x++) {
+            float sx = (x + 0.5f) * srcWidth / dstWidth - 0.5f;
+            if (sx < 0.0f) sx = 0.0f;
+            int x0 = (int)sx;
+            int x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+            int fx = (int)((sx - x0) * 256.0f);
+            for (int c = 0; c < 4; c++) {
+                int top = row0[x0 * 4 + c] * (256 - fx) + row0[x1 * 4 + c] * fx;
+                int bottom = row1[x0 * 4 + c] * (256 - fx) + row1[x1 * 4 + c] * fx;
+                out[x * 4 + c] = (uint8_t)((top * (256 - fy) + bottom * fy + 32768) >> 16);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// CAPTURE
+// ============================================================================
+
+FrameCapture::FrameCapture() : capturing(false), format(CAPTURE_PNG), width(0), height(0),
+                               pipe(NULL), readWidth(0), readHeight(0), nextSlot(0),
+                               nextIndex(0), nextWrite(0),
+                               stopping(false) {
+    memset(pbos, 0, sizeof(pbos));
+    memset(fences, 0, sizeof(fences));
+    memset(slotPending, 0, sizeof(slotPending));
+    memset(&counters, 0, sizeof(counters));
+}
+
+FrameCapture::~FrameCapture() {
+    stop();
+}
+
+bool FrameCapture::start(CaptureFormat captureFormat, const char* captureTarget,
+                         int captureWidth, int captureHeight, int workerCount) {
+    stop();
+    GLExtensions& ext = loadGLExtensions();
+    if (!ext.hasPixelBuffer) {
+        fprintf(stderr, "Frame capture needs pixel buffer objects (GL 2.1)\n");
+        return false;
+    }
+    if (captureFormat == CAPTURE_YUV_PIPE && (captureWidth % 2 || captureHeight % 2)) {
+        fprintf(stderr, "YUV capture needs an even frame size (%dx%d)\n", captureWidth, captureHeight);
+        return false;
+    }
+
+    if (captureFormat == CAPTURE_YUV_PIPE) {
+#ifdef SIGPIPE
+        signal(SIGPIPE, SIG_IGN);   // Encoder exiting early must not kill the scene
+#endif
+        pipe = CAPTURE_POPEN(captureTarget);
+        if (!pipe) {
+            fprintf(stderr, "Cannot start encoder: %s\n", captureTarget);
+            return false;
+        }
+    }
+
+    static bool crcReady = false;
+    if (!crcReady) {
+        initCrcTable();
+        crcReady = true;
+    }
+
+    format = captureFormat;
+    target.assign(captureTarget, captureTarget + strlen(captureTarget) + 1);
+    width = captureWidth;
+    height = captureHeight;
+
+    ext.genBuffers(CAPTURE_RING_SIZE, pbos);
+    for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+        slotPending[i] = false;
+        fences[i] = NULL;
+    }
+    resizeRing(width, height);
+    nextSlot = 0;
+    nextIndex = 0;
+    nextWrite = 0;
+    stopping = false;
+    memset(&counters, 0, sizeof(counters));
+
+    if (workerCount <= 0) workerCount = (int)std::thread::hardware_concurrency() / 2;
+    if (workerCount < 1) workerCount = 1;
+    if (workerCount > CAPTURE_MAX_WORKERS) workerCount = CAPTURE_MAX_WORKERS;
+    for (int i = 0; i < workerCount; i++) {
+        workers.push_back(std::thread(&FrameCapture::workerLoop, this));
+    }
+    capturing = true;
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!capturing) return;
+    GLExtensions& ext = glExt();
+
+    readPendingSlots();
+    ext.deleteBuffers(CAPTURE_RING_SIZE, pbos);
+    memset(pbos, 0, sizeof(pbos));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    workers.clear();
+
+    if (pipe) {
+        CAPTURE_PCLOSE(pipe);
+        pipe = NULL;
+    }
+    for (size_t i = 0; i < freeFrames.size(); i++) delete freeFrames[i];
+    freeFrames.clear();
+    capturing = false;
+}
+
+CaptureStats FrameCapture::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void FrameCapture::captureFrame(int frameWidth, int frameHeight) {
+    if (!capturing || frameWidth <= 0 || frameHeight <= 0) return;
+    if (frameWidth != readWidth || frameHeight != readHeight) resizeRing(frameWidth, frameHeight);
+    GLExtensions& ext = glExt();
+
+    // Start the copy into this frame's PBO - returns without waiting
+    int slot = nextSlot;
+    ext.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    glReadPixels(0, 0, readWidth, readHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    ext.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (ext.hasSync) fences[slot] = ext.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slotPending[slot] = true;
+
+    // Collect the oldest copy, issued CAPTURE_RING_SIZE - 1 frames ago
+    nextSlot = (slot + 1) % CAPTURE_RING_SIZE;
+    if (slotPending[nextSlot]) readSlot(nextSlot);
+}
+
+// Oldest pending slot first, so frame numbers stay in order
+void FrameCapture::readPendingSlots() {
+    for (int k = 0; k < CAPTURE_RING_SIZE; k++) {
+        int slot = (nextSlot + k) % CAPTURE_RING_SIZE;
+        if (slotPending[slot]) readSlot(slot);
+    }
+}
+
+// Collect the copies still in flight at the old size, then reallocate
+void FrameCapture::resizeRing(int frameWidth, int frameHeight) {
+    GLExtensions& ext = glExt();
+    readPendingSlots();
+    readWidth = frameWidth;
+    readHeight = frameHeight;
+    size_t frameBytes = (size_t)readWidth * readHeight * 4;
+    for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+        ext.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        ext.bufferData(GL_PIXEL_PACK_BUFFER, frameBytes, NULL, GL_STREAM_READ);
+    }
+    ext.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::readSlot(int slot) {
+    GLExtensions& ext = glExt();
+    bool stalled = false;
+    if (fences[slot]) {
+        stalled = ext.clientWaitSync(fences[slot], 0, 0) == GL_TIMEOUT_EXPIRED;
+        ext.deleteSync(fences[slot]);
+        fences[slot] = NULL;
+    }
+    slotPending[slot] = false;
+
+    Frame* frame = NULL;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.captured++;
+        if (stalled) counters.stalls++;
+        if ((int)queue.size() >= CAPTURE_MAX_PENDING) {
+            counters.dropped++;
+        } else if (!freeFrames.empty()) {
+            frame = freeFrames.back();
+            freeFrames.pop_back();
+        } else {
+            frame = new Frame();
+        }
+    }
+    if (!frame) return;
+
+    ext.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    const uint8_t* pixels = (const uint8_t*)ext.mapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (pixels) {
+        frame->width = readWidth;
+        frame->height = readHeight;
+        frame->pixels.assign(pixels, pixels + (size_t)readWidth * readHeight * 4);
+        ext.unmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    ext.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pixels) {
+        counters.dropped++;
+        freeFrames.push_back(frame);
+        return;
+    }
+    frame->index = nextIndex++;
+    queue.push_back(frame);
+    wake.notify_one();
+}
+
+void FrameCapture::workerLoop() {
+    EncodeBuffers buffers;
+    for (;;) {
+        Frame* frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (queue.empty() && !stopping) wake.wait(lock);
+            if (queue.empty()) break;
+            frame = queue.front();
+            queue.pop_front();
+        }
+        writeFrame(frame, buffers);
+        std::lock_guard<std::mutex> lock(mutex);
+        freeFrames.push_back(frame);
+    }
+}
+
+void FrameCapture::writeFrame(Frame* frame, EncodeBuffers& buffers) {
+    std::vector<uint8_t>& encoded = buffers.output;
+    bool ok = false;
+
+    const uint8_t* pixels = &frame->pixels[0];
+    bool resampled = frame->width != width || frame->height != height;
+    if (resampled) {
+        buffers.resampled.resize((size_t)width * height * 4);
+        resampleRgba(pixels, frame->width, frame->height, &buffers.resampled[0], width, height);
+        pixels = &buffers.resampled[0];
+    }
+
+    if (format == CAPTURE_PNG) {
+        encodePng(pixels, width, height, buffers.filtered, buffers.compressed, encoded);
+        char path[1024];
+        snprintf(path, sizeof(path), &target[0], (int)frame->index);
+        FILE* file = fopen(path, "wb");
+        if (file) {
+            ok = fwrite(&encoded[0], 1, encoded.size(), file) == encoded.size();
+            fclose(file);
+        }
+    } else {
+        // Convert in parallel, write in frame order
+        convertI420(pixels, width, height, encoded);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (nextWrite != frame->index) writeTurn.wait(lock);
+        lock.unlock();
+        ok = fwrite(&encoded[0], 1, encoded.size(), pipe) == encoded.size();
+        lock.lock();
+        nextWrite++;
+        writeTurn.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ok) counters.written++;
+    if (resampled) counters.resampled++;
+}
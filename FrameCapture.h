@@ -0,0 +1,131 @@
+/*
+ * FrameCapture.h
+ * Asynchronous frame capture to disk (demo footage)
+ *
+ * Each captured frame is read back into one of CAPTURE_RING_SIZE pixel
+ * buffer objects. glReadPixels into a PBO returns immediately; the buffer
+ * is mapped CAPTURE_RING_SIZE - 1 frames later, when the copy has long
+ * finished, so the render thread never waits for the GPU.
+ * The mapped pixels are copied into a pooled frame and handed to worker
+ * threads, which encode and write them:
+ * - CAPTURE_PNG: one PNG file per frame (name from a printf pattern)
+ * - CAPTURE_YUV_PIPE: raw I420 frames, in order, on the stdin of an
+ *   encoder command, e.g.
+ *   ffmpeg -f rawvideo -pix_fmt yuv420p -s 1280x720 -r 60 -i - out.mp4
+ * If the workers fall CAPTURE_MAX_PENDING frames behind, new frames are
+ * dropped (and counted) instead of slowing the scene down.
+ * The ring follows the window size: after a resize the PBOs are
+ * reallocated, and frames that no longer match the capture size are
+ * resampled to it, so the files and the encoder stream keep one size.
+ * Works with any current context, including the offscreen EGL one.
+ */
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include "GLExtensions.h"
+#include <stdint.h>
+#include <cstdio>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+const int CAPTURE_RING_SIZE = 4;        // PBOs in flight
+const int CAPTURE_MAX_PENDING = 8;      // Frames queued for the workers
+const int CAPTURE_MAX_WORKERS = 4;
+
+enum CaptureFormat {
+    CAPTURE_PNG,
+    CAPTURE_YUV_PIPE
+};
+
+struct CaptureStats {
+    long long captured;     // Frames read back
+    long long written;      // Frames encoded and written
+    long long dropped;      // Workers were behind
+    long long resampled;    // Window size differed from the capture size
+    long long stalls;       // PBO mapped before its copy had finished
+};
+
+class FrameCapture {
+public:
+    FrameCapture();
+    ~FrameCapture();
+
+    /**
+     * Create the PBO ring and start the workers. Needs a current GL context.
+     * @param format: PNG files or raw I420 to a pipe
+     * @param target: CAPTURE_PNG - printf pattern with the frame number,
+     *                e.g. "capture/frame_%05d.png" (directory must exist);
+     *                CAPTURE_YUV_PIPE - shell command reading frames on stdin
+     * @param width, height: Output size of every frame (YUV needs even sizes)
+     * @param workers: Encoder threads, 0 = pick from the core count
+     * @return false if PBOs are unsupported or the pipe cannot be opened
+     */
+    bool start(CaptureFormat format, const char* target, int width, int height, int workers = 0);
+
+    // Read back the frames still in the ring, finish all writes
+    void stop();
+
+    bool isCapturing() const { return capturing; }
+    CaptureStats stats() const;
+
+    /**
+     * Queue a readback of the current read buffer (call before the swap).
+     * @param width, height: Read buffer size; a new size resizes the ring
+     */
+    void captureFrame(int width, int height);
+
+private:
+    struct Frame {
+        long long index;
+        int width, height;             // As read back, scaled to the capture size on write
+        std::vector<uint8_t> pixels;   // RGBA, bottom row first (GL order)
+    };
+
+    // Per-worker encoder memory, reused between frames
+    struct EncodeBuffers {
+        std::vector<uint8_t> resampled;
+        std::vector<uint8_t> filtered;
+        std::vector<uint8_t> compressed;
+        std::vector<uint8_t> output;
+    };
+
+    bool capturing;
+    CaptureFormat format;
+    std::vector<char> target;
+    int width, height;      // Output size
+    FILE* pipe;
+
+    // Render thread: PBO ring
+    GLuint pbos[CAPTURE_RING_SIZE];
+    GLsync fences[CAPTURE_RING_SIZE];
+    bool slotPending[CAPTURE_RING_SIZE];
+    int readWidth, readHeight;           // Size the PBOs are allocated for
+    int nextSlot;
+    long long nextIndex;
+
+    // Shared with the workers
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable wake;        // Frames queued or stopping
+    std::condition_variable writeTurn;   // Pipe output moved on a frame
+    std::deque<Frame*> queue;
+    std::vector<Frame*> freeFrames;
+    long long nextWrite;                 // Pipe: next frame index to write
+    bool stopping;
+    CaptureStats counters;
+
+    void readPendingSlots();
+    void resizeRing(int frameWidth, int frameHeight);
+    void readSlot(int slot);
+    void workerLoop();
+    void writeFrame(Frame* frame, EncodeBuffers& buffers);
+
+    FrameCapture(const FrameCapture&);
+    FrameCapture& operator=(const FrameCapture&);
+};
+
+#endif // FRAME_CAPTURE_H
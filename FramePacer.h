@@ -0,0 +1,208 @@
+/*
+ * FramePacer.h
+ * Frame scheduling on a monotonic clock, with frame-time jitter statistics
+ *
+ * The idle callback asks the pacer whether the next frame is due; the
+ * pacer sleeps until its deadline and then lets exactly one redisplay
+ * through until that frame has started, so key presses and idle calls
+ * never render a frame twice.
+ * - Deadlines advance by a fixed period (not "now + period"), so timer
+ *   and sleep error do not add up; after a long hitch the schedule
+ *   restarts instead of rendering a burst of frames to catch up
+ * - The OS sleep only covers most of the wait; the last
+ *   FRAME_PACER_SPIN_MS are spent yielding, which lands within a few
+ *   microseconds of the deadline
+ * - With vsync (swap interval 1) the swap blocks instead; a target rate
+ *   of 0 leaves the pacing to the display or runs uncapped
+ * Frame-to-frame deltas of the last FRAME_PACER_HISTORY frames are kept
+ * for the mean, standard deviation and 99th percentile.
+ */
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include "GLExtensions.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>   // timeBeginPeriod (link with -lwinmm)
+#endif
+
+const int FRAME_PACER_HISTORY = 1024;     // Deltas kept for the statistics
+const double FRAME_PACER_SPIN_MS = 1.5;   // Yield instead of sleep this close to a deadline
+const double FRAME_PACER_LATE_RATIO = 1.5; // A delta this many periods long is a missed frame
+
+struct FramePacingStats {
+    long long frames;       // Deltas measured since start
+    long long late;         // Of those, longer than FRAME_PACER_LATE_RATIO periods
+    double meanMs;          // Over the history window
+    double stdDevMs;
+    double p99Ms;
+    double maxMs;
+};
+
+// ============================================================================
+// FRAME PACER
+// ============================================================================
+
+class FramePacer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    FramePacer() : periodSeconds(0.0), pending(false), started(false), scheduled(false),
+                   frames(0), late(0), historyNext(0), timerPeriodSet(false) {
+        history.reserve(FRAME_PACER_HISTORY);
+    }
+
+    ~FramePacer() {
+#ifdef _WIN32
+        if (timerPeriodSet) timeEndPeriod(1);
+#endif
+    }
+
+    // Frames per second to schedule, 0 = no pacing (vsync or uncapped)
+    void setTargetRate(int framesPerSecond) {
+        periodSeconds = framesPerSecond > 0 ? 1.0 / framesPerSecond : 0.0;
+        scheduled = false;
+#ifdef _WIN32
+        // Default Windows sleep granularity is ~15.6 ms - far too coarse
+        if (periodSeconds > 0.0 && !timerPeriodSet) timerPeriodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+#endif
+    }
+
+    /**
+     * Set the buffer swap interval (needs a current GL context)
+     * @param interval: 1 = wait for vertical blank, 0 = swap immediately
+     * @return false if the driver offers no way to set it
+     */
+    static bool setSwapInterval(int interval) {
+#ifdef _WIN32
+        typedef BOOL (WINAPI *SwapIntervalProc)(int);
+        SwapIntervalProc swapInterval = (SwapIntervalProc)defaultGLProcLoader("wglSwapIntervalEXT");
+        return swapInterval && swapInterval(interval);
+#else
+        typedef int (*SwapIntervalProc)(int);
+        SwapIntervalProc swapInterval = (SwapIntervalProc)defaultGLProcLoader("glXSwapIntervalMESA");
+        if (!swapInterval) swapInterval = (SwapIntervalProc)defaultGLProcLoader("glXSwapIntervalSGI");
+        return swapInterval && swapInterval(interval) == 0;
+#endif
+    }
+
+    /**
+     * Wait for the next frame's deadline (from the idle callback)
+     * @return true once per frame: post the redisplay now
+     */
+    bool waitForNextFrame() {
+        if (pending) return false;    // Already posted, frame not started yet
+        if (periodSeconds > 0.0) {
+            Clock::time_point now = Clock::now();
+            if (!scheduled) {
+                deadline = now;
+                scheduled = true;
+            }
+            sleepUntil(deadline);
+            deadline += period();
+            // More than a frame behind: start over rather than catch up in a burst
+            if (Clock::now() > deadline) deadline = Clock::now() + period();
+        }
+        pending = true;
+        return true;
+    }
+
+    /**
+     * Mark the start of a frame (first thing in display)
+     * @return Seconds since the previous frame started (0 for the first)
+     */
+    float beginFrame() {
+        pending = false;
+        Clock::time_point now = Clock::now();
+        if (!started) {
+            started = true;
+            lastFrame = now;
+            return 0.0f;
+        }
+        double delta = std::chrono::duration<double>(now - lastFrame).count();
+        lastFrame = now;
+        recordDelta(delta * 1000.0);
+        return (float)delta;
+    }
+
+    // Statistics over the last FRAME_PACER_HISTORY deltas
+    FramePacingStats stats() const {
+        FramePacingStats s = {};
+        s.frames = frames;
+        s.late = late;
+        if (history.empty()) return s;
+        double sum = 0.0;
+        for (size_t i = 0; i < history.size(); i++) sum += history[i];
+        s.meanMs = sum / history.size();
+        double variance = 0.0;
+        for (size_t i = 0; i < history.size(); i++) {
+            double d = history[i] - s.meanMs;
+            variance += d * d;
+        }
+        s.stdDevMs = std::sqrt(variance / history.size());
+        std::vector<double> sorted(history);
+        size_t p99 = (sorted.size() * 99) / 100;
+        if (p99 >= sorted.size()) p99 = sorted.size() - 1;
+        std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+        s.p99Ms = sorted[p99];
+        s.maxMs = *std::max_element(sorted.begin() + p99, sorted.end());
+        return s;
+    }
+
+    // One line, e.g. "1800 frames, 16.67 ms mean, 0.21 ms std dev, 17.10 ms p99, 2 late"
+    void describe(char* text, size_t size) const {
+        FramePacingStats s = stats();
+        snprintf(text, size, "%lld frames, %.2f ms mean, %.2f ms std dev, %.2f ms p99, %.2f ms max, %lld late",
+                 s.frames, s.meanMs, s.stdDevMs, s.p99Ms, s.maxMs, s.late);
+    }
+
+private:
+    double periodSeconds;
+    bool pending;             // Redisplay posted, display not called yet
+    bool started;
+    bool scheduled;           // deadline is valid
+    Clock::time_point deadline;
+    Clock::time_point lastFrame;
+
+    long long frames;
+    long long late;
+    std::vector<double> history;   // Frame deltas in ms (ring once full)
+    size_t historyNext;
+    bool timerPeriodSet;
+
+    Clock::duration period() const {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(periodSeconds));
+    }
+
+    void sleepUntil(Clock::time_point target) {
+        Clock::duration spin = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(FRAME_PACER_SPIN_MS));
+        Clock::time_point now = Clock::now();
+        if (target - now > spin) std::this_thread::sleep_for(target - now - spin);
+        while (Clock::now() < target) std::this_thread::yield();
+    }
+
+    void recordDelta(double ms) {
+        frames++;
+        if (periodSeconds > 0.0 && ms > periodSeconds * 1000.0 * FRAME_PACER_LATE_RATIO) late++;
+        if ((int)history.size() < FRAME_PACER_HISTORY) {
+            history.push_back(ms);
+        } else {
+            history[historyNext] = ms;
+            historyNext = (historyNext + 1) % FRAME_PACER_HISTORY;
+        }
+    }
+
+    FramePacer(const FramePacer&);
+    FramePacer& operator=(const FramePacer&);
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,454 @@
+/*
+ * FrameProfiler.h
+ * CPU zone timers, GPU timer queries and an on-screen overlay
+ *
+ * - CPU zones are named scopes (nestable) timed with steady_clock;
+ *   a zone entered several times per frame accumulates
+ * - GPU zones wrap whole passes in GL_TIME_ELAPSED queries. Results are
+ *   read PROFILER_QUERY_LATENCY frames later so the CPU never waits
+ * - The last PROFILER_HISTORY frames are kept in a ring buffer and shown
+ *   as a frame-time graph plus a per-zone table
+ * - Other systems can post a status line and events (e.g. quality
+ *   changes); events are marked on the graph and listed below the tables
+ * Nothing is measured while the profiler is disabled.
+ */
+
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include "GLExtensions.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+const int PROFILER_MAX_ZONES = 32;
+const int PROFILER_MAX_GPU_ZONES = 8;
+const int PROFILER_MAX_DEPTH = 16;
+const int PROFILER_HISTORY = 240;        // Frames kept for graph and averages
+const int PROFILER_QUERY_LATENCY = 4;    // Frames before a GPU result is read
+const int PROFILER_MAX_EVENTS = 6;       // Most recent events listed
+
+struct ProfilerFrame {
+    float frameMs;                          // Time since the previous frame started
+    float cpuMs[PROFILER_MAX_ZONES];
+    float gpuMs[PROFILER_MAX_GPU_ZONES];    // < 0 = result not available
+};
+
+// ============================================================================
+// FRAME PROFILER
+// ============================================================================
+
+class FrameProfiler {
+public:
+    FrameProfiler() : enabled(false), gpuReady(false), frameNumber(0), framesRecorded(0),
+                      zoneCount(0), gpuZoneCount(0), stackDepth(0), activeGpuZone(-1),
+                      frameStartValid(false), eventCount(0) {
+        memset(queryIssued, 0, sizeof(queryIssued));
+        status[0] = '\0';
+        resetCurrent();
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    // Turning the profiler on starts a fresh history
+    void setEnabled(bool on) {
+        if (on && !enabled) {
+            framesRecorded = 0;
+            frameStartValid = false;
+            memset(queryIssued, 0, sizeof(queryIssued));
+        }
+        enabled = on;
+    }
+
+    /**
+     * Create the GPU query pool. Needs a current GL context.
+     * Without timer query support only CPU zones are recorded.
+     */
+    void initGpu() {
+        GLExtensions& ext = loadGLExtensions();
+        if (!ext.hasTimerQuery || gpuReady) return;
+        ext.genQueries(PROFILER_QUERY_LATENCY * PROFILER_MAX_GPU_ZONES, &queries[0][0]);
+        gpuReady = true;
+    }
+
+    bool hasGpuTimers() const { return gpuReady; }
+
+    void beginFrame() {
+        if (!enabled) return;
+        double now = nowMs();
+        current.frameMs = frameStartValid ? (float)(now - frameStart) : 0.0f;
+        frameStart = now;
+        frameStartValid = true;
+        collectGpuResults();
+    }
+
+    // Store this frame in the history ring
+    void endFrame() {
+        if (!enabled) return;
+        endGpuZone();
+        while (stackDepth > 0) endZone();
+        history[frameNumber % PROFILER_HISTORY] = current;
+        frameNumber++;
+        if (framesRecorded < PROFILER_HISTORY) framesRecorded++;
+        resetCurrent();
+    }
+
+    // Start a named CPU zone (name must outlive the profiler, e.g. a literal)
+    void beginZone(const char* name) {
+        if (!enabled || stackDepth >= PROFILER_MAX_DEPTH) return;
+        int zone = findZone(name, zoneNames, zoneDepth, zoneCount, PROFILER_MAX_ZONES, stackDepth);
+        stackZone[stackDepth] = zone;
+        stackStart[stackDepth] = nowMs();
+        stackDepth++;
+    }
+
+    void endZone() {
+        if (!enabled || stackDepth == 0) return;
+        stackDepth--;
+        int zone = stackZone[stackDepth];
+        if (zone >= 0) current.cpuMs[zone] += (float)(nowMs() - stackStart[stackDepth]);
+    }
+
+    /**
+     * Start timing a GPU pass. GPU zones do not nest: starting one ends
+     * the previous. Only the first span of a zone in a frame is timed.
+     */
+    void beginGpuZone(const char* name) {
+        if (!enabled || !gpuReady) return;
+        endGpuZone();
+        int zone = findZone(name, gpuZoneNames, NULL, gpuZoneCount, PROFILER_MAX_GPU_ZONES, 0);
+        int slot = frameNumber % PROFILER_QUERY_LATENCY;
+        if (zone < 0 || queryIssued[slot][zone]) return;
+        glExt().beginQuery(GL_TIME_ELAPSED, queries[slot][zone]);
+        queryIssued[slot][zone] = true;
+        activeGpuZone = zone;
+    }
+
+    void endGpuZone() {
+        if (activeGpuZone < 0) return;
+        glExt().endQuery(GL_TIME_ELAPSED);
+        activeGpuZone = -1;
+    }
+
+    // Line shown under the frame time (copied; "" hides it)
+    void setStatus(const char* text) {
+        snprintf(status, sizeof(status), "%s", text);
+    }
+
+    /**
+     * Record something that happened this frame (copied). Kept while the
+     * profiler is off too, so opening the overlay shows recent history.
+     */
+    void markEvent(const char* text) {
+        ProfilerEvent& event = events[eventCount % PROFILER_MAX_EVENTS];
+        event.frame = enabled ? frameNumber : -1;
+        snprintf(event.text, sizeof(event.text), "%s", text);
+        eventCount++;
+    }
+
+    /**
+     * Draw the graph and zone table in the top-left corner.
+     * Saves and restores all GL state it touches.
+     * @param width, height: Window size in pixels
+     */
+    void drawOverlay(int width, int height) {
+        if (!enabled) return;
+
+        glPushAttrib(GL_ALL_ATTRIB_BITS);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, width, 0, height, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glDisable(GL_LIGHTING);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_TEXTURE_2D);
+        glDisable(GL_FOG);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        const float left = 10.0f;
+        const float top = height - 10.0f;
+        const float graphH = 80.0f;
+        const float graphMs = 50.0f;    // Graph ceiling
+        const float lineH = 14.0f;
+        int shownEvents = eventCount < PROFILER_MAX_EVENTS ? eventCount : PROFILER_MAX_EVENTS;
+        int rows = 4 + zoneCount + (gpuReady ? gpuZoneCount + 1 : 1) +
+                   (status[0] ? 1 : 0) + (shownEvents > 0 ? shownEvents + 2 : 0);
+        float panelH = graphH + 16.0f + rows * lineH;
+        float panelW = 400.0f;
+
+        // Background panel
+        glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+        glBegin(GL_QUADS);
+        glVertex2f(left, top);
+        glVertex2f(left + panelW, top);
+        glVertex2f(left + panelW, top - panelH);
+        glVertex2f(left, top - panelH);
+        glEnd();
+
+        // Frame-time bars, oldest on the left
+        float graphX = left + 8.0f;
+        float graphY = top - 8.0f - graphH;
+        float barW = (panelW - 16.0f) / PROFILER_HISTORY;
+        glBegin(GL_QUADS);
+        for (int i = 0; i < framesRecorded; i++) {
+            const ProfilerFrame& f = recentFrame(framesRecorded - 1 - i);
+            float ms = f.frameMs < graphMs ? f.frameMs : graphMs;
+            if (f.frameMs < 1000.0f / 60.0f) glColor4f(0.2f, 0.8f, 0.2f, 0.9f);
+            else if (f.frameMs < 1000.0f / 30.0f) glColor4f(0.9f, 0.8f, 0.1f, 0.9f);
+            else glColor4f(0.9f, 0.2f, 0.1f, 0.9f);
+            float x = graphX + (PROFILER_HISTORY - framesRecorded + i) * barW;
+            float h = ms / graphMs * graphH;
+            glVertex2f(x, graphY);
+            glVertex2f(x + barW, graphY);
+            glVertex2f(x + barW, graphY + h);
+            glVertex2f(x, graphY + h);
+        }
+        glEnd();
+
+        // GPU total on top of the bars
+        if (gpuReady) {
+            glColor4f(0.4f, 0.7f, 1.0f, 1.0f);
+            glBegin(GL_LINE_STRIP);
+            for (int i = 0; i < framesRecorded; i++) {
+                float gpu = gpuTotal(recentFrame(framesRecorded - 1 - i));
+                if (gpu < 0.0f) continue;
+                if (gpu > graphMs) gpu = graphMs;
+                float x = graphX + (PROFILER_HISTORY - framesRecorded + i + 0.5f) * barW;
+                glVertex2f(x, graphY + gpu / graphMs * graphH);
+            }
+            glEnd();
+        }
+
+        // Event markers
+        glColor4f(1.0f, 0.3f, 1.0f, 0.9f);
+        glBegin(GL_LINES);
+        for (int i = 0; i < shownEvents; i++) {
+            const ProfilerEvent& event = recentEvent(i);
+            long long age = frameNumber - 1 - event.frame;
+            if (event.frame < 0 || age >= framesRecorded) continue;
+            float x = graphX + (PROFILER_HISTORY - 1 - age + 0.5f) * barW;
+            glVertex2f(x, graphY);
+            glVertex2f(x, graphY + graphH);
+        }
+        glEnd();
+
+        // 60 and 30 fps budget lines
+        glColor4f(1.0f, 1.0f, 1.0f, 0.35f);
+        glBegin(GL_LINES);
+        for (int k = 1; k <= 2; k++) {
+            float y = graphY + (k * 1000.0f / 60.0f) / graphMs * graphH;
+            glVertex2f(graphX, y);
+            glVertex2f(graphX + PROFILER_HISTORY * barW, y);
+        }
+        glEnd();
+
+        // Table
+        char line[96];
+        float y = graphY - 8.0f - lineH;
+        float frameAvg, frameMax;
+        averageFrame(frameAvg, frameMax);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        snprintf(line, sizeof(line), "Frame %6.2f ms avg %6.2f max (%.0f fps)",
+                 frameAvg, frameMax, frameAvg > 0.0f ? 1000.0f / frameAvg : 0.0f);
+        drawText(left + 8.0f, y, line);
+        if (status[0]) {
+            y -= lineH;
+            glColor3f(1.0f, 0.6f, 1.0f);
+            drawText(left + 8.0f, y, status);
+        }
+        y -= lineH * 1.5f;
+
+        glColor3f(0.8f, 0.8f, 0.8f);
+        drawText(left + 8.0f, y, "CPU zone              avg ms   max ms");
+        y -= lineH;
+        for (int z = 0; z < zoneCount; z++) {
+            float avg, peak;
+            averageZone(z, false, avg, peak);
+            char name[32];
+            snprintf(name, sizeof(name), "%*s%s", zoneDepth[z] * 2, "", zoneNames[z]);
+            snprintf(line, sizeof(line), "%-20.20s %7.3f  %7.3f", name, avg, peak);
+            glColor3f(1.0f, 1.0f, 1.0f);
+            drawText(left + 8.0f, y, line);
+            y -= lineH;
+        }
+
+        y -= lineH * 0.5f;
+        glColor3f(0.4f, 0.7f, 1.0f);
+        if (!gpuReady) {
+            drawText(left + 8.0f, y, "GPU timers not available");
+        } else {
+            drawText(left + 8.0f, y, "GPU pass              avg ms   max ms");
+            y -= lineH;
+            for (int z = 0; z < gpuZoneCount; z++) {
+                float avg, peak;
+                averageZone(z, true, avg, peak);
+                snprintf(line, sizeof(line), "%-20.20s %7.3f  %7.3f", gpuZoneNames[z], avg, peak);
+                drawText(left + 8.0f, y, line);
+                y -= lineH;
+            }
+        }
+
+        if (shownEvents > 0) {
+            y -= lineH * 0.5f;
+            glColor3f(1.0f, 0.6f, 1.0f);
+            drawText(left + 8.0f, y, "Events (newest first)");
+            y -= lineH;
+            for (int i = 0; i < shownEvents; i++) {
+                drawText(left + 8.0f, y, recentEvent(i).text);
+                y -= lineH;
+            }
+        }
+
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopMatrix();
+        glPopAttrib();
+    }
+
+private:
+    bool enabled;
+    bool gpuReady;
+    long long frameNumber;
+    int framesRecorded;
+
+    // Zone registry (index = column in ProfilerFrame)
+    const char* zoneNames[PROFILER_MAX_ZONES];
+    int zoneDepth[PROFILER_MAX_ZONES];          // Nesting level when first seen
+    int zoneCount;
+    const char* gpuZoneNames[PROFILER_MAX_GPU_ZONES];
+    int gpuZoneCount;
+
+    // Open CPU zones
+    int stackZone[PROFILER_MAX_DEPTH];
+    double stackStart[PROFILER_MAX_DEPTH];
+    int stackDepth;
+
+    // GPU query pool, one set per in-flight frame
+    GLuint queries[PROFILER_QUERY_LATENCY][PROFILER_MAX_GPU_ZONES];
+    bool queryIssued[PROFILER_QUERY_LATENCY][PROFILER_MAX_GPU_ZONES];
+    int activeGpuZone;
+
+    double frameStart;
+    bool frameStartValid;
+
+    struct ProfilerEvent {
+        long long frame;        // -1 = happened while the profiler was off
+        char text[48];
+    };
+    ProfilerEvent events[PROFILER_MAX_EVENTS];
+    int eventCount;
+    char status[64];
+    ProfilerFrame current;
+    ProfilerFrame history[PROFILER_HISTORY];
+
+    static double nowMs() {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Zones are usually string literals, so the pointer check almost always hits
+    static int findZone(const char* name, const char** names, int* depths,
+                        int& count, int maxCount, int depth) {
+        for (int i = 0; i < count; i++) {
+            if (names[i] == name || strcmp(names[i], name) == 0) return i;
+        }
+        if (count >= maxCount) return -1;
+        names[count] = name;
+        if (depths) depths[count] = depth;
+        return count++;
+    }
+
+    void resetCurrent() {
+        current.frameMs = 0.0f;
+        for (int i = 0; i < PROFILER_MAX_ZONES; i++) current.cpuMs[i] = 0.0f;
+        for (int i = 0; i < PROFILER_MAX_GPU_ZONES; i++) current.gpuMs[i] = -1.0f;
+    }
+
+    // 0 = newest recorded frame
+    const ProfilerFrame& recentFrame(int age) const {
+        return history[(frameNumber - 1 - age) % PROFILER_HISTORY];
+    }
+
+    // 0 = newest event
+    const ProfilerEvent& recentEvent(int age) const {
+        return events[(eventCount - 1 - age) % PROFILER_MAX_EVENTS];
+    }
+
+    // Read back the queries issued PROFILER_QUERY_LATENCY frames ago
+    void collectGpuResults() {
+        if (!gpuReady) return;
+        int slot = frameNumber % PROFILER_QUERY_LATENCY;
+        long long issuedFrame = frameNumber - PROFILER_QUERY_LATENCY;
+        for (int z = 0; z < PROFILER_MAX_GPU_ZONES; z++) {
+            if (!queryIssued[slot][z]) continue;
+            queryIssued[slot][z] = false;
+            GLint available = 0;
+            glExt().getQueryObjectiv(queries[slot][z], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available || issuedFrame < 0 || frameNumber - issuedFrame > framesRecorded) continue;
+            GLuint64 ns = 0;
+            glExt().getQueryObjectui64v(queries[slot][z], GL_QUERY_RESULT, &ns);
+            history[issuedFrame % PROFILER_HISTORY].gpuMs[z] = (float)(ns / 1.0e6);
+        }
+    }
+
+    float gpuTotal(const ProfilerFrame& f) const {
+        float total = -1.0f;
+        for (int z = 0; z < gpuZoneCount; z++) {
+            if (f.gpuMs[z] >= 0.0f) total = (total < 0.0f ? 0.0f : total) + f.gpuMs[z];
+        }
+        return total;
+    }
+
+    void averageFrame(float& avg, float& peak) const {
+        avg = peak = 0.0f;
+        int n = 0;
+        for (int i = 0; i < framesRecorded; i++) {
+            float ms = recentFrame(i).frameMs;
+            if (ms <= 0.0f) continue;    // First frame after enabling has no interval
+            avg += ms;
+            if (ms > peak) peak = ms;
+            n++;
+        }
+        if (n > 0) avg /= n;
+    }
+
+    void averageZone(int zone, bool gpu, float& avg, float& peak) const {
+        avg = peak = 0.0f;
+        int n = 0;
+        for (int i = 0; i < framesRecorded; i++) {
+            float ms = gpu ? recentFrame(i).gpuMs[zone] : recentFrame(i).cpuMs[zone];
+            if (ms < 0.0f) continue;
+            avg += ms;
+            if (ms > peak) peak = ms;
+            n++;
+        }
+        if (n > 0) avg /= n;
+    }
+
+    static void drawText(float x, float y, const char* text) {
+        glRasterPos2f(x, y);
+        for (const char* c = text; *c; c++) {
+            glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *c);
+        }
+    }
+};
+
+// Times the enclosing block as a CPU zone
+class ScopedCpuZone {
+public:
+    ScopedCpuZone(FrameProfiler& p, const char* name) : profiler(p) { profiler.beginZone(name); }
+    ~ScopedCpuZone() { profiler.endZone(); }
+private:
+    FrameProfiler& profiler;
+    ScopedCpuZone(const ScopedCpuZone&);
+    ScopedCpuZone& operator=(const ScopedCpuZone&);
+};
+
+#endif // FRAME_PROFILER_H
@@ -0,0 +1,166 @@
+/*
+ * GLExtensions.h
+ * Runtime-loaded OpenGL entry points for the legacy renderer
+ *
+ * opengl32.dll on Windows only exports GL 1.1, so anything newer has to
+ * be fetched from the driver after a context exists. The scene links
+ * freeglut, so glutGetProcAddress is the default loader; code that runs
+ * without GLUT (e.g. an EGL context) can pass its own.
+ * - Missing functions stay NULL; check the has* flags before use
+ */
+
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>  // for glutGetProcAddress()
+#include <GL/glext.h>
+#include <cstdio>
+#include <cstring>
+
+typedef void (*GLProc)();
+typedef GLProc (*GLProcLoader)(const char* name);
+
+// ============================================================================
+// ENTRY POINTS
+// ============================================================================
+
+struct GLExtensions {
+    bool loaded;
+    bool hasTimerQuery;       // GL 3.3 / ARB_timer_query / EXT_timer_query
+    bool hasPixelBuffer;      // GL 2.1 / ARB_pixel_buffer_object (async readback)
+    bool hasSync;             // GL 3.2 / ARB_sync
+    bool hasFramebuffer;      // GL 3.0 / ARB_framebuffer_object (multisample + blit)
+    bool hasTimestamp;        // glQueryCounter (GL 3.3 / ARB_timer_query)
+
+    // Queries (GL 1.5)
+    PFNGLGENQUERIESPROC genQueries;
+    PFNGLDELETEQUERIESPROC deleteQueries;
+    PFNGLBEGINQUERYPROC beginQuery;
+    PFNGLENDQUERYPROC endQuery;
+    PFNGLGETQUERYOBJECTIVPROC getQueryObjectiv;
+    // 64-bit results (timer query)
+    PFNGLGETQUERYOBJECTUI64VPROC getQueryObjectui64v;
+    PFNGLQUERYCOUNTERPROC queryCounter;
+
+    // Buffer objects (GL 1.5)
+    PFNGLGENBUFFERSPROC genBuffers;
+    PFNGLDELETEBUFFERSPROC deleteBuffers;
+    PFNGLBINDBUFFERPROC bindBuffer;
+    PFNGLBUFFERDATAPROC bufferData;
+    PFNGLMAPBUFFERPROC mapBuffer;
+    PFNGLUNMAPBUFFERPROC unmapBuffer;
+
+    // Fences (GL 3.2)
+    PFNGLFENCESYNCPROC fenceSync;
+    PFNGLCLIENTWAITSYNCPROC clientWaitSync;
+    PFNGLDELETESYNCPROC deleteSync;
+
+    // Framebuffer objects (GL 3.0)
+    PFNGLGENFRAMEBUFFERSPROC genFramebuffers;
+    PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers;
+    PFNGLBINDFRAMEBUFFERPROC bindFramebuffer;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC checkFramebufferStatus;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC framebufferRenderbuffer;
+    PFNGLGENRENDERBUFFERSPROC genRenderbuffers;
+    PFNGLDELETERENDERBUFFERSPROC deleteRenderbuffers;
+    PFNGLBINDRENDERBUFFERPROC bindRenderbuffer;
+    PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC renderbufferStorageMultisample;
+    PFNGLBLITFRAMEBUFFERPROC blitFramebuffer;
+};
+
+inline GLExtensions& glExt() {
+    static GLExtensions ext = {};
+    return ext;
+}
+
+inline GLProc defaultGLProcLoader(const char* name) {
+    return (GLProc)glutGetProcAddress(name);
+}
+
+// Whole-word search in the GL_EXTENSIONS string (compatibility contexts)
+inline bool hasGLExtension(const char* name) {
+    const char* list = (const char*)glGetString(GL_EXTENSIONS);
+    if (!list) return false;
+    size_t len = strlen(name);
+    for (const char* p = strstr(list, name); p; p = strstr(p + 1, name)) {
+        bool startOk = (p == list || p[-1] == ' ');
+        bool endOk = (p[len] == ' ' || p[len] == '\0');
+        if (startOk && endOk) return true;
+    }
+    return false;
+}
+
+inline bool hasGLVersion(int major, int minor) {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int maj = 0, min = 0;
+    if (!version || sscanf(version, "%d.%d", &maj, &min) != 2) return false;
+    return maj > major || (maj == major && min >= minor);
+}
+
+/**
+ * Fetch all entry points. Needs a current GL context.
+ * Safe to call more than once (only the first call loads).
+ * @param loader: Function used to look up entry points
+ * @return The loaded table (check the has* flags)
+ */
+inline GLExtensions& loadGLExtensions(GLProcLoader loader = defaultGLProcLoader) {
+    GLExtensions& ext = glExt();
+    if (ext.loaded) return ext;
+    ext.loaded = true;
+
+    ext.genQueries = (PFNGLGENQUERIESPROC)loader("glGenQueries");
+    ext.deleteQueries = (PFNGLDELETEQUERIESPROC)loader("glDeleteQueries");
+    ext.beginQuery = (PFNGLBEGINQUERYPROC)loader("glBeginQuery");
+    ext.endQuery = (PFNGLENDQUERYPROC)loader("glEndQuery");
+    ext.getQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)loader("glGetQueryObjectiv");
+    ext.getQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)loader("glGetQueryObjectui64v");
+    if (!ext.getQueryObjectui64v) {
+        ext.getQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)loader("glGetQueryObjectui64vEXT");
+    }
+    ext.queryCounter = (PFNGLQUERYCOUNTERPROC)loader("glQueryCounter");
+
+    ext.genBuffers = (PFNGLGENBUFFERSPROC)loader("glGenBuffers");
+    ext.deleteBuffers = (PFNGLDELETEBUFFERSPROC)loader("glDeleteBuffers");
+    ext.bindBuffer = (PFNGLBINDBUFFERPROC)loader("glBindBuffer");
+    ext.bufferData = (PFNGLBUFFERDATAPROC)loader("glBufferData");
+    ext.mapBuffer = (PFNGLMAPBUFFERPROC)loader("glMapBuffer");
+    ext.unmapBuffer = (PFNGLUNMAPBUFFERPROC)loader("glUnmapBuffer");
+    ext.fenceSync = (PFNGLFENCESYNCPROC)loader("glFenceSync");
+    ext.clientWaitSync = (PFNGLCLIENTWAITSYNCPROC)loader("glClientWaitSync");
+    ext.deleteSync = (PFNGLDELETESYNCPROC)loader("glDeleteSync");
+    ext.genFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)loader("glGenFramebuffers");
+    ext.deleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)loader("glDeleteFramebuffers");
+    ext.bindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)loader("glBindFramebuffer");
+    ext.checkFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)loader("glCheckFramebufferStatus");
+    ext.framebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)loader("glFramebufferRenderbuffer");
+    ext.genRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)loader("glGenRenderbuffers");
+    ext.deleteRenderbuffers = (PFNGLDELETERENDERBUFFERSPROC)loader("glDeleteRenderbuffers");
+    ext.bindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)loader("glBindRenderbuffer");
+    ext.renderbufferStorageMultisample =
+        (PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC)loader("glRenderbufferStorageMultisample");
+    ext.blitFramebuffer = (PFNGLBLITFRAMEBUFFERPROC)loader("glBlitFramebuffer");
+
+    bool timerSupported = hasGLVersion(3, 3) || hasGLExtension("GL_ARB_timer_query") ||
+                          hasGLExtension("GL_EXT_timer_query");
+    ext.hasTimerQuery = timerSupported && ext.genQueries && ext.deleteQueries &&
+                        ext.beginQuery && ext.endQuery && ext.getQueryObjectiv &&
+                        ext.getQueryObjectui64v;
+
+    bool pboSupported = hasGLVersion(2, 1) || hasGLExtension("GL_ARB_pixel_buffer_object");
+    ext.hasPixelBuffer = pboSupported && ext.genBuffers && ext.deleteBuffers && ext.bindBuffer &&
+                         ext.bufferData && ext.mapBuffer && ext.unmapBuffer;
+    bool syncSupported = hasGLVersion(3, 2) || hasGLExtension("GL_ARB_sync");
+    ext.hasSync = syncSupported && ext.fenceSync && ext.clientWaitSync && ext.deleteSync;
+    bool fboSupported = hasGLVersion(3, 0) || hasGLExtension("GL_ARB_framebuffer_object");
+    ext.hasFramebuffer = fboSupported && ext.genFramebuffers && ext.deleteFramebuffers &&
+                         ext.bindFramebuffer && ext.checkFramebufferStatus &&
+                         ext.framebufferRenderbuffer && ext.genRenderbuffers &&
+                         ext.deleteRenderbuffers && ext.bindRenderbuffer &&
+                         ext.renderbufferStorageMultisample && ext.blitFramebuffer;
+    ext.hasTimestamp = ext.hasTimerQuery && ext.queryCounter &&
+                       (hasGLVersion(3, 3) || hasGLExtension("GL_ARB_timer_query"));
+    return ext;
+}
+
+#endif // GL_EXTENSIONS_H
@@ -8,6 +8,7 @@
 
 #include <GL/glut.h>
 #include <cmath>
+#include <vector>
 
 // ============================================================================
 // SIMPLE SHADOW RENDERING (Fake shadows under objects)
@@ -77,62 +78,177 @@ void drawEllipticalShadow(float x, float z, float radiusX, float radiusZ, float
 // SKYBOX / ENHANCED BACKGROUND
 // ============================================================================
 
+/**
+ * Cached gradient sky dome
+ * The hemisphere is generated once (positions + height) and compiled into
+ * a display list. The gradient lives in a small 1D texture indexed by
+ * height, which is only rewritten when the colors actually change.
+ * Drawing is one glCallList with no trig per frame.
+ */
+class SkyDome {
+public:
+    SkyDome() : displayList(0), gradientTexture(0), timeBucket(-1) {
+        // Noon sky until setColors() or setTimeOfDay() says otherwise
+        static const float noon[6] = {0.25f, 0.50f, 0.90f, 0.65f, 0.85f, 0.95f};
+        for (int i = 0; i < 6; i++) colors[i] = noon[i];
+    }
+
+    /**
+     * Set zenith and horizon colors. The texture is only updated when
+     * one of them differs from the current gradient.
+     */
+    void setColors(float topR, float topG, float topB,
+                   float horizonR, float horizonG, float horizonB) {
+        float c[6] = {topR, topG, topB, horizonR, horizonG, horizonB};
+        bool changed = false;
+        for (int i = 0; i < 6; i++) {
+            if (c[i] != colors[i]) changed = true;
+            colors[i] = c[i];
+        }
+        if (changed) uploadGradient();
+    }
+
+    /**
+     * Recolor from time of day (0 = midnight, 0.5 = noon)
+     * Time is quantized so the gradient is rebuilt at most 256 times per day.
+     */
+    void setTimeOfDay(float t) {
+        int bucket = (int)(t * 256.0f) & 255;
+        if (bucket == timeBucket) return;
+        timeBucket = bucket;
+
+        // Keyframes: {time, zenith rgb, horizon rgb}
+        static const float keys[][7] = {
+            {0.00f, 0.02f, 0.03f, 0.10f, 0.10f, 0.12f, 0.25f},  // Midnight
+            {0.25f, 0.25f, 0.35f, 0.60f, 0.95f, 0.60f, 0.40f},  // Dawn
+            {0.50f, 0.25f, 0.50f, 0.90f, 0.65f, 0.85f, 0.95f},  // Noon
+            {0.75f, 0.25f, 0.30f, 0.55f, 0.95f, 0.50f, 0.35f},  // Dusk
+            {1.00f, 0.02f, 0.03f, 0.10f, 0.10f, 0.12f, 0.25f}   // Midnight
+        };
+        float tq = bucket / 256.0f;
+        int k = 0;
+        while (k < 3 && tq > keys[k + 1][0]) k++;
+        float f = (tq - keys[k][0]) / (keys[k + 1][0] - keys[k][0]);
+
+        float c[6];
+        for (int i = 0; i < 6; i++) {
+            c[i] = keys[k][i + 1] + (keys[k + 1][i + 1] - keys[k][i + 1]) * f;
+        }
+        setColors(c[0], c[1], c[2], c[3], c[4], c[5]);
+    }
+
+    void draw() {
+        if (!displayList) buildMesh();
+
+        glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+        glDisable(GL_LIGHTING);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_TEXTURE_2D);
+        glEnable(GL_TEXTURE_1D);
+        glBindTexture(GL_TEXTURE_1D, gradientTexture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+        glCallList(displayList);
+
+        glPopAttrib();
+    }
+
+private:
+    static const int SLICES = 32;
+    static const int STACKS = 16;
+    static const int GRADIENT_SIZE = 64;
+
+    GLuint displayList;
+    GLuint gradientTexture;
+    float colors[6];
+    int timeBucket;
+
+    // Generate the hemisphere once. Texture coordinate = height (0 zenith, 1 horizon)
+    void buildMesh() {
+        const float radius = 100.0f; // Large enough to enclose scene
+        std::vector<float> positions;
+        std::vector<float> heights;
+        std::vector<unsigned short> indices;
+
+        for (int i = 0; i <= STACKS; i++) {
+            float lat = (i * 1.57079f) / STACKS; // 0 to PI/2
+            float y = cosf(lat);
+            float r = sinf(lat);
+            for (int j = 0; j <= SLICES; j++) {
+                float lng = (j * 6.28318f) / SLICES;
+                positions.push_back(r * cosf(lng) * radius);
+                positions.push_back(y * radius);
+                positions.push_back(r * sinf(lng) * radius);
+                heights.push_back((float)i / STACKS);
+            }
+        }
+        for (int i = 0; i < STACKS; i++) {
+            for (int j = 0; j < SLICES; j++) {
+                unsigned short a = (unsigned short)(i * (SLICES + 1) + j);
+                unsigned short b = (unsigned short)(a + SLICES + 1);
+                indices.push_back(a);
+                indices.push_back(b);
+                indices.push_back((unsigned short)(b + 1));
+                indices.push_back((unsigned short)(a + 1));
+            }
+        }
+
+        if (!gradientTexture) uploadGradient();
+
+        displayList = glGenLists(1);
+        glNewList(displayList, GL_COMPILE);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 0, &positions[0]);
+        glTexCoordPointer(1, GL_FLOAT, 0, &heights[0]);
+        glDrawElements(GL_QUADS, (GLsizei)indices.size(), GL_UNSIGNED_SHORT, &indices[0]);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glEndList();
+    }
+
+    // Rewrite the 1D gradient lookup from the current colors
+    void uploadGradient() {
+        unsigned char texels[GRADIENT_SIZE * 3];
+        for (int i = 0; i < GRADIENT_SIZE; i++) {
+            float t = (float)i / (GRADIENT_SIZE - 1);
+            for (int c = 0; c < 3; c++) {
+                float v = colors[c] + (colors[c + 3] - colors[c]) * t;
+                if (v < 0.0f) v = 0.0f;
+                if (v > 1.0f) v = 1.0f;
+                texels[i * 3 + c] = (unsigned char)(v * 255.0f);
+            }
+        }
+
+        bool created = (gradientTexture == 0);
+        if (created) glGenTextures(1, &gradientTexture);
+        glBindTexture(GL_TEXTURE_1D, gradientTexture);
+        if (created) {
+            // Edge texels, not the border color: heights 0 and 1 hit the texture edge
+            glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, GRADIENT_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, texels);
+        } else {
+            glTexSubImage1D(GL_TEXTURE_1D, 0, 0, GRADIENT_SIZE, GL_RGB, GL_UNSIGNED_BYTE, texels);
+        }
+        glBindTexture(GL_TEXTURE_1D, 0);
+    }
+};
+
 /**
  * Draw a gradient sky dome (simple skybox alternative)
+ * Uses a shared SkyDome, so the mesh is only built on the first call and
+ * the gradient only changes when the colors do.
  * @param topColor: RGB color at zenith
  * @param horizonColor: RGB color at horizon
  */
 void drawGradientSkyDome(float topR, float topG, float topB,
                          float horizonR, float horizonG, float horizonB) {
-    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-    
-    glPushMatrix();
-    
-    // Draw hemisphere with gradient
-    int slices = 32;
-    int stacks = 16;
-    float radius = 100.0f; // Large enough to enclose scene
-    
-    for (int i = 0; i < stacks; i++) {
-        float lat0 = (i * 1.57079f) / stacks; // 0 to PI/2
-        float lat1 = ((i + 1) * 1.57079f) / stacks;
-        
-        float z0 = cosf(lat0);
-        float r0 = sinf(lat0);
-        float z1 = cosf(lat1);
-        float r1 = sinf(lat1);
-        
-        // Interpolate color based on height
-        float t0 = (float)i / stacks;
-        float t1 = (float)(i + 1) / stacks;
-        
-        glBegin(GL_QUAD_STRIP);
-        for (int j = 0; j <= slices; j++) {
-            float lng = (j * 6.28318f) / slices;
-            float x = cosf(lng);
-            float y = sinf(lng);
-            
-            // Top vertex color (interpolated)
-            glColor3f(topR + (horizonR - topR) * t0,
-                     topG + (horizonG - topG) * t0,
-                     topB + (horizonB - topB) * t0);
-            glVertex3f(r0 * x * radius, z0 * radius, r0 * y * radius);
-            
-            // Bottom vertex color
-            glColor3f(topR + (horizonR - topR) * t1,
-                     topG + (horizonG - topG) * t1,
-                     topB + (horizonB - topB) * t1);
-            glVertex3f(r1 * x * radius, z1 * radius, r1 * y * radius);
-        }
-        glEnd();
-    }
-    
-    glPopMatrix();
-    glPopAttrib();
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
+    static SkyDome dome;
+    dome.setColors(topR, topG, topB, horizonR, horizonG, horizonB);
+    dome.draw();
 }
 
 /**
@@ -8,6 +8,7 @@
 
 #include <GL/glut.h>
 #include <cmath>
+#include <vector>
 
 // ============================================================================
 // SIMPLE SHADOW RENDERING - FIXED VERSION
@@ -84,6 +85,184 @@ void drawEllipticalShadow(float x, float z, float radiusX, float radiusZ, float
     glPopAttrib();
 }
 
+// ============================================================================
+// BATCHED SHADOW DECALS
+// ============================================================================
+
+/**
+ * Collects blob shadows during the frame and draws them all as textured
+ * quads in one call. The soft edge comes from a small radial falloff
+ * texture instead of a 33-vertex triangle fan per shadow.
+ * Shadows are stretched away from the light (see setLightPosition).
+ */
+class ShadowDecalBatch {
+public:
+    ShadowDecalBatch() : falloffTexture(0), stretch(1.0f) {
+        lightDir[0] = 1.0f;
+        lightDir[1] = 0.0f;
+    }
+
+    /**
+     * Bake the radial falloff texture (needs a current GL context)
+     */
+    void createTexture() {
+        const int size = 64;
+        unsigned char pixels[size * size];
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float dx = (x + 0.5f) / size * 2.0f - 1.0f;
+                float dy = (y + 0.5f) / size * 2.0f - 1.0f;
+                float falloff = 1.0f - (dx*dx + dy*dy);
+                if (falloff < 0.0f) falloff = 0.0f;
+                pixels[y * size + x] = (unsigned char)(sqrtf(falloff) * 255.0f);
+            }
+        }
+
+        if (!falloffTexture) glGenTextures(1, &falloffTexture);
+        glBindTexture(GL_TEXTURE_2D, falloffTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, size, size, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    GLuint texture() const { return falloffTexture; }
+
+    /**
+     * Set the light that casts the shadows (e.g. from getSunPosition)
+     * Low lights stretch the decals away from the light, a light straight
+     * overhead (or below the horizon) leaves them round.
+     * @param lx, ly, lz: Light position relative to the scene origin
+     */
+    void setLightPosition(float lx, float ly, float lz) {
+        float horizontal = sqrtf(lx*lx + lz*lz);
+        if (ly <= 0.0f || horizontal < 0.001f) {
+            stretch = 1.0f;
+            return;
+        }
+        lightDir[0] = -lx / horizontal;   // Shadows fall away from the light
+        lightDir[1] = -lz / horizontal;
+        stretch = 1.0f + 0.5f * horizontal / ly;
+        if (stretch > 2.5f) stretch = 2.5f;
+    }
+
+    // Start a new frame
+    void begin() {
+        decals.clear();
+    }
+
+    /**
+     * Queue one shadow
+     * @param x, z: Center position on ground (base of the object)
+     * @param radiusX, radiusZ: Shadow radii before rotation
+     * @param opacity: Shadow darkness (0.0 = transparent, 1.0 = solid black)
+     * @param rotation: Rotation around Y in degrees (matches glRotatef)
+     */
+    void add(float x, float z, float radiusX, float radiusZ, float opacity = 0.3f, float rotation = 0.0f) {
+        Decal d;
+        d.x = x;
+        d.z = z;
+        d.radiusX = radiusX;
+        d.radiusZ = radiusZ;
+        d.opacity = opacity;
+        d.rotation = rotation;
+        decals.push_back(d);
+    }
+
+    int size() const { return (int)decals.size(); }
+
+    /**
+     * Draw every queued shadow with a single glDrawArrays
+     */
+    void draw() {
+        if (decals.empty()) return;
+
+        vertices.resize(decals.size() * 4 * 3);
+        texCoords.resize(decals.size() * 4 * 2);
+        colors.resize(decals.size() * 4 * 4);
+
+        static const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+        float sx = lightDir[0], sz = lightDir[1];
+
+        for (size_t i = 0; i < decals.size(); i++) {
+            const Decal& d = decals[i];
+            float a = d.rotation * 3.14159265f / 180.0f;
+            float c = cosf(a), s = sinf(a);
+
+            // Push the stretched blob away from the light so it stays at the base
+            float shift = (stretch - 1.0f) * (d.radiusX > d.radiusZ ? d.radiusX : d.radiusZ);
+
+            for (int k = 0; k < 4; k++) {
+                // Ellipse corner rotated around Y (same direction as glRotatef)
+                float px = corners[k][0] * d.radiusX;
+                float pz = corners[k][1] * d.radiusZ;
+                float wx = px * c + pz * s;
+                float wz = -px * s + pz * c;
+
+                // Scale along the light direction
+                float along = (wx * sx + wz * sz) * (stretch - 1.0f);
+                wx += sx * (along + shift);
+                wz += sz * (along + shift);
+
+                float* v = &vertices[(i * 4 + k) * 3];
+                v[0] = d.x + wx;
+                v[1] = 0.015f;  // Slightly above ground to avoid z-fighting
+                v[2] = d.z + wz;
+
+                float* t = &texCoords[(i * 4 + k) * 2];
+                t[0] = corners[k][0] * 0.5f + 0.5f;
+                t[1] = corners[k][1] * 0.5f + 0.5f;
+
+                float* col = &colors[(i * 4 + k) * 4];
+                col[0] = col[1] = col[2] = 0.0f;
+                col[3] = d.opacity;
+            }
+        }
+
+        glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT);
+
+        glDisable(GL_LIGHTING);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE); // Same as drawEllipticalShadow
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, falloffTexture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+        glTexCoordPointer(2, GL_FLOAT, 0, &texCoords[0]);
+        glColorPointer(4, GL_FLOAT, 0, &colors[0]);
+        glDrawArrays(GL_QUADS, 0, (GLsizei)(decals.size() * 4));
+        glPopClientAttrib();
+
+        glPopAttrib();
+    }
+
+private:
+    struct Decal {
+        float x, z;
+        float radiusX, radiusZ;
+        float opacity;
+        float rotation;
+    };
+
+    std::vector<Decal> decals;
+    GLuint falloffTexture;
+    float lightDir[2];   // Ground direction shadows fall towards
+    float stretch;       // Elongation along lightDir
+
+    // Per-frame vertex data (kept between frames to avoid reallocation)
+    std::vector<float> vertices;
+    std::vector<float> texCoords;
+    std::vector<float> colors;
+};
+
 // ============================================================================
 // SKYBOX - SIMPLIFIED & SAFE VERSION
 // ============================================================================
@@ -0,0 +1,196 @@
+/*
+ * OffscreenGlut.cpp
+ * Windowless GLUT replacement for the offscreen benchmark (see OffscreenGlut.h)
+ */
+
+#include "OffscreenGlut.h"
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLSurface eglSurface = EGL_NO_SURFACE;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+static int surfaceWidth = 0;
+static int surfaceHeight = 0;
+static GLUquadric* shapeQuadric = NULL;
+static std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+// ============================================================================
+// CONTEXT
+// ============================================================================
+
+static EGLDisplay openDisplay() {
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL)) return display;
+    }
+#endif
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL)) return display;
+    return EGL_NO_DISPLAY;
+}
+
+bool createOffscreenContext(int width, int height) {
+    eglDisplay = openDisplay();
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        fprintf(stderr, "EGL: no display available\n");
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        fprintf(stderr, "EGL: no RGBA8/depth24 pbuffer config with desktop OpenGL\n");
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttribs);
+    if (eglSurface == EGL_NO_SURFACE || !eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "EGL: cannot create pbuffer surface\n");
+        return false;
+    }
+
+    // Default (compatibility) context - the scene uses fixed-function GL
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, NULL);
+    if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+        fprintf(stderr, "EGL: cannot create OpenGL context\n");
+        return false;
+    }
+
+    surfaceWidth = width;
+    surfaceHeight = height;
+    return true;
+}
+
+void destroyOffscreenContext() {
+    if (shapeQuadric) {
+        gluDeleteQuadric(shapeQuadric);
+        shapeQuadric = NULL;
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (eglContext != EGL_NO_CONTEXT) eglDestroyContext(eglDisplay, eglContext);
+    if (eglSurface != EGL_NO_SURFACE) eglDestroySurface(eglDisplay, eglSurface);
+    eglTerminate(eglDisplay);
+    eglDisplay = EGL_NO_DISPLAY;
+    eglSurface = EGL_NO_SURFACE;
+    eglContext = EGL_NO_CONTEXT;
+}
+
+// ============================================================================
+// GLUT STATE AND EVENTS
+// ============================================================================
+
+int glutGet(GLenum query) {
+    switch (query) {
+        case GLUT_ELAPSED_TIME:
+            return (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - startTime).count();
+        case GLUT_WINDOW_WIDTH:
+            return surfaceWidth;
+        case GLUT_WINDOW_HEIGHT:
+            return surfaceHeight;
+        default:
+            return 0;
+    }
+}
+
+GLUTproc glutGetProcAddress(const char* procName) {
+    return (GLUTproc)eglGetProcAddress(procName);
+}
+
+void glutSwapBuffers() {
+    eglSwapBuffers(eglDisplay, eglSurface);
+}
+
+// No window, no event loop
+void glutPostRedisplay() {}
+void glutBitmapCharacter(void*, int) {}
+
+#if !defined(_WIN32)
+void* glutBitmap8By13 = NULL;   // Font handle behind GLUT_BITMAP_8_BY_13
+#endif
+
+// ============================================================================
+// SOLID SHAPES - same geometry and orientation as freeglut
+// ============================================================================
+
+static GLUquadric* quadric() {
+    if (!shapeQuadric) {
+        shapeQuadric = gluNewQuadric();
+        gluQuadricNormals(shapeQuadric, GLU_SMOOTH);
+    }
+    return shapeQuadric;
+}
+
+void glutSolidSphere(double radius, GLint slices, GLint stacks) {
+    gluSphere(quadric(), radius, slices, stacks);
+}
+
+void glutSolidCube(double size) {
+    static const float normals[6][3] = {
+        {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}
+    };
+    static const float corners[6][4][3] = {
+        {{-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}},
+        {{-1, -1, -1}, {-1, 1, -1}, {1, 1, -1}, {1, -1, -1}},
+        {{-1, 1, -1}, {-1, 1, 1}, {1, 1, 1}, {1, 1, -1}},
+        {{-1, -1, -1}, {1, -1, -1}, {1, -1, 1}, {-1, -1, 1}},
+        {{1, -1, -1}, {1, 1, -1}, {1, 1, 1}, {1, -1, 1}},
+        {{-1, -1, -1}, {-1, -1, 1}, {-1, 1, 1}, {-1, 1, -1}}
+    };
+    float h = (float)size * 0.5f;
+    glBegin(GL_QUADS);
+    for (int f = 0; f < 6; f++) {
+        glNormal3fv(normals[f]);
+        for (int v = 0; v < 4; v++) {
+            glVertex3f(corners[f][v][0] * h, corners[f][v][1] * h, corners[f][v][2] * h);
+        }
+    }
+    glEnd();
+}
+
+// Base on z = 0, apex at z = height
+void glutSolidCone(double base, double height, GLint slices, GLint stacks) {
+    gluCylinder(quadric(), base, 0.0, height, slices, stacks);
+    glPushMatrix();
+    glRotatef(180.0f, 1.0f, 0.0f, 0.0f);    // Cap faces -z
+    gluDisk(quadric(), 0.0, base, slices, 1);
+    glPopMatrix();
+}
+
+// Ring around the z axis
+void glutSolidTorus(double innerRadius, double outerRadius, GLint sides, GLint rings) {
+    const float TWO_PI = 6.28318530718f;
+    for (int i = 0; i < rings; i++) {
+        float a0 = TWO_PI * i / rings;
+        float a1 = TWO_PI * (i + 1) / rings;
+        glBegin(GL_QUAD_STRIP);
+        for (int j = 0; j <= sides; j++) {
+            float b = TWO_PI * j / sides;
+            float cb = cosf(b), sb = sinf(b);
+            float r = (float)outerRadius + (float)innerRadius * cb;
+            glNormal3f(cosf(a1) * cb, sinf(a1) * cb, sb);
+            glVertex3f(cosf(a1) * r, sinf(a1) * r, (float)innerRadius * sb);
+            glNormal3f(cosf(a0) * cb, sinf(a0) * cb, sb);
+            glVertex3f(cosf(a0) * r, sinf(a0) * r, (float)innerRadius * sb);
+        }
+        glEnd();
+    }
+}
@@ -0,0 +1,24 @@
+/*
+ * OffscreenGlut.h
+ * Windowless stand-in for the GLUT calls the scene uses
+ *
+ * Link OffscreenGlut.cpp instead of freeglut to run the scene code with
+ * no display: the context is an EGL pbuffer (Mesa llvmpipe works, so no
+ * GPU is needed), the glutSolid* shapes are rebuilt from GLU quadrics
+ * and window/event functions do nothing. Used by scene_bench.cpp.
+ */
+
+#ifndef OFFSCREEN_GLUT_H
+#define OFFSCREEN_GLUT_H
+
+/**
+ * Create an EGL pbuffer context and make it current.
+ * Prefers the Mesa surfaceless platform, falls back to the default display.
+ * @param width, height: Framebuffer size (also reported by glutGet)
+ * @return false if EGL or desktop OpenGL is not available
+ */
+bool createOffscreenContext(int width, int height);
+
+void destroyOffscreenContext();
+
+#endif // OFFSCREEN_GLUT_H
@@ -0,0 +1,242 @@
+/*
+ * QualityGovernor.h
+ * Adaptive quality: steps registered knobs to hold a frame-time budget
+ *
+ * - Frame cost is the larger of the CPU time spent on the frame and the
+ *   GPU time between two timestamp queries around it (read a few frames
+ *   later, never waited on). Time spent waiting for vsync or the frame
+ *   cap is not counted, so there is headroom to measure
+ * - Every GOVERNOR_WINDOW frames the average cost is compared with the
+ *   budget: above it, the least degraded knob drops one level; below
+ *   GOVERNOR_RESTORE_RATIO of it for GOVERNOR_RESTORE_WINDOWS windows in
+ *   a row, the most degraded knob comes back one level. The gap between
+ *   the two thresholds and the slow way back keep it from oscillating
+ * - After a change the next GOVERNOR_COOLDOWN frames are ignored while
+ *   the new setting settles (buffers rebuilt, caches warm)
+ * Knobs registered first are degraded first when levels are tied.
+ */
+
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include "GLExtensions.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+const int GOVERNOR_WINDOW = 30;              // Frames per decision
+const int GOVERNOR_COOLDOWN = 20;            // Frames ignored after a change
+const int GOVERNOR_RESTORE_WINDOWS = 3;      // Good windows before restoring
+const float GOVERNOR_RESTORE_RATIO = 0.7f;   // "Good" = below 70% of the budget
+const int GOVERNOR_QUERY_LATENCY = 4;        // Frames before a GPU timestamp is read
+
+struct QualityKnob {
+    const char* name;
+    std::vector<const char*> labels;    // One per level, level 0 = full quality
+    std::function<void(int)> apply;
+    int level;
+};
+
+// ============================================================================
+// QUALITY GOVERNOR
+// ============================================================================
+
+class QualityGovernor {
+public:
+    QualityGovernor() : enabled(false), budgetMs(1000.0f / 60.0f), gpuReady(false),
+                        lastGpuMs(0.0f), frameNumber(0), windowFrames(0), windowCostMs(0.0),
+                        cooldown(0), goodWindows(0), lastCostMs(0.0f), changes(0) {
+        memset(queryIssued, 0, sizeof(queryIssued));
+    }
+
+    /**
+     * Register a knob. apply(0) is called right away.
+     * @param name: Shown in the status line and change log
+     * @param labels: Setting name per level, full quality first
+     * @param apply: Switches the scene to a level
+     */
+    void addKnob(const char* name, const std::vector<const char*>& labels,
+                 const std::function<void(int)>& apply) {
+        QualityKnob knob;
+        knob.name = name;
+        knob.labels = labels;
+        knob.apply = apply;
+        knob.level = 0;
+        knobs.push_back(knob);
+        apply(0);
+    }
+
+    // Needs a current GL context; without timestamps only CPU time is used
+    void initGpu() {
+        GLExtensions& ext = loadGLExtensions();
+        if (!ext.hasTimestamp || gpuReady) return;
+        ext.genQueries(GOVERNOR_QUERY_LATENCY * 2, &queries[0][0]);
+        gpuReady = true;
+    }
+
+    void setBudget(float ms) { budgetMs = ms; }
+    float budget() const { return budgetMs; }
+
+    bool isEnabled() const { return enabled; }
+
+    // Turning the governor off puts every knob back to full quality
+    void setEnabled(bool on) {
+        if (!on) {
+            for (size_t i = 0; i < knobs.size(); i++) setLevel(knobs[i], 0);
+        }
+        enabled = on;
+        resetWindow();
+        cooldown = 0;
+        goodWindows = 0;
+    }
+
+    void beginFrame() {
+        if (!enabled) return;
+        frameStart = std::chrono::steady_clock::now();
+        if (!gpuReady) return;
+        int slot = (int)(frameNumber % GOVERNOR_QUERY_LATENCY);
+        collectGpuCost(slot);
+        glExt().queryCounter(queries[slot][0], GL_TIMESTAMP);
+    }
+
+    /**
+     * Finish measuring the frame and maybe change a knob
+     * @return true if a knob changed (see lastChange())
+     */
+    bool endFrame() {
+        if (!enabled) return false;
+        float cpuMs = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - frameStart).count();
+        if (gpuReady) {
+            int slot = (int)(frameNumber % GOVERNOR_QUERY_LATENCY);
+            glExt().queryCounter(queries[slot][1], GL_TIMESTAMP);
+            queryIssued[slot] = true;
+        }
+        frameNumber++;
+
+        // GPU time lags a few frames behind; close enough for a 30-frame average
+        float cost = cpuMs > lastGpuMs ? cpuMs : lastGpuMs;
+        lastCostMs = cost;
+        if (cooldown > 0) {
+            cooldown--;
+            return false;
+        }
+        windowCostMs += cost;
+        if (++windowFrames < GOVERNOR_WINDOW) return false;
+
+        float average = (float)(windowCostMs / windowFrames);
+        resetWindow();
+        if (average > budgetMs) {
+            goodWindows = 0;
+            return step(average, +1);
+        }
+        if (average < budgetMs * GOVERNOR_RESTORE_RATIO) {
+            if (++goodWindows < GOVERNOR_RESTORE_WINDOWS) return false;
+            goodWindows = 0;
+            return step(average, -1);
+        }
+        goodWindows = 0;
+        return false;
+    }
+
+    // Last change, e.g. "Resolution 85% -> 70% (19.4 ms)"
+    const char* lastChange() const { return changeText.c_str(); }
+    int changeCount() const { return changes; }
+    float lastFrameCost() const { return lastCostMs; }
+
+    // One line with every knob's current setting
+    std::string describe() const {
+        std::string text;
+        char part[64];
+        for (size_t i = 0; i < knobs.size(); i++) {
+            snprintf(part, sizeof(part), "%s%s %s", i ? "  " : "", knobs[i].name,
+                     knobs[i].labels[knobs[i].level]);
+            text += part;
+        }
+        return text;
+    }
+
+private:
+    bool enabled;
+    float budgetMs;
+    bool gpuReady;
+    std::vector<QualityKnob> knobs;
+
+    // Measurement
+    std::chrono::steady_clock::time_point frameStart;
+    GLuint queries[GOVERNOR_QUERY_LATENCY][2];    // Start/end timestamp per frame
+    bool queryIssued[GOVERNOR_QUERY_LATENCY];
+    float lastGpuMs;
+    long long frameNumber;
+    int windowFrames;
+    double windowCostMs;
+    int cooldown;
+    int goodWindows;
+    float lastCostMs;
+
+    std::string changeText;
+    int changes;
+
+    void resetWindow() {
+        windowFrames = 0;
+        windowCostMs = 0.0;
+    }
+
+    // Timestamps issued GOVERNOR_QUERY_LATENCY frames ago, about to be reused
+    void collectGpuCost(int slot) {
+        if (!queryIssued[slot]) return;
+        queryIssued[slot] = false;
+        GLExtensions& ext = glExt();
+        GLint available = 0;
+        ext.getQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;    // Keep the previous value rather than stall
+        GLuint64 start = 0, end = 0;
+        ext.getQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+        ext.getQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+        lastGpuMs = end > start ? (float)((end - start) / 1.0e6) : 0.0f;
+    }
+
+    void setLevel(QualityKnob& knob, int level) {
+        if (knob.level == level) return;
+        knob.level = level;
+        knob.apply(level);
+    }
+
+    /**
+     * Degrade (+1) the knob with the lowest relative level or restore (-1)
+     * the one with the highest
+     */
+    bool step(float averageMs, int direction) {
+        int best = -1;
+        float bestFraction = 0.0f;
+        for (size_t n = 0; n < knobs.size(); n++) {
+            // Restore walks the list backwards so ties undo the last degraded first
+            size_t i = direction > 0 ? n : knobs.size() - 1 - n;
+            const QualityKnob& knob = knobs[i];
+            int maxLevel = (int)knob.labels.size() - 1;
+            if (direction > 0 ? knob.level >= maxLevel : knob.level <= 0) continue;
+            float fraction = (float)knob.level / maxLevel;
+            if (best < 0 || (direction > 0 ? fraction < bestFraction : fraction > bestFraction)) {
+                best = (int)i;
+                bestFraction = fraction;
+            }
+        }
+        if (best < 0) return false;
+
+        QualityKnob& knob = knobs[best];
+        const char* from = knob.labels[knob.level];
+        setLevel(knob, knob.level + direction);
+        char text[96];
+        snprintf(text, sizeof(text), "%s %s -> %s (%.1f ms)", knob.name, from,
+                 knob.labels[knob.level], averageMs);
+        changeText = text;
+        changes++;
+        cooldown = GOVERNOR_COOLDOWN;
+        return true;
+    }
+};
+
+#endif // QUALITY_GOVERNOR_H
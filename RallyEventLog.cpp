@@ -0,0 +1,125 @@
+/*
+ * RallyEventLog.cpp
+ * Rally event consumer thread: console, CSV file and subscribers
+ */
+
+#include "RallyEventLog.h"
+#include <chrono>
+
+// How long the worker sleeps when the queue is empty
+const int EVENT_POLL_MS = 5;
+
+RallyEventLog::RallyEventLog() : queue(NULL), console(false), csv(NULL), stopping(false),
+                                 nextSubscriberId(1) {}
+
+RallyEventLog::~RallyEventLog() {
+    stop();
+}
+
+bool RallyEventLog::start(RallyEventQueue& eventQueue, bool printToConsole, const char* csvPath) {
+    stop();
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) return false;
+        fprintf(csv, "tick,event,side,rally,x,y,z,vx,vy,vz\n");
+    }
+    queue = &eventQueue;
+    console = printToConsole;
+    stopping = false;
+    worker = std::thread(&RallyEventLog::run, this);
+    return true;
+}
+
+void RallyEventLog::stop() {
+    if (!worker.joinable()) return;
+    stopping = true;
+    worker.join();
+    unsigned long dropped = (unsigned long)queue->droppedCount();
+    if (dropped > 0) printf("Rally events: %lu dropped (queue full)\n", dropped);
+    if (csv) {
+        fclose(csv);
+        csv = NULL;
+    }
+    queue = NULL;
+}
+
+int RallyEventLog::subscribe(const Subscriber& subscriber) {
+    std::lock_guard<std::mutex> lock(subscriberMutex);
+    subscribers.push_back(std::make_pair(nextSubscriberId, subscriber));
+    return nextSubscriberId++;
+}
+
+void RallyEventLog::unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(subscriberMutex);
+    for (size_t i = 0; i < subscribers.size(); i++) {
+        if (subscribers[i].first == id) {
+            subscribers.erase(subscribers.begin() + i);
+            return;
+        }
+    }
+}
+
+const char* RallyEventLog::typeName(RallyEventType type) {
+    switch (type) {
+        case RALLY_HIT:    return "hit";
+        case RALLY_BOUNCE: return "bounce";
+        case RALLY_NET:    return "net";
+        case RALLY_WALL:   return "wall";
+        case RALLY_RESET:  return "reset";
+    }
+    return "unknown";
+}
+
+void RallyEventLog::describe(const RallyEvent& event, char* text, size_t size) {
+    switch (event.type) {
+        case RALLY_HIT:
+            snprintf(text, size, "✓ Player %d HIT! Rally: %d", event.side, event.rally);
+            break;
+        case RALLY_BOUNCE:
+            snprintf(text, size, "Bounce at (%.2f, %.2f)", event.position[0], event.position[2]);
+            break;
+        case RALLY_NET:
+            snprintf(text, size, "⚠ Net hit! Rally over");
+            break;
+        case RALLY_WALL:
+            snprintf(text, size, "⚠ Ball bounced off back wall (%s)", event.side == 1 ? "left" : "right");
+            break;
+        case RALLY_RESET:
+            snprintf(text, size, "⚠ Emergency reset - ball out of play");
+            break;
+    }
+}
+
+void RallyEventLog::run() {
+    RallyEvent event;
+    for (;;) {
+        // Read the flag before draining so nothing posted before stop() is missed
+        bool finish = stopping;
+        bool any = false;
+        while (queue->pop(event)) {
+            deliver(event);
+            any = true;
+        }
+        if (any) {
+            if (console) fflush(stdout);
+            if (csv) fflush(csv);
+        }
+        if (finish) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(EVENT_POLL_MS));
+    }
+}
+
+void RallyEventLog::deliver(const RallyEvent& event) {
+    if (console && event.type != RALLY_BOUNCE) {
+        char text[96];
+        describe(event, text, sizeof(text));
+        printf("%s\n", text);
+    }
+    if (csv) {
+        fprintf(csv, "%lld,%s,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", event.tick, typeName(event.type),
+                event.side, event.rally, event.position[0], event.position[1], event.position[2],
+                event.velocity[0], event.velocity[1], event.velocity[2]);
+    }
+    std::lock_guard<std::mutex> lock(subscriberMutex);
+    for (size_t i = 0; i < subscribers.size(); i++) subscribers[i].second(event);
+}
@@ -0,0 +1,74 @@
+/*
+ * RallyEventLog.h
+ * Background consumer for the rally event queue (see RallyEvents.h)
+ *
+ * A worker thread drains the queue every few milliseconds and
+ * - prints the events to the console (ground bounces left out),
+ * - appends all of them to a CSV file (--event-log), and
+ * - hands each one to the registered subscribers (scoring, analytics).
+ * Subscribers run on the worker thread, in event order; they must not
+ * touch GL or the live SimulationState.
+ */
+
+#ifndef RALLY_EVENT_LOG_H
+#define RALLY_EVENT_LOG_H
+
+#include "RallyEvents.h"
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+class RallyEventLog {
+public:
+    typedef std::function<void(const RallyEvent&)> Subscriber;
+
+    RallyEventLog();
+    ~RallyEventLog();
+
+    /**
+     * Start draining queue on the worker thread
+     * @param console: Print events to stdout
+     * @param csvPath: File that receives every event, NULL = none
+     * @return false if the file cannot be created
+     */
+    bool start(RallyEventQueue& queue, bool console, const char* csvPath = NULL);
+
+    // Deliver what is left in the queue, then stop the thread
+    void stop();
+
+    bool isRunning() const { return worker.joinable(); }
+
+    /**
+     * Register a callback for every event from now on
+     * @return Id for unsubscribe()
+     */
+    int subscribe(const Subscriber& subscriber);
+    void unsubscribe(int id);
+
+    static const char* typeName(RallyEventType type);
+
+    // Console line for an event, e.g. "Player 1 HIT! Rally: 3"
+    static void describe(const RallyEvent& event, char* text, size_t size);
+
+private:
+    RallyEventQueue* queue;
+    bool console;
+    FILE* csv;
+    std::thread worker;
+    std::atomic<bool> stopping;
+
+    std::mutex subscriberMutex;
+    std::vector<std::pair<int, Subscriber> > subscribers;
+    int nextSubscriberId;
+
+    void run();
+    void deliver(const RallyEvent& event);
+
+    RallyEventLog(const RallyEventLog&);
+    RallyEventLog& operator=(const RallyEventLog&);
+};
+
+#endif // RALLY_EVENT_LOG_H
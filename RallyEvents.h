@@ -0,0 +1,96 @@
+/*
+ * RallyEvents.h
+ * Typed rally events and the lock-free queue the simulation posts them to
+ *
+ * The simulation tick runs on the render thread, so it must never wait
+ * on a terminal or a file. Events are copied into a fixed-size single
+ * producer / single consumer ring instead; RallyEventLog drains it on
+ * its own thread. A full ring drops the event and counts it - the
+ * producer never blocks.
+ */
+
+#ifndef RALLY_EVENTS_H
+#define RALLY_EVENTS_H
+
+#include <atomic>
+#include <cstddef>
+
+enum RallyEventType {
+    RALLY_HIT,        // Paddle hit
+    RALLY_BOUNCE,     // Ball bounced on the ground
+    RALLY_NET,        // Ball hit the net (ends the rally)
+    RALLY_WALL,       // Ball sent back from behind a baseline (ends the rally)
+    RALLY_RESET       // Ball too high/low or dead, put back in play (ends the rally)
+};
+
+struct RallyEvent {
+    RallyEventType type;
+    int side;              // HIT: player 1/2, WALL: 1 = left end, 2 = right end, else 0
+    int rally;             // rallyCount after the event
+    long long tick;        // Tick being simulated (SimulationState::tick)
+    float position[3];     // Ball after the event (RESET: where it left play)
+    float velocity[3];
+};
+
+// ============================================================================
+// SPSC QUEUE
+// ============================================================================
+
+/**
+ * Bounded lock-free ring for exactly one producer and one consumer thread
+ * @param Capacity: Power of two
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    SpscQueue() : head(0), cachedTail(0), tail(0), cachedHead(0), dropped(0) {}
+
+    // Producer only. Returns false (and counts a drop) when full
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == Capacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when empty
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    // Consumer and producer indices on separate cache lines; each side
+    // keeps a copy of the other's index and only reloads it when needed
+    alignas(64) std::atomic<size_t> head;
+    size_t cachedTail;
+    alignas(64) std::atomic<size_t> tail;
+    size_t cachedHead;
+    alignas(64) std::atomic<size_t> dropped;
+    T items[Capacity];
+
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+};
+
+// Far more than a rally produces between two drains (every few ms)
+typedef SpscQueue<RallyEvent, 1024> RallyEventQueue;
+
+#endif // RALLY_EVENTS_H
@@ -0,0 +1,305 @@
+/*
+ * RenderQueue.h
+ * Sorted draw queue for the legacy (fixed-function) renderer
+ *
+ * Every draw call is submitted as an item that carries the GL state it
+ * needs (pass, blend mode, lighting, texture, base color) plus a world
+ * position used for depth sorting. Before drawing, items are sorted by a
+ * 64-bit key so that:
+ * - Opaque items are grouped by state and drawn front-to-back inside a group
+ * - Transparent items are drawn strictly back-to-front after all opaque ones
+ * GL state is only touched when it differs from the previous item (the base
+ * color is set for every item, since draw callbacks change it freely).
+ *
+ * Static items (scenery) stay in the queue between frames and are only
+ * re-sorted when the camera moves or the static set is rebuilt.
+ *
+ * With a profiler attached, each item's draw is timed under its zone
+ * name and the opaque/transparent passes are timed on the GPU.
+ */
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "FrameProfiler.h"
+#include <GL/glut.h>
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+// ============================================================================
+// RENDER ITEM
+// ============================================================================
+
+enum RenderPass {
+    PASS_OPAQUE = 0,
+    PASS_TRANSPARENT = 1
+};
+
+enum BlendMode {
+    BLEND_NONE = 0,
+    BLEND_ALPHA = 1,      // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+    BLEND_ADDITIVE = 2    // GL_SRC_ALPHA, GL_ONE
+};
+
+struct RenderItem {
+    uint64_t key;            // Filled in by the queue
+    RenderPass pass;
+    BlendMode blend;
+    bool lighting;
+    bool depthWrite;
+    GLuint texture;          // 0 = untextured
+    float color[3];          // Base color set before draw (draw may override)
+    float center[3];         // World position used for depth sorting
+    const char* zone;        // Profiler zone, NULL = queue's current zone at submit
+    std::function<void()> draw;
+};
+
+/**
+ * Build an opaque item (no blending, depth write on)
+ * @param x, y, z: World position used for sorting
+ * @param r, g, b: Base color applied before the draw callback
+ * @param lit: Whether GL_LIGHTING is enabled for this item
+ */
+inline RenderItem makeOpaqueItem(float x, float y, float z,
+                                 float r, float g, float b,
+                                 std::function<void()> draw, bool lit = true) {
+    RenderItem item;
+    item.key = 0;
+    item.pass = PASS_OPAQUE;
+    item.blend = BLEND_NONE;
+    item.lighting = lit;
+    item.depthWrite = true;
+    item.texture = 0;
+    item.color[0] = r; item.color[1] = g; item.color[2] = b;
+    item.center[0] = x; item.center[1] = y; item.center[2] = z;
+    item.zone = NULL;
+    item.draw = draw;
+    return item;
+}
+
+/**
+ * Build a transparent item (drawn back-to-front after all opaque items)
+ * @param blend: BLEND_ALPHA or BLEND_ADDITIVE
+ * @param depthWrite: Keep false for glows/decals, true for solid-ish volumes
+ */
+inline RenderItem makeTransparentItem(float x, float y, float z, BlendMode blend,
+                                      std::function<void()> draw, bool lit = false,
+                                      bool depthWrite = false) {
+    RenderItem item = makeOpaqueItem(x, y, z, 1.0f, 1.0f, 1.0f, draw, lit);
+    item.pass = PASS_TRANSPARENT;
+    item.blend = blend;
+    item.depthWrite = depthWrite;
+    return item;
+}
+
+// ============================================================================
+// RENDER QUEUE
+// ============================================================================
+
+class RenderQueue {
+public:
+    // Per-frame statistics (valid after flush)
+    int drawCount;
+    int stateChanges;
+
+    RenderQueue() : drawCount(0), stateChanges(0), staticSorted(false),
+                    profiler(NULL), submitZone(NULL), stateValid(false) {
+        camPos[0] = camPos[1] = camPos[2] = 0.0f;
+    }
+
+    /**
+     * Set the eye position for this frame.
+     * Static items are only re-sorted when this actually changes.
+     */
+    void setCamera(float x, float y, float z) {
+        if (x != camPos[0] || y != camPos[1] || z != camPos[2]) {
+            camPos[0] = x; camPos[1] = y; camPos[2] = z;
+            staticSorted = false;
+        }
+    }
+
+    // Time item draws and passes with this profiler (NULL = off)
+    void setProfiler(FrameProfiler* p) { profiler = p; }
+
+    // Profiler zone given to items submitted from now on without their own
+    void setZone(const char* zone) { submitZone = zone; }
+
+    // Item lives for a single frame (players, ball, sun, ...)
+    void submit(const RenderItem& item) {
+        dynamicItems.push_back(item);
+        if (!item.zone) dynamicItems.back().zone = submitZone;
+    }
+
+    // Item persists until clearStatic() (court, trees, fences, ...)
+    void submitStatic(const RenderItem& item) {
+        staticItems.push_back(item);
+        if (!item.zone) staticItems.back().zone = submitZone;
+        staticSorted = false;
+    }
+
+    void clearStatic() {
+        staticItems.clear();
+        staticOrder.clear();
+        staticSorted = false;
+    }
+
+    bool hasStatic() const { return !staticItems.empty(); }
+
+    /**
+     * Sort and draw everything that was submitted, then drop the
+     * per-frame items. Leaves GL in the default scene state
+     * (lighting on, alpha blending on, depth write on, no texture).
+     */
+    void flush() {
+        if (!staticSorted) {
+            sortItems(staticItems, staticOrder);
+            staticSorted = true;
+        }
+        sortItems(dynamicItems, dynamicOrder);
+
+        frameOrder.resize(staticOrder.size() + dynamicOrder.size());
+        std::merge(staticOrder.begin(), staticOrder.end(),
+                   dynamicOrder.begin(), dynamicOrder.end(),
+                   frameOrder.begin(), compareKeys);
+
+        drawCount = 0;
+        stateChanges = 0;
+        stateValid = false;
+
+        const char* openZone = NULL;
+        for (size_t i = 0; i < frameOrder.size(); i++) {
+            const RenderItem* item = frameOrder[i];
+            if (profiler) {
+                if (i == 0 || item->pass != frameOrder[i - 1]->pass) {
+                    profiler->beginGpuZone(item->pass == PASS_OPAQUE ? "Opaque pass" : "Transparent pass");
+                }
+                if (item->zone != openZone) {
+                    if (openZone) profiler->endZone();
+                    if (item->zone) profiler->beginZone(item->zone);
+                    openZone = item->zone;
+                }
+            }
+            applyState(*item);
+            item->draw();
+            drawCount++;
+        }
+        if (profiler) {
+            if (openZone) profiler->endZone();
+            profiler->endGpuZone();
+        }
+
+        restoreDefaults();
+        dynamicItems.clear();
+    }
+
+private:
+    std::vector<RenderItem> staticItems;
+    std::vector<RenderItem> dynamicItems;
+    std::vector<const RenderItem*> staticOrder;
+    std::vector<const RenderItem*> dynamicOrder;
+    std::vector<const RenderItem*> frameOrder;
+    bool staticSorted;
+    float camPos[3];
+    FrameProfiler* profiler;
+    const char* submitZone;
+
+    // Bound-state cache
+    bool stateValid;
+    bool curLighting;
+    bool curDepthWrite;
+    BlendMode curBlend;
+    GLuint curTexture;
+
+    static bool compareKeys(const RenderItem* a, const RenderItem* b) {
+        return a->key < b->key;
+    }
+
+    // IEEE floats >= 0 keep their ordering when compared as integers
+    static uint32_t depthBits(float d) {
+        uint32_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        return bits;
+    }
+
+    /*
+     * Key layout
+     * Opaque:      [63 pass=0][62 unlit][61-60 blend][59-48 texture][31-0 depth]
+     * Transparent: [63 pass=1][62-31 ~depth][30 unlit][29-28 blend][27-16 texture]
+     * Color is not part of the key: every draw callback sets its own colors,
+     * so the base color is re-applied per item and grouping by it saves nothing.
+     */
+    uint64_t computeKey(const RenderItem& item) const {
+        float dx = item.center[0] - camPos[0];
+        float dy = item.center[1] - camPos[1];
+        float dz = item.center[2] - camPos[2];
+        uint64_t depth = depthBits(dx*dx + dy*dy + dz*dz);
+        uint64_t unlit = item.lighting ? 0 : 1;
+        uint64_t blend = (uint64_t)item.blend & 0x3;
+        uint64_t tex = (uint64_t)item.texture & 0xFFF;
+
+        if (item.pass == PASS_OPAQUE) {
+            return (unlit << 62) | (blend << 60) | (tex << 48) | depth;
+        }
+        uint64_t farFirst = (~depth) & 0xFFFFFFFFull;
+        return (1ull << 63) | (farFirst << 31) | (unlit << 30) |
+               (blend << 28) | (tex << 16);
+    }
+
+    void sortItems(std::vector<RenderItem>& items, std::vector<const RenderItem*>& order) {
+        order.resize(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            items[i].key = computeKey(items[i]);
+            order[i] = &items[i];
+        }
+        std::stable_sort(order.begin(), order.end(), compareKeys);
+    }
+
+    void applyState(const RenderItem& item) {
+        if (!stateValid || item.lighting != curLighting) {
+            if (item.lighting) glEnable(GL_LIGHTING);
+            else glDisable(GL_LIGHTING);
+            curLighting = item.lighting;
+            stateChanges++;
+        }
+        if (!stateValid || item.blend != curBlend) {
+            if (item.blend == BLEND_NONE) {
+                glDisable(GL_BLEND);
+            } else {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, item.blend == BLEND_ADDITIVE ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+            }
+            curBlend = item.blend;
+            stateChanges++;
+        }
+        if (!stateValid || item.depthWrite != curDepthWrite) {
+            glDepthMask(item.depthWrite ? GL_TRUE : GL_FALSE);
+            curDepthWrite = item.depthWrite;
+            stateChanges++;
+        }
+        if (!stateValid || item.texture != curTexture) {
+            if (item.texture) {
+                glEnable(GL_TEXTURE_2D);
+                glBindTexture(GL_TEXTURE_2D, item.texture);
+            } else {
+                glDisable(GL_TEXTURE_2D);
+            }
+            curTexture = item.texture;
+            stateChanges++;
+        }
+        glColor3fv(item.color);  // The previous draw callback may have changed it
+        stateValid = true;
+    }
+
+    void restoreDefaults() {
+        glEnable(GL_LIGHTING);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_TEXTURE_2D);
+    }
+};
+
+#endif // RENDER_QUEUE_H
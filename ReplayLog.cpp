@@ -0,0 +1,338 @@
+/*
+ * ReplayLog.cpp
+ * Replay log recorder (background writer) and memory-mapped player
+ */
+
+#include "ReplayLog.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Encoded records are handed to the writer once the buffer is this large
+const size_t REPLAY_FLUSH_BYTES = 64 * 1024;
+
+// ============================================================================
+// RECORDER
+// ============================================================================
+
+ReplayRecorder::ReplayRecorder() : file(NULL), stopping(false), lastTick(0),
+                                   stateWords(0), viewWords(0) {}
+
+ReplayRecorder::~ReplayRecorder() {
+    stop();
+}
+
+bool ReplayRecorder::start(const char* path, uint64_t seed, float tickRate,
+                           int stateCount, int viewCount, int keyframeInterval) {
+    stop();
+    file = fopen(path, "wb");
+    if (!file) return false;
+
+    ReplayHeader header;
+    header.magic = REPLAY_MAGIC;
+    header.version = REPLAY_VERSION;
+    header.seed = seed;
+    header.tickRate = tickRate;
+    header.stateWords = (uint32_t)stateCount;
+    header.viewWords = (uint32_t)viewCount;
+    header.keyframeInterval = (uint32_t)keyframeInterval;
+    fwrite(&header, sizeof(header), 1, file);
+
+    stateWords = stateCount;
+    viewWords = viewCount;
+    previousKeyframe.assign(stateCount + viewCount, 0);
+    lastTick = 0;
+    buffer.clear();
+    stopping = false;
+    writer = std::thread(&ReplayRecorder::writerLoop, this);
+    return true;
+}
+
+void ReplayRecorder::stop() {
+    if (!file) return;
+    submitBuffer();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    fclose(file);
+    file = NULL;
+}
+
+void ReplayRecorder::appendVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((uint8_t)value);
+}
+
+void ReplayRecorder::beginRecord(ReplayRecordType type, long long tick) {
+    buffer.push_back((uint8_t)type);
+    appendVarint((uint64_t)(tick - lastTick));
+    lastTick = tick;
+}
+
+void ReplayRecorder::recordInput(long long tick, ReplayRecordType type, int code) {
+    if (!file) return;
+    beginRecord(type, tick);
+    appendVarint((uint64_t)(uint32_t)code);
+    if (buffer.size() >= REPLAY_FLUSH_BYTES) submitBuffer();
+}
+
+void ReplayRecorder::recordKeyframe(long long tick, const uint32_t* state, const uint32_t* view) {
+    if (!file) return;
+    beginRecord(REPLAY_KEYFRAME, tick);
+    for (int i = 0; i < stateWords + viewWords; i++) {
+        uint32_t word = (i < stateWords) ? state[i] : view[i - stateWords];
+        appendVarint(word ^ previousKeyframe[i]);
+        previousKeyframe[i] = word;
+    }
+    // Keyframes are a natural flush point: a crash loses at most one interval
+    submitBuffer();
+}
+
+void ReplayRecorder::submitBuffer() {
+    if (buffer.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::vector<uint8_t>());
+        pending.back().swap(buffer);
+    }
+    wake.notify_one();
+}
+
+void ReplayRecorder::writerLoop() {
+    std::vector<std::vector<uint8_t> > work;
+    for (;;) {
+        bool done;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (pending.empty() && !stopping) wake.wait(lock);
+            work.swap(pending);
+            done = stopping && work.empty();
+        }
+        if (done) break;
+        for (size_t i = 0; i < work.size(); i++) {
+            fwrite(&work[i][0], 1, work[i].size(), file);
+        }
+        fflush(file);
+        work.clear();
+    }
+}
+
+// ============================================================================
+// PLAYER
+// ============================================================================
+
+ReplayPlayer::ReplayPlayer() : data(NULL), size(0), fileHandle(NULL), mapHandle(NULL),
+                               endTick(0), cursor(0), cursorTick(0) {
+    memset(&fileHeader, 0, sizeof(fileHeader));
+}
+
+ReplayPlayer::~ReplayPlayer() {
+    close();
+}
+
+#ifdef _WIN32
+bool ReplayPlayer::mapFile(const char* path) {
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+    fileHandle = handle;
+    mapHandle = mapping;
+    data = (const uint8_t*)view;
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void ReplayPlayer::unmapFile() {
+    if (data) UnmapViewOfFile(data);
+    if (mapHandle) CloseHandle((HANDLE)mapHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+}
+#else
+bool ReplayPlayer::mapFile(const char* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    // The mapping stays valid
+    if (view == MAP_FAILED) return false;
+    data = (const uint8_t*)view;
+    size = (size_t)info.st_size;
+    return true;
+}
+
+void ReplayPlayer::unmapFile() {
+    if (data) munmap((void*)data, size);
+}
+#endif
+
+void ReplayPlayer::close() {
+    unmapFile();
+    data = NULL;
+    size = 0;
+    fileHandle = NULL;
+    mapHandle = NULL;
+    keyframes.clear();
+    endTick = 0;
+    cursor = 0;
+    cursorTick = 0;
+}
+
+bool ReplayPlayer::readVarint(size_t& pos, uint64_t& value) const {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;   // Truncated (e.g. the recording was killed mid-write)
+}
+
+// tick is the previous record's tick on input, this record's on output
+bool ReplayPlayer::readRecordHeader(size_t& pos, long long& tick, ReplayRecordType& type) const {
+    if (pos >= size) return false;
+    type = (ReplayRecordType)data[pos++];
+    uint64_t delta;
+    if (!readVarint(pos, delta)) return false;
+    tick += (long long)delta;
+    return type == REPLAY_KEY || type == REPLAY_SPECIAL_KEY || type == REPLAY_KEYFRAME;
+}
+
+bool ReplayPlayer::skipKeyframe(size_t& pos) const {
+    uint64_t word;
+    for (uint32_t i = 0; i < fileHeader.stateWords + fileHeader.viewWords; i++) {
+        if (!readVarint(pos, word)) return false;
+    }
+    return true;
+}
+
+bool ReplayPlayer::open(const char* path) {
+    close();
+    if (!mapFile(path)) return false;
+
+    if (size < sizeof(ReplayHeader)) {
+        close();
+        return false;
+    }
+    memcpy(&fileHeader, data, sizeof(fileHeader));
+    if (fileHeader.magic != REPLAY_MAGIC || fileHeader.version != REPLAY_VERSION) {
+        close();
+        return false;
+    }
+
+    // Walk all records once: decode keyframes (they are deltas of each
+    // other) and find the end of the valid data
+    int wordCount = fileHeader.stateWords + fileHeader.viewWords;
+    std::vector<uint32_t> words(wordCount, 0);
+    size_t pos = sizeof(ReplayHeader);
+    long long tick = 0;
+    for (;;) {
+        ReplayRecordType type;
+        if (!readRecordHeader(pos, tick, type)) break;
+        if (type == REPLAY_KEYFRAME) {
+            bool complete = true;
+            for (int i = 0; i < wordCount && complete; i++) {
+                uint64_t delta;
+                complete = readVarint(pos, delta);
+                words[i] ^= (uint32_t)delta;
+            }
+            if (!complete) break;
+            ReplayKeyframe keyframe;
+            keyframe.tick = tick;
+            keyframe.nextRecord = pos;
+            keyframe.words = words;
+            keyframes.push_back(keyframe);
+        } else {
+            uint64_t code;
+            if (!readVarint(pos, code)) break;
+        }
+        endTick = tick;
+    }
+
+    if (keyframes.empty()) {
+        close();
+        return false;
+    }
+    seek(0);
+    return true;
+}
+
+const ReplayKeyframe* ReplayPlayer::seek(long long tick) {
+    if (keyframes.empty()) return NULL;
+    // Keyframes are in tick order; find the last one <= tick
+    size_t lo = 0, hi = keyframes.size();
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (keyframes[mid].tick <= tick) lo = mid;
+        else hi = mid;
+    }
+    const ReplayKeyframe& keyframe = keyframes[lo];
+    cursor = keyframe.nextRecord;
+    cursorTick = keyframe.tick;
+    return &keyframe;
+}
+
+bool ReplayPlayer::nextInput(long long tick, ReplayInput& input) {
+    for (;;) {
+        size_t pos = cursor;
+        long long recordTick = cursorTick;
+        ReplayRecordType type;
+        if (!readRecordHeader(pos, recordTick, type) || recordTick > tick) return false;
+
+        if (type == REPLAY_KEYFRAME) {
+            if (!skipKeyframe(pos)) return false;
+            cursor = pos;
+            cursorTick = recordTick;
+            continue;
+        }
+
+        uint64_t code;
+        if (!readVarint(pos, code)) return false;
+        cursor = pos;
+        cursorTick = recordTick;
+        input.tick = recordTick;
+        input.type = type;
+        input.code = (int)code;
+        return true;
+    }
+}
+
+const ReplayKeyframe* ReplayPlayer::keyframeAt(long long tick) const {
+    size_t lo = 0, hi = keyframes.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (keyframes[mid].tick < tick) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < keyframes.size() && keyframes[lo].tick == tick) ? &keyframes[lo] : NULL;
+}
@@ -0,0 +1,176 @@
+/*
+ * ReplayLog.h
+ * Binary replay log: seed, inputs and periodic state keyframes
+ *
+ * A run is fully determined by its seed, tick rate and the inputs applied
+ * at each tick (see Simulation.h), so the log stores exactly that, plus a
+ * keyframe of the packed simulation state and camera every few seconds
+ * for seeking and for catching desyncs.
+ *
+ * File layout (little-endian):
+ *   ReplayHeader (32 bytes)
+ *   Records: [type u8][tick delta varint][payload]
+ *     REPLAY_KEY / REPLAY_SPECIAL_KEY: key code varint
+ *     REPLAY_KEYFRAME: state + view words, each XOR'ed with the previous
+ *                      keyframe and stored as a varint (unchanged = 1 byte)
+ *
+ * The recorder encodes on the calling thread and hands finished buffers
+ * to a background thread for the file writes. The player memory-maps the
+ * file and indexes the keyframes when it is opened.
+ */
+
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+const uint32_t REPLAY_MAGIC = 0x4c524250;    // "PBRL"
+const uint32_t REPLAY_VERSION = 1;
+
+enum ReplayRecordType {
+    REPLAY_KEY = 1,            // keyboard() key
+    REPLAY_SPECIAL_KEY = 2,    // specialKeys() key
+    REPLAY_KEYFRAME = 3
+};
+
+struct ReplayHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seed;
+    float tickRate;
+    uint32_t stateWords;       // SIM_STATE_WORDS of the recording build
+    uint32_t viewWords;        // Camera/time-of-day words stored by the scene
+    uint32_t keyframeInterval; // Ticks between keyframes
+};
+
+struct ReplayInput {
+    long long tick;            // Applied before this tick is simulated
+    ReplayRecordType type;
+    int code;
+};
+
+struct ReplayKeyframe {
+    long long tick;
+    size_t nextRecord;             // File offset just after this keyframe
+    std::vector<uint32_t> words;   // State words followed by view words
+};
+
+// ============================================================================
+// RECORDER
+// ============================================================================
+
+class ReplayRecorder {
+public:
+    ReplayRecorder();
+    ~ReplayRecorder();
+
+    /**
+     * Create the log file and start the writer thread
+     * @param seed, tickRate: Simulation setup needed to replay the run
+     * @param stateWords, viewWords: Word counts of every keyframe
+     * @param keyframeInterval: Ticks between keyframes (caller decides when)
+     */
+    bool start(const char* path, uint64_t seed, float tickRate,
+               int stateWords, int viewWords, int keyframeInterval);
+
+    // Flush everything and close the file
+    void stop();
+
+    bool isRecording() const { return file != NULL; }
+
+    void recordInput(long long tick, ReplayRecordType type, int code);
+
+    /**
+     * Store a keyframe and hand the buffered records to the writer
+     * @param state: stateWords words, @param view: viewWords words
+     */
+    void recordKeyframe(long long tick, const uint32_t* state, const uint32_t* view);
+
+private:
+    FILE* file;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::vector<uint8_t> > pending;   // Filled buffers for the writer
+    bool stopping;
+
+    std::vector<uint8_t> buffer;                   // Records being encoded
+    std::vector<uint32_t> previousKeyframe;
+    long long lastTick;
+    int stateWords;
+    int viewWords;
+
+    void beginRecord(ReplayRecordType type, long long tick);
+    void appendVarint(uint64_t value);
+    void submitBuffer();
+    void writerLoop();
+
+    ReplayRecorder(const ReplayRecorder&);
+    ReplayRecorder& operator=(const ReplayRecorder&);
+};
+
+// ============================================================================
+// PLAYER
+// ============================================================================
+
+class ReplayPlayer {
+public:
+    ReplayPlayer();
+    ~ReplayPlayer();
+
+    // Map the file, check the header and index all keyframes
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const { return data != NULL; }
+    const ReplayHeader& header() const { return fileHeader; }
+    long long lastTick() const { return endTick; }
+    long long keyframeCount() const { return (long long)keyframes.size(); }
+
+    /**
+     * Jump to the last keyframe at or before tick. Inputs are read from
+     * there on; the caller restores the keyframe words and simulates
+     * forward to the exact tick.
+     * @return The keyframe (never NULL once a log with a keyframe is open)
+     */
+    const ReplayKeyframe* seek(long long tick);
+
+    /**
+     * Next input to apply before simulating tick
+     * @return false when no more inputs are due at this tick
+     */
+    bool nextInput(long long tick, ReplayInput& input);
+
+    // Keyframe recorded at exactly this tick (desync checks), NULL if none
+    const ReplayKeyframe* keyframeAt(long long tick) const;
+
+private:
+    const uint8_t* data;
+    size_t size;
+    void* fileHandle;
+    void* mapHandle;
+
+    ReplayHeader fileHeader;
+    std::vector<ReplayKeyframe> keyframes;
+    long long endTick;
+
+    // Input cursor
+    size_t cursor;
+    long long cursorTick;
+
+    bool readVarint(size_t& pos, uint64_t& value) const;
+    bool readRecordHeader(size_t& pos, long long& tick, ReplayRecordType& type) const;
+    bool skipKeyframe(size_t& pos) const;
+    bool mapFile(const char* path);
+    void unmapFile();
+
+    ReplayPlayer(const ReplayPlayer&);
+    ReplayPlayer& operator=(const ReplayPlayer&);
+};
+
+#endif // REPLAY_LOG_H
@@ -0,0 +1,159 @@
+/*
+ * SceneRenderTarget.h
+ * Offscreen scene framebuffer with resolution scale and MSAA sample count
+ *
+ * The window is created without multisampling when this is used; the
+ * scene is drawn into a framebuffer object of scale * window size with
+ * the chosen sample count, resolved, and stretched onto the window with
+ * a linear blit. Overlays (profiler, capture) then work on the window at
+ * full resolution as before.
+ * - Both settings can change every frame; buffers are rebuilt on change
+ * - Falls back to drawing straight into the window without GL 3.0 FBOs
+ */
+
+#ifndef SCENE_RENDER_TARGET_H
+#define SCENE_RENDER_TARGET_H
+
+#include "GLExtensions.h"
+
+class SceneRenderTarget {
+public:
+    SceneRenderTarget() : scale(1.0f), samples(0), width(0), height(0), builtSamples(-1),
+                          maxSamples(0), active(false), broken(false), sceneFbo(0), resolveFbo(0) {
+        colorBuffers[0] = colorBuffers[1] = 0;
+        depthBuffer = 0;
+    }
+
+    ~SceneRenderTarget() { release(); }
+
+    // Needs a current GL context
+    bool isSupported() {
+        GLExtensions& ext = loadGLExtensions();
+        if (ext.hasFramebuffer && maxSamples == 0) glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        return ext.hasFramebuffer && !broken;
+    }
+
+    // Fraction of the window size the scene is rendered at (0.25..1)
+    void setScale(float s) { scale = s < 0.25f ? 0.25f : (s > 1.0f ? 1.0f : s); }
+    float getScale() const { return scale; }
+
+    // MSAA samples, 0 = off (clamped to what the driver supports)
+    void setSamples(int count) { samples = count < 0 ? 0 : count; }
+    int getSamples() const { return samples < maxSamples ? samples : maxSamples; }
+
+    /**
+     * Bind the scene framebuffer and set the viewport to its size
+     * @param windowW, windowH: Window size in pixels
+     */
+    void begin(int windowW, int windowH) {
+        active = false;
+        if (!isSupported()) return;
+        int w = (int)(windowW * scale + 0.5f);
+        int h = (int)(windowH * scale + 0.5f);
+        if (w < 1) w = 1;
+        if (h < 1) h = 1;
+        if (w != width || h != height || getSamples() != builtSamples) {
+            if (!build(w, h, getSamples())) {
+                // Try without MSAA next frame; give up if even that fails
+                if (samples > 0) samples = 0;
+                else broken = true;
+                return;
+            }
+        }
+        glExt().bindFramebuffer(GL_FRAMEBUFFER, sceneFbo);
+        glViewport(0, 0, width, height);
+        active = true;
+    }
+
+    /**
+     * Resolve and stretch the scene onto the window, leave the window bound
+     * @param windowW, windowH: Window size in pixels (viewport is restored)
+     */
+    void end(int windowW, int windowH) {
+        if (!active) return;
+        GLExtensions& ext = glExt();
+        GLuint source = sceneFbo;
+        if (builtSamples > 0) {
+            // Multisample buffers can only be blitted 1:1, so resolve first
+            ext.bindFramebuffer(GL_READ_FRAMEBUFFER, sceneFbo);
+            ext.bindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFbo);
+            ext.blitFramebuffer(0, 0, width, height, 0, 0, width, height,
+                                GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            source = resolveFbo;
+        }
+        ext.bindFramebuffer(GL_READ_FRAMEBUFFER, source);
+        ext.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        ext.blitFramebuffer(0, 0, width, height, 0, 0, windowW, windowH, GL_COLOR_BUFFER_BIT,
+                            (width == windowW && height == windowH) ? GL_NEAREST : GL_LINEAR);
+        ext.bindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, windowW, windowH);
+        active = false;
+    }
+
+    void release() {
+        if (!sceneFbo) return;
+        GLExtensions& ext = glExt();
+        ext.deleteFramebuffers(1, &sceneFbo);
+        ext.deleteFramebuffers(1, &resolveFbo);
+        ext.deleteRenderbuffers(2, colorBuffers);
+        ext.deleteRenderbuffers(1, &depthBuffer);
+        sceneFbo = resolveFbo = depthBuffer = 0;
+        colorBuffers[0] = colorBuffers[1] = 0;
+        width = height = 0;
+        builtSamples = -1;
+    }
+
+private:
+    float scale;
+    int samples;
+    int width, height;        // Current buffer size
+    int builtSamples;         // Sample count of the current buffers
+    GLint maxSamples;
+    bool active;
+    bool broken;
+
+    GLuint sceneFbo;          // Drawn into (multisampled when builtSamples > 0)
+    GLuint resolveFbo;        // Single-sample copy used for the scaled blit
+    GLuint colorBuffers[2];   // Scene, resolve
+    GLuint depthBuffer;
+
+    bool build(int w, int h, int sampleCount) {
+        release();
+        GLExtensions& ext = glExt();
+        ext.genFramebuffers(1, &sceneFbo);
+        ext.genFramebuffers(1, &resolveFbo);
+        ext.genRenderbuffers(2, colorBuffers);
+        ext.genRenderbuffers(1, &depthBuffer);
+
+        ext.bindRenderbuffer(GL_RENDERBUFFER, colorBuffers[0]);
+        ext.renderbufferStorageMultisample(GL_RENDERBUFFER, sampleCount, GL_RGBA8, w, h);
+        ext.bindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        ext.renderbufferStorageMultisample(GL_RENDERBUFFER, sampleCount, GL_DEPTH_COMPONENT24, w, h);
+        ext.bindFramebuffer(GL_FRAMEBUFFER, sceneFbo);
+        ext.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffers[0]);
+        ext.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        bool complete = ext.checkFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        if (complete && sampleCount > 0) {
+            ext.bindRenderbuffer(GL_RENDERBUFFER, colorBuffers[1]);
+            ext.renderbufferStorageMultisample(GL_RENDERBUFFER, 0, GL_RGBA8, w, h);
+            ext.bindFramebuffer(GL_FRAMEBUFFER, resolveFbo);
+            ext.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffers[1]);
+            complete = ext.checkFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+        ext.bindRenderbuffer(GL_RENDERBUFFER, 0);
+        ext.bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (!complete) {
+            fprintf(stderr, "Scene framebuffer %dx%d (%d samples) is incomplete\n", w, h, sampleCount);
+            release();
+            return false;
+        }
+        width = w;
+        height = h;
+        builtSamples = sampleCount;
+        return true;
+    }
+};
+
+#endif // SCENE_RENDER_TARGET_H
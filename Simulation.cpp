@@ -0,0 +1,690 @@
+/*
+ * Simulation.cpp
+ * Rally simulation: ball physics, player movement, walkers on the track
+ * and the headless runner used for tuning runs.
+ */
+
+#include "Simulation.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>  // for memcpy()
+#include <chrono>
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+void initSimulation(SimulationState& sim, uint64_t seed) {
+    sim.ballPosX = -3.5f;
+    sim.ballPosY = 1.5f;     // Start well above net (0.914m)
+    sim.ballPosZ = 0.0f;
+    sim.ballVelocityX = 4.8f;   // Moderate horizontal speed (m/s)
+    sim.ballVelocityY = 1.8f;   // Gentle arc for consistent net clearance (m/s)
+    sim.ballVelocityZ = 0.0f;
+    sim.ballTeleports = 0;
+    sim.isPaused = false;
+    
+    sim.rallyCount = 0;
+    sim.currentServer = 1;
+    sim.targetArmSwing1 = 0.0f;
+    sim.targetArmSwing2 = 0.0f;
+    
+    PlayerState p1 = {0, 0, 0, 0, 0, -COURT_LENGTH/4, 0, -COURT_LENGTH/4, 0, 4.8f};
+    PlayerState p2 = {0, 0, 0, 0, 0, COURT_LENGTH/4, 0, COURT_LENGTH/4, 0, 4.8f};
+    sim.player1 = p1;
+    sim.player2 = p2;
+    
+    // Track offset = 9.0f, trackWidth = 3.0f, middle of track = 10.5f from center
+    WalkerState w1 = {-COURT_LENGTH/2 - 10.5f, -COURT_WIDTH/2 - 10.5f, 0, 2.4f, 0, 0, 0, 0, 3, 0.0f};  // Person with dog
+    WalkerState w2 = {COURT_LENGTH/2 + 10.5f, -COURT_WIDTH/2 - 10.0f, 180, 2.4f, 0, 0, 0, 0, 0, 0.5f}; // Walking couple (person 1 - left)
+    WalkerState w3 = {COURT_LENGTH/2 + 10.5f, -COURT_WIDTH/2 - 11.0f, 180, 2.4f, 0, 0, 0, 0, 0, 0.5f}; // Walking couple (person 2 - right)
+    WalkerState w4 = {-COURT_LENGTH/2 - 10.5f, COURT_WIDTH/2 + 10.5f, 270, 2.4f, 0, 0, 0, 0, 2, 0.7f}; // Walker (same speed)
+    sim.walkers[0] = w1;
+    sim.walkers[1] = w2;
+    sim.walkers[2] = w3;
+    sim.walkers[3] = w4;
+    
+    // Dog position (follows walker 1)
+    sim.dogPosX = w1.posX + 1.5f;
+    sim.dogPosZ = w1.posZ;
+    sim.dogAngle = w1.angle; // Dog faces same direction as walker
+    
+    sim.windTime = 0.0f;
+    sim.windStrength = 1.0f;
+    sim.animationTime = 0.0f;
+    
+    seedRandom(sim.rng, seed);
+    sim.tick = 0;
+    
+    sim.events = NULL;
+    sim.stats = NULL;
+}
+
+// ============================================================================
+// RANDOM NUMBERS - PCG32 (XSH RR variant)
+// ============================================================================
+
+void seedRandom(SimRandom& rng, uint64_t seed, uint64_t stream) {
+    rng.state = 0;
+    rng.inc = (stream << 1) | 1u;
+    nextRandom(rng);
+    rng.state += seed;
+    nextRandom(rng);
+}
+
+uint32_t nextRandom(SimRandom& rng) {
+    uint64_t old = rng.state;
+    rng.state = old * 6364136223846793005ULL + rng.inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+int randomInt(SimRandom& rng, int bound) {
+    // Reject the low values that would make some results more likely
+    uint32_t threshold = (uint32_t)(-(uint32_t)bound) % (uint32_t)bound;
+    for (;;) {
+        uint32_t r = nextRandom(rng);
+        if (r >= threshold) return (int)(r % (uint32_t)bound);
+    }
+}
+
+// ============================================================================
+// STATE PACKING AND HASH
+// ============================================================================
+
+struct StateWriter {
+    uint32_t* out;
+    int n;
+    void f(const float& v) { memcpy(&out[n++], &v, sizeof(v)); }
+    void i(const int& v) { out[n++] = (uint32_t)v; }
+    void b(const bool& v) { out[n++] = v ? 1u : 0u; }
+    void u64(const uint64_t& v) { out[n++] = (uint32_t)v; out[n++] = (uint32_t)(v >> 32); }
+    void i64(const long long& v) { u64((uint64_t)v); }
+};
+
+struct StateReader {
+    const uint32_t* in;
+    int n;
+    void f(float& v) { memcpy(&v, &in[n++], sizeof(v)); }
+    void i(int& v) { v = (int)in[n++]; }
+    void b(bool& v) { v = in[n++] != 0; }
+    void u64(uint64_t& v) { v = in[n] | ((uint64_t)in[n + 1] << 32); n += 2; }
+    void i64(long long& v) { uint64_t u; u64(u); v = (long long)u; }
+};
+
+template <typename Words, typename Player>
+static void visitPlayerWords(Words& w, Player& p) {
+    w.f(p.legAngle1); w.f(p.legAngle2);
+    w.f(p.armSwing); w.f(p.bodyTilt); w.f(p.jumpHeight);
+    w.f(p.posX); w.f(p.posZ);
+    w.f(p.targetX); w.f(p.targetZ);
+    w.f(p.moveSpeed);
+}
+
+// The one place that lists the simulated fields (SIM_STATE_WORDS words).
+// Output-only fields (events, stats, ballTeleports) are left out.
+template <typename Words, typename State>
+static void visitStateWords(Words& w, State& sim) {
+    w.f(sim.ballPosX); w.f(sim.ballPosY); w.f(sim.ballPosZ);
+    w.f(sim.ballVelocityX); w.f(sim.ballVelocityY); w.f(sim.ballVelocityZ);
+    w.b(sim.isPaused);
+    w.i(sim.rallyCount);
+    w.i(sim.currentServer);
+    w.f(sim.targetArmSwing1); w.f(sim.targetArmSwing2);
+    visitPlayerWords(w, sim.player1);
+    visitPlayerWords(w, sim.player2);
+    for (int k = 0; k < 4; k++) {
+        w.f(sim.walkers[k].posX); w.f(sim.walkers[k].posZ);
+        w.f(sim.walkers[k].angle); w.f(sim.walkers[k].speed);
+        w.f(sim.walkers[k].legAngle1); w.f(sim.walkers[k].legAngle2);
+        w.f(sim.walkers[k].armSwing1); w.f(sim.walkers[k].armSwing2);
+        w.i(sim.walkers[k].pathSegment);
+        w.f(sim.walkers[k].pathProgress);
+    }
+    w.f(sim.dogPosX); w.f(sim.dogPosZ); w.f(sim.dogAngle);
+    w.f(sim.windTime); w.f(sim.windStrength); w.f(sim.animationTime);
+    w.u64(sim.rng.state);
+    w.u64(sim.rng.inc);
+    w.i64(sim.tick);
+}
+
+void packSimulationState(const SimulationState& sim, uint32_t* words) {
+    StateWriter w = {words, 0};
+    visitStateWords(w, sim);
+}
+
+void unpackSimulationState(const uint32_t* words, SimulationState& sim) {
+    StateReader r = {words, 0};
+    visitStateWords(r, sim);
+}
+
+// 64-bit FNV-1a over the packed words (bit patterns, not rounded values)
+uint64_t hashSimulationState(const SimulationState& sim) {
+    uint32_t words[SIM_STATE_WORDS];
+    packSimulationState(sim, words);
+    uint64_t h = 14695981039346656037ULL;
+    const unsigned char* p = (const unsigned char*)words;
+    for (size_t i = 0; i < sizeof(words); i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+
+float approachFactor(float ratePerSecond, float dt) {
+    return 1.0f - expf(-ratePerSecond * dt);
+}
+
+// ============================================================================
+// RALLY EVENTS
+// ============================================================================
+
+static void recordPaddleHit(SimulationState& sim) {
+    if (!sim.stats) return;
+    sim.stats->paddleHits++;
+    sim.stats->currentRally++;
+}
+
+// The ball needed help (net, back wall, reset) - the rally in progress is over
+static void endRally(SimulationState& sim) {
+    if (!sim.stats) return;
+    sim.stats->rallies.push_back(sim.stats->currentRally);
+    sim.stats->currentRally = 0;
+}
+
+// Copy into the event ring; never waits (a full ring drops the event)
+static void postEvent(SimulationState& sim, RallyEventType type, int side = 0) {
+    if (!sim.events) return;
+    RallyEvent event;
+    event.type = type;
+    event.side = side;
+    event.rally = sim.rallyCount;
+    event.tick = sim.tick;
+    event.position[0] = sim.ballPosX;
+    event.position[1] = sim.ballPosY;
+    event.position[2] = sim.ballPosZ;
+    event.velocity[0] = sim.ballVelocityX;
+    event.velocity[1] = sim.ballVelocityY;
+    event.velocity[2] = sim.ballVelocityZ;
+    sim.events->push(event);
+}
+
+// ============================================================================
+// UPDATE
+// ============================================================================
+
+// Calculate paddle position in world space
+void getPaddlePosition(const PlayerState& state, bool isPlayer1, float& paddleX, float& paddleY, float& paddleZ) {
+    // Paddle is attached to right arm, extended forward
+    float armExtension = 0.6f;  // How far paddle extends from body
+    
+    if (isPlayer1) {
+        paddleX = state.posX + armExtension * cos(state.armSwing * PI / 180.0f);
+        paddleY = 1.2f + state.jumpHeight + 0.3f * sin(state.armSwing * PI / 180.0f);
+        paddleZ = state.posZ;
+    } else {
+        paddleX = state.posX - armExtension * cos(state.armSwing * PI / 180.0f);
+        paddleY = 1.2f + state.jumpHeight + 0.3f * sin(state.armSwing * PI / 180.0f);
+        paddleZ = state.posZ;
+    }
+}
+
+// Check if ball hits paddle
+bool checkPaddleHit(const SimulationState& sim, float paddleX, float paddleY, float paddleZ) {
+    float dx = sim.ballPosX - paddleX;
+    float dy = sim.ballPosY - paddleY;
+    float dz = sim.ballPosZ - paddleZ;
+    float distance = sqrt(dx*dx + dy*dy + dz*dz);
+    
+    const float PADDLE_RADIUS = 0.5f;  // Paddle hit zone
+    return distance < PADDLE_RADIUS;
+}
+
+// A ball that stopped bouncing rests on the court until it is served again
+static bool ballAtRest(const SimulationState& sim) {
+    return sim.ballPosY == BALL_GROUND_Y && sim.ballVelocityY == 0.0f;
+}
+
+// Move the ball along its exact constant-gravity arc for dt seconds.
+// A ground bounce happens at the moment the arc reaches BALL_GROUND_Y and
+// the rest of the step continues from there, so bounce heights do not
+// depend on the tick length.
+static void moveBall(SimulationState& sim, float dt) {
+    if (ballAtRest(sim)) return;
+    
+    // Below the ground already (e.g. struck low): lift it and bounce now
+    if (sim.ballPosY < BALL_GROUND_Y && sim.ballVelocityY < 0) {
+        sim.ballPosY = BALL_GROUND_Y;
+        sim.ballVelocityY = -sim.ballVelocityY * BALL_BOUNCE;
+        postEvent(sim, RALLY_BOUNCE);
+    }
+    
+    float remaining = dt;
+    for (int bounces = 0; bounces < 4 && remaining > 0.0f; bounces++) {
+        // Time until y = ground on the way down (larger root of the arc)
+        float height = sim.ballPosY - BALL_GROUND_Y;
+        float vy = sim.ballVelocityY;
+        float hitTime = remaining + 1.0f;
+        if (height >= 0.0f) {
+            hitTime = (vy + sqrtf(vy * vy + 2.0f * BALL_GRAVITY * height)) / BALL_GRAVITY;
+        }
+        if (hitTime > remaining) break;
+        
+        sim.ballPosX += sim.ballVelocityX * hitTime;
+        sim.ballPosZ += sim.ballVelocityZ * hitTime;
+        sim.ballPosY = BALL_GROUND_Y;
+        sim.ballVelocityY = -(vy - BALL_GRAVITY * hitTime) * BALL_BOUNCE;  // Bouncy!
+        remaining -= hitTime;
+        postEvent(sim, RALLY_BOUNCE);
+        
+        // Too slow to leave the ground again: the ball is dead
+        if (sim.ballVelocityY < BALL_REST_SPEED) {
+            sim.ballVelocityY = 0.0f;
+            return;
+        }
+    }
+    
+    sim.ballPosX += sim.ballVelocityX * remaining;
+    sim.ballPosY += sim.ballVelocityY * remaining - 0.5f * BALL_GRAVITY * remaining * remaining;
+    sim.ballPosZ += sim.ballVelocityZ * remaining;
+    sim.ballVelocityY -= BALL_GRAVITY * remaining;  // Gravity
+}
+
+// Update ball physics - CONTINUOUS RALLY without going out of bounds
+// dt: fixed simulation step in seconds
+void updateBall(SimulationState& sim, float dt) {
+    if (sim.isPaused) return;
+    
+    sim.animationTime += dt;
+    sim.windTime += WIND_TIME_RATE * sim.windStrength * dt;
+    
+    // Ball physics with gravity (and ground bounces)
+    float startX = sim.ballPosX;
+    moveBall(sim, dt);
+    
+    // === PLAYER MOVEMENT - Chase the ball intelligently ===
+    float follow = approachFactor(PLAYER_FOLLOW_RATE, dt);
+    
+    // Players head for where the target was mid-tick, so the lag behind a
+    // moving ball is the same at any tick rate
+    float lastTarget1X = sim.player1.targetX, lastTarget1Z = sim.player1.targetZ;
+    float lastTarget2X = sim.player2.targetX, lastTarget2Z = sim.player2.targetZ;
+    
+    // Player 1 movement (left side) - moves to intercept
+    if (sim.ballVelocityX < 0) {  // Ball coming to player 1
+        sim.player1.targetX = sim.ballPosX - 0.8f;  // Position to hit
+        sim.player1.targetZ = sim.ballPosZ;         // Track ball Z
+        
+        // Keep in left side
+        if (sim.player1.targetX > -1.0f) sim.player1.targetX = -1.0f;
+        if (sim.player1.targetX < -COURT_LENGTH/2 + 0.5f) sim.player1.targetX = -COURT_LENGTH/2 + 0.5f;
+        if (fabsf(sim.player1.targetZ) > COURT_WIDTH/2 - 0.5f) {
+            sim.player1.targetZ = (sim.player1.targetZ > 0 ? 1 : -1) * (COURT_WIDTH/2 - 0.5f);
+        }
+    } else {
+        // Return to center ready position
+        sim.player1.targetX = -COURT_LENGTH/4;
+        sim.player1.targetZ = 0;
+    }
+    
+    // Smooth movement
+    sim.player1.posX += (0.5f * (lastTarget1X + sim.player1.targetX) - sim.player1.posX) * follow;
+    sim.player1.posZ += (0.5f * (lastTarget1Z + sim.player1.targetZ) - sim.player1.posZ) * follow;
+    
+    // Player 2 movement (right side)
+    if (sim.ballVelocityX > 0) {  // Ball coming to player 2
+        sim.player2.targetX = sim.ballPosX + 0.8f;
+        sim.player2.targetZ = sim.ballPosZ;
+        
+        // Keep in right side
+        if (sim.player2.targetX < 1.0f) sim.player2.targetX = 1.0f;
+        if (sim.player2.targetX > COURT_LENGTH/2 - 0.5f) sim.player2.targetX = COURT_LENGTH/2 - 0.5f;
+        if (fabsf(sim.player2.targetZ) > COURT_WIDTH/2 - 0.5f) {
+            sim.player2.targetZ = (sim.player2.targetZ > 0 ? 1 : -1) * (COURT_WIDTH/2 - 0.5f);
+        }
+    } else {
+        sim.player2.targetX = COURT_LENGTH/4;
+        sim.player2.targetZ = 0;
+    }
+    
+    sim.player2.posX += (0.5f * (lastTarget2X + sim.player2.targetX) - sim.player2.posX) * follow;
+    sim.player2.posZ += (0.5f * (lastTarget2Z + sim.player2.targetZ) - sim.player2.posZ) * follow;
+    
+    // === PADDLE COLLISION DETECTION ===
+    
+    float paddle1X, paddle1Y, paddle1Z;
+    float paddle2X, paddle2Y, paddle2Z;
+    getPaddlePosition(sim.player1, true, paddle1X, paddle1Y, paddle1Z);
+    getPaddlePosition(sim.player2, false, paddle2X, paddle2Y, paddle2Z);
+    
+    // Player 1 paddle hit (ball going left)
+    if (sim.ballVelocityX < 0 && sim.ballPosX < -0.5f && checkPaddleHit(sim, paddle1X, paddle1Y, paddle1Z)) {
+        // HIT! Send to player 2 with proper arc
+        sim.ballPosX = paddle1X + 0.5f;
+        sim.ballTeleports++;
+        sim.ballVelocityX = 5.4f + randomInt(sim.rng, 20) * 0.06f;    // To player 2, slight variation
+        sim.ballVelocityY = 10.8f + randomInt(sim.rng, 10) * 0.3f;    // Arc over net
+        sim.ballVelocityZ = (randomInt(sim.rng, 5) - 2) * 0.6f;       // Slight side angle
+        sim.rallyCount++;
+        
+        // Swing animation
+        sim.targetArmSwing1 = 70.0f;
+        sim.player1.jumpHeight = 0.2f;
+        sim.player1.bodyTilt = -15.0f;
+        
+        recordPaddleHit(sim);
+        postEvent(sim, RALLY_HIT, 1);
+    }
+    
+    // Player 2 paddle hit (ball going right)
+    if (sim.ballVelocityX > 0 && sim.ballPosX > 0.5f && checkPaddleHit(sim, paddle2X, paddle2Y, paddle2Z)) {
+        // HIT! Send to player 1 with proper arc
+        sim.ballPosX = paddle2X - 0.5f;
+        sim.ballTeleports++;
+        sim.ballVelocityX = -5.4f - randomInt(sim.rng, 20) * 0.06f;   // To player 1
+        sim.ballVelocityY = 10.8f + randomInt(sim.rng, 10) * 0.3f;    // Arc over net
+        sim.ballVelocityZ = (randomInt(sim.rng, 5) - 2) * 0.6f;
+        sim.rallyCount++;
+        
+        sim.targetArmSwing2 = 70.0f;
+        sim.player2.jumpHeight = 0.2f;
+        sim.player2.bodyTilt = 15.0f;
+        
+        recordPaddleHit(sim);
+        postEvent(sim, RALLY_HIT, 2);
+    }
+    
+    // === COURT BOUNDARIES - Keep ball in play! ===
+    
+    // Net collision - if ball hits net, bounce it back gently. Long ticks can
+    // carry the ball straight past the net band, so crossing x = 0 counts too.
+    bool atNet = fabsf(sim.ballPosX) < 0.2f || (startX < 0.0f) != (sim.ballPosX < 0.0f);
+    if (atNet && sim.ballPosY < NET_HEIGHT && sim.ballPosY > 0) {
+        // Net hit! Bounce back
+        sim.ballVelocityX *= -0.5f;
+        sim.ballVelocityY = 7.2f;  // Pop up
+        sim.ballPosX = (sim.ballPosX > 0) ? 0.25f : -0.25f;
+        sim.ballTeleports++;
+        if (sim.stats) sim.stats->netHits++;
+        endRally(sim);
+        postEvent(sim, RALLY_NET);
+    }
+    
+    // Side boundaries - bounce off sides to keep in play
+    if (fabsf(sim.ballPosZ) > COURT_WIDTH/2 - 0.3f) {
+        float sign = (sim.ballPosZ > 0) ? 1.0f : -1.0f;
+        sim.ballPosZ = sign * (COURT_WIDTH/2 - 0.3f);
+        sim.ballVelocityZ *= -0.8f;  // Bounce inward
+    }
+    
+    // PREVENT going out! If ball goes too far, auto-return it
+    if (sim.ballPosX < -COURT_LENGTH/2) {
+        // Too far left - bounce back toward player 2
+        sim.ballPosX = -COURT_LENGTH/2 + 0.3f;
+        sim.ballTeleports++;
+        sim.ballVelocityX = fabsf(sim.ballVelocityX) * 0.8f;  // Reverse direction
+        sim.ballVelocityY = 9.0f;  // Pop up
+        if (sim.stats) sim.stats->wallBounces++;
+        endRally(sim);
+        postEvent(sim, RALLY_WALL, 1);
+    }
+    
+    if (sim.ballPosX > COURT_LENGTH/2) {
+        // Too far right - bounce back toward player 1
+        sim.ballPosX = COURT_LENGTH/2 - 0.3f;
+        sim.ballTeleports++;
+        sim.ballVelocityX = -fabsf(sim.ballVelocityX) * 0.8f;  // Reverse direction
+        sim.ballVelocityY = 9.0f;
+        if (sim.stats) sim.stats->wallBounces++;
+        endRally(sim);
+        postEvent(sim, RALLY_WALL, 2);
+    }
+    
+    // If ball goes too high or too low, or has stopped bouncing where no
+    // paddle can reach it (emergency reset)
+    if (sim.ballPosY > 6.0f || sim.ballPosY < -0.5f || ballAtRest(sim)) {
+        if (sim.stats) sim.stats->emergencyResets++;
+        endRally(sim);
+        postEvent(sim, RALLY_RESET);
+        // Gentle reset to current server
+        sim.ballPosX = (sim.currentServer == 1) ? -3.0f : 3.0f;
+        sim.ballPosY = 1.5f;
+        sim.ballPosZ = 0.0f;
+        sim.ballVelocityX = (sim.currentServer == 1) ? 4.8f : -4.8f;
+        sim.ballVelocityY = 1.8f;
+        sim.ballVelocityZ = 0.0f;
+        sim.ballTeleports++;
+        sim.currentServer = (sim.currentServer == 1) ? 2 : 1;  // Alternate
+    }
+    
+    // === SMOOTH ANIMATIONS ===
+    
+    // Arm swing decay
+    float armFollow = approachFactor(ARM_SWING_RATE, dt);
+    float armDecay = 1.0f - approachFactor(ARM_SWING_DECAY_RATE, dt);
+    sim.player1.armSwing += (sim.targetArmSwing1 - sim.player1.armSwing) * armFollow;
+    sim.player2.armSwing += (sim.targetArmSwing2 - sim.player2.armSwing) * armFollow;
+    sim.targetArmSwing1 *= armDecay;  // Decay
+    sim.targetArmSwing2 *= armDecay;
+    
+    // Walking/running animation based on movement speed
+    float moveSpeed1 = sqrt(pow(sim.player1.posX - sim.player1.targetX, 2) + 
+                            pow(sim.player1.posZ - sim.player1.targetZ, 2));
+    float moveSpeed2 = sqrt(pow(sim.player2.posX - sim.player2.targetX, 2) + 
+                            pow(sim.player2.posZ - sim.player2.targetZ, 2));
+    
+    if (moveSpeed1 > 0.08f) {
+        // Running!
+        sim.player1.legAngle1 = sin(sim.animationTime * 20.0f) * 35.0f;
+        sim.player1.legAngle2 = -sim.player1.legAngle1;
+    } else if (moveSpeed1 > 0.03f) {
+        // Walking
+        sim.player1.legAngle1 = sin(sim.animationTime * 12.0f) * 20.0f;
+        sim.player1.legAngle2 = -sim.player1.legAngle1;
+    } else {
+        // Idle stance
+        sim.player1.legAngle1 = sin(sim.animationTime * 2.0f) * 5.0f;
+        sim.player1.legAngle2 = -sim.player1.legAngle1 * 0.5f;
+    }
+    
+    if (moveSpeed2 > 0.08f) {
+        sim.player2.legAngle1 = sin(sim.animationTime * 20.0f) * 35.0f;
+        sim.player2.legAngle2 = -sim.player2.legAngle1;
+    } else if (moveSpeed2 > 0.03f) {
+        sim.player2.legAngle1 = sin(sim.animationTime * 12.0f) * 20.0f;
+        sim.player2.legAngle2 = -sim.player2.legAngle1;
+    } else {
+        sim.player2.legAngle1 = sin(sim.animationTime * 2.0f) * 5.0f;
+        sim.player2.legAngle2 = -sim.player2.legAngle1 * 0.5f;
+    }
+    
+    // Decay jump and body tilt smoothly
+    float bodyDecay = 1.0f - approachFactor(BODY_DECAY_RATE, dt);
+    sim.player1.bodyTilt *= bodyDecay;
+    sim.player1.jumpHeight *= bodyDecay;
+    sim.player2.bodyTilt *= bodyDecay;
+    sim.player2.jumpHeight *= bodyDecay;
+}
+
+// Update walker positions and animations along the running track
+// dt: fixed simulation step in seconds
+void updateWalkers(SimulationState& sim, float dt) {
+    if (sim.isPaused) return;
+    
+    // Track parameters (matching drawRunningTrack)
+    float trackOffset = 9.0f;
+    float trackWidth = 3.0f;
+    float trackMiddle = trackOffset + trackWidth / 2.0f; // Middle of track = 10.5f
+    
+    // Track dimensions
+    float trackHalfLength = COURT_LENGTH/2 + trackMiddle;
+    float trackHalfWidth = COURT_WIDTH/2 + trackMiddle;
+    
+    // Update each walker
+    bool isJogging[] = {false, false, false, false}; // All walkers walk at same pace
+    
+    for (int i = 0; i < 4; i++) {
+        WalkerState* w = &sim.walkers[i];
+        float walkSpeed = w->speed * dt;
+        
+        // Update leg and arm animations (walking/jogging motion)
+        float animSpeed = isJogging[i] ? 15.0f : 10.0f;
+        float legAngleMax = isJogging[i] ? 40.0f : 25.0f;
+        float armAngleMax = isJogging[i] ? 30.0f : 20.0f;
+        
+        w->legAngle1 = sin(sim.animationTime * animSpeed) * legAngleMax;
+        w->legAngle2 = -w->legAngle1; // Opposite leg
+        w->armSwing1 = sin(sim.animationTime * animSpeed) * armAngleMax;
+        w->armSwing2 = -w->armSwing1; // Opposite arm
+        
+        // Move walker along track
+        // Track segments: 0=bottom, 1=right, 2=top, 3=left
+        switch(w->pathSegment) {
+            case 0: // Bottom segment (moving right, +X direction)
+                w->posX += walkSpeed;
+                w->angle = 90;
+                if (w->posX >= trackHalfLength) {
+                    w->pathSegment = 1;
+                    w->posX = trackHalfLength;
+                }
+                break;
+                
+            case 1: // Right segment (moving up, +Z direction)
+                w->posZ += walkSpeed;
+                w->angle = 0;
+                if (w->posZ >= trackHalfWidth) {
+                    w->pathSegment = 2;
+                    w->posZ = trackHalfWidth;
+                }
+                break;
+                
+            case 2: // Top segment (moving left, -X direction)
+                w->posX -= walkSpeed;
+                w->angle = 270;
+                if (w->posX <= -trackHalfLength) {
+                    w->pathSegment = 3;
+                    w->posX = -trackHalfLength;
+                }
+                break;
+                
+            case 3: // Left segment (moving down, -Z direction)
+                w->posZ -= walkSpeed;
+                w->angle = 180;
+                if (w->posZ <= -trackHalfWidth) {
+                    w->pathSegment = 0;
+                    w->posZ = -trackHalfWidth;
+                }
+                break;
+        }
+    }
+    
+    // Keep the couple (walkers 1 and 2) walking side-by-side (parallel formation)
+    // Walker 1 moves freely, walker 2 follows with perpendicular offset
+    float coupleOffset = 0.5f; // Distance between the two people
+    
+    // Sync their segment and angle
+    sim.walkers[2].pathSegment = sim.walkers[1].pathSegment;
+    sim.walkers[2].angle = sim.walkers[1].angle;
+    
+    // Position walker 2 relative to walker 1 with perpendicular offset
+    switch(sim.walkers[1].pathSegment) {
+        case 0: // Bottom segment - walking along +X direction
+            sim.walkers[2].posX = sim.walkers[1].posX; // Same X (forward) position
+            sim.walkers[2].posZ = sim.walkers[1].posZ + coupleOffset; // Offset to the side
+            break;
+            
+        case 1: // Right segment - walking along +Z direction
+            sim.walkers[2].posZ = sim.walkers[1].posZ; // Same Z (forward) position
+            sim.walkers[2].posX = sim.walkers[1].posX + coupleOffset; // Offset to the side
+            break;
+            
+        case 2: // Top segment - walking along -X direction
+            sim.walkers[2].posX = sim.walkers[1].posX; // Same X (forward) position
+            sim.walkers[2].posZ = sim.walkers[1].posZ - coupleOffset; // Offset to the side (opposite)
+            break;
+            
+        case 3: // Left segment - walking along -Z direction
+            sim.walkers[2].posZ = sim.walkers[1].posZ; // Same Z (forward) position
+            sim.walkers[2].posX = sim.walkers[1].posX - coupleOffset; // Offset to the side (opposite)
+            break;
+    }
+    
+    // Update dog position to follow walker 0 (person with dog)
+    // Dog walks slightly behind and to the side
+    float dogOffsetDistance = 1.5f;
+    float angleRad = (sim.walkers[0].angle - 45) * PI / 180.0f; // 45 degrees offset
+    sim.dogPosX = sim.walkers[0].posX - cos(angleRad) * dogOffsetDistance;
+    sim.dogPosZ = sim.walkers[0].posZ - sin(angleRad) * dogOffsetDistance;
+    sim.dogAngle = sim.walkers[0].angle - 90.0f; // Correct orientation: Dog faces movement direction
+}
+
+void stepSimulationTick(SimulationState& sim, float dt) {
+    updateBall(sim, dt);
+    updateWalkers(sim, dt);  // Update people walking/jogging on track
+    sim.tick++;
+    if (sim.stats) sim.stats->ticks++;
+}
+
+// ============================================================================
+// HEADLESS RUNNER
+// ============================================================================
+
+int runHeadlessSimulation(long long ticks, float tickRate, uint64_t seed, FILE* checksumFile) {
+    SimulationStats stats;
+    SimulationState sim;
+    initSimulation(sim, seed);
+    sim.stats = &stats;
+    
+    float dt = 1.0f / tickRate;
+    
+    printf("=== Headless simulation ===\n");
+    printf("Ticks: %lld at %.0f Hz (%.1f simulated minutes), seed %llu\n",
+           ticks, tickRate, ticks / tickRate / 60.0f, (unsigned long long)seed);
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < ticks; i++) {
+        stepSimulationTick(sim, dt);
+        if (checksumFile) {
+            fprintf(checksumFile, "%lld %016llx\n", i + 1,
+                    (unsigned long long)hashSimulationState(sim));
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    // Rally length distribution (hits per rally) in power-of-two buckets
+    const int BUCKETS = 8;
+    const char* labels[BUCKETS] = {"0", "1", "2-3", "4-7", "8-15", "16-31", "32-63", "64+"};
+    int histogram[BUCKETS] = {0};
+    long long totalHits = 0;
+    int longest = 0;
+    for (size_t i = 0; i < stats.rallies.size(); i++) {
+        int hits = stats.rallies[i];
+        int bucket = 0;
+        while (bucket < BUCKETS - 1 && hits >= (1 << bucket)) bucket++;
+        histogram[bucket]++;
+        totalHits += hits;
+        if (hits > longest) longest = hits;
+    }
+    
+    printf("Paddle hits:      %d\n", stats.paddleHits);
+    printf("Net hits:         %d\n", stats.netHits);
+    printf("Back wall saves:  %d\n", stats.wallBounces);
+    printf("Emergency resets: %d\n", stats.emergencyResets);
+    printf("Rallies finished: %d (mean %.2f hits, longest %d, in progress %d)\n",
+           (int)stats.rallies.size(),
+           stats.rallies.empty() ? 0.0 : (double)totalHits / stats.rallies.size(),
+           longest, stats.currentRally);
+    printf("Rally length distribution (hits):\n");
+    for (int b = 0; b < BUCKETS; b++) {
+        double share = stats.rallies.empty() ? 0.0 : 100.0 * histogram[b] / stats.rallies.size();
+        printf("  %6s: %8d  (%5.1f%%)\n", labels[b], histogram[b], share);
+    }
+    printf("Final state hash: %016llx\n", (unsigned long long)hashSimulationState(sim));
+    printf("Wall time: %.3f s, %.0f ticks/s (%.0fx real time)\n",
+           seconds, seconds > 0 ? ticks / seconds : 0.0,
+           seconds > 0 ? ticks / tickRate / seconds : 0.0);
+    
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Simulation.h
+ * Rally simulation for the pickleball scene (no OpenGL dependency)
+ *
+ * All simulation state lives in SimulationState so it can be stepped
+ * without a window: the GLUT scene renders it, --headless runs it as
+ * fast as possible and reports rally statistics.
+ * Units are meters and seconds; every update takes the fixed step dt.
+ *
+ * Randomness comes from a PCG32 generator stored in the state, so the
+ * same seed and the same sequence of steps always produce the same
+ * state (see hashSimulationState).
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <vector>
+#include <cstdio>
+#include <stdint.h>
+#include "RallyEvents.h"
+
+// Constants
+const float PI = 3.14159265359f;
+const float COURT_LENGTH = 20.115f;  // Scaled 1.5x (was 13.41f)
+const float COURT_WIDTH = 9.15f;     // Scaled 1.5x (was 6.10f)
+const float NET_HEIGHT = 0.914f;
+
+// Physics tuning. The original per-tick constants were tuned for ~60
+// ticks/s; these are the same motion expressed per second.
+const float BALL_GRAVITY = 28.8f;        // m/s^2 (stylized, floaty rally)
+const float BALL_GROUND_Y = 0.15f;       // Ball center height when touching the court
+const float BALL_BOUNCE = 0.645f;        // Vertical speed kept by a bounce (matches the 60 Hz feel)
+const float BALL_REST_SPEED = 1.0f;      // Slower rebounds than this leave the ball dead (m/s)
+const float WIND_TIME_RATE = 1.2f;       // Wind phase per second at strength 1
+const float PLAYER_FOLLOW_RATE = 7.67f;  // Players close this fraction of the gap (1/s)
+const float ARM_SWING_RATE = 9.75f;      // Arm follows its target at this rate (1/s)
+const float ARM_SWING_DECAY_RATE = 6.32f;
+const float BODY_DECAY_RATE = 9.75f;     // Jump height and body tilt settle (1/s)
+
+// Player animation states
+struct PlayerState {
+    float legAngle1, legAngle2;
+    float armSwing;
+    float bodyTilt;
+    float jumpHeight;
+    // Movement
+    float posX, posZ;        // Current position
+    float targetX, targetZ;  // Target position (where ball will land)
+    float moveSpeed;         // Movement speed (m/s)
+};
+
+// Walker animation states (people walking/jogging on track)
+struct WalkerState {
+    float posX, posZ;        // Current position
+    float angle;             // Direction angle (0-360)
+    float speed;             // Walking/jogging speed (m/s)
+    float legAngle1, legAngle2;
+    float armSwing1, armSwing2;
+    int pathSegment;         // Which segment of track (0=bottom, 1=right, 2=top, 3=left)
+    float pathProgress;      // Progress along current segment (0-1)
+};
+
+// PCG32 random generator (O'Neill, pcg-random.org), one per simulation
+struct SimRandom {
+    uint64_t state;
+    uint64_t inc;     // Stream selector, must be odd
+};
+
+const uint64_t DEFAULT_SIMULATION_SEED = 0x5eed;
+
+void seedRandom(SimRandom& rng, uint64_t seed, uint64_t stream = 54);
+
+// Next 32 random bits
+uint32_t nextRandom(SimRandom& rng);
+
+// Uniform integer in [0, bound) without modulo bias
+int randomInt(SimRandom& rng, int bound);
+
+// Rally events collected while simulating (optional)
+struct SimulationStats {
+    long long ticks;
+    int paddleHits;
+    int netHits;
+    int wallBounces;
+    int emergencyResets;
+    int currentRally;            // Hits in the rally in progress
+    std::vector<int> rallies;    // Hits per finished rally
+
+    SimulationStats() : ticks(0), paddleHits(0), netHits(0), wallBounces(0),
+                        emergencyResets(0), currentRally(0) {}
+};
+
+struct SimulationState {
+    // Ball state for rally simulation - continuous rally
+    float ballPosX, ballPosY, ballPosZ;
+    float ballVelocityX, ballVelocityY, ballVelocityZ;
+    int ballTeleports;  // Bumped when the ball is moved in a jump (reset, saves, snaps)
+    bool isPaused;
+
+    // Rally control
+    int rallyCount;
+    int currentServer;  // 1 or 2
+
+    // Smooth interpolation for animations
+    float targetArmSwing1;
+    float targetArmSwing2;
+
+    PlayerState player1;
+    PlayerState player2;
+
+    // 4 walkers on the running track:
+    // 0 = person with dog, 1 + 2 = walking couple, 3 = solo walker
+    WalkerState walkers[4];
+
+    // Dog follows walkers[0]
+    float dogPosX, dogPosZ;
+    float dogAngle;
+
+    // Animation clocks
+    float windTime;
+    float windStrength;
+    float animationTime;
+
+    SimRandom rng;              // Shot variation
+    long long tick;             // Steps taken since initSimulation
+
+    RallyEventQueue* events;    // Rally events for logging/subscribers, NULL = not posted
+    SimulationStats* stats;     // Event counters, NULL = not collected
+};
+
+/**
+ * Reset to the opening serve (ball with player 1, walkers at their start)
+ * @param seed: Seed for the shot variation generator
+ */
+void initSimulation(SimulationState& sim, uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+/**
+ * Advance ball, players and rally by one fixed step
+ * @param dt: Step length in seconds
+ */
+void updateBall(SimulationState& sim, float dt);
+
+/**
+ * Advance walkers along the running track and the dog following walker 1
+ * @param dt: Step length in seconds
+ */
+void updateWalkers(SimulationState& sim, float dt);
+
+// One full simulation tick (ball + walkers)
+void stepSimulationTick(SimulationState& sim, float dt);
+
+// Calculate paddle position in world space
+void getPaddlePosition(const PlayerState& state, bool isPlayer1, float& paddleX, float& paddleY, float& paddleZ);
+
+// Check if ball hits paddle
+bool checkPaddleHit(const SimulationState& sim, float paddleX, float paddleY, float paddleZ);
+
+// Number of 32-bit words written by packSimulationState
+const int SIM_STATE_WORDS = 83;
+
+/**
+ * Copy every simulated value into a flat word array (floats as their
+ * bit patterns). Used for state hashes and replay keyframes.
+ * Output-only fields (events, stats, ballTeleports) are not included.
+ * @param words: Output, SIM_STATE_WORDS entries
+ */
+void packSimulationState(const SimulationState& sim, uint32_t* words);
+
+// Inverse of packSimulationState (events and stats are left untouched)
+void unpackSimulationState(const uint32_t* words, SimulationState& sim);
+
+/**
+ * 64-bit FNV-1a hash over the packed state. Two runs are identical as
+ * long as their hashes match tick for tick.
+ */
+uint64_t hashSimulationState(const SimulationState& sim);
+
+// Frame-rate independent blend factor for an exponential approach
+float approachFactor(float ratePerSecond, float dt);
+
+/**
+ * Run the simulation with no window and print rally statistics
+ * @param ticks: Number of fixed steps to run
+ * @param tickRate: Steps per simulated second
+ * @param seed: Random seed (same seed = same rally, tick for tick)
+ * @param checksumFile: If not NULL, "tick hash" is written after every step
+ * @return Process exit code
+ */
+int runHeadlessSimulation(long long ticks, float tickRate,
+                          uint64_t seed = DEFAULT_SIMULATION_SEED, FILE* checksumFile = NULL);
+
+#endif // SIMULATION_H
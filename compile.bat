@@ -4,7 +4,7 @@ echo Compiling Pickleball Scene...
 echo ====================================
 
 REM Compile with g++ via MSYS2 MinGW
-C:\msys64\msys2_shell.cmd -mingw64 -defterm -no-start -here -c "g++ pickleball_scene.cpp -o pickleball_scene.exe -lfreeglut -lopengl32 -lglu32"
+C:\msys64\msys2_shell.cmd -mingw64 -defterm -no-start -here -c "g++ pickleball_scene.cpp Simulation.cpp ReplayLog.cpp FrameCapture.cpp RallyEventLog.cpp -o pickleball_scene.exe -lfreeglut -lopengl32 -lglu32 -lwinmm"
 
 if %ERRORLEVEL% EQU 0 (
     echo.
@@ -5,7 +5,7 @@ echo ====================================
 echo.
 
 REM Compile with Assimp library
-C:\msys64\msys2_shell.cmd -mingw64 -defterm -no-start -here -c "g++ pickleball_scene.cpp ModelLoader.cpp -o pickleball_scene.exe -lfreeglut -lopengl32 -lglu32 -lassimp -std=c++11 -Wall"
+C:\msys64\msys2_shell.cmd -mingw64 -defterm -no-start -here -c "g++ pickleball_scene.cpp Simulation.cpp ReplayLog.cpp FrameCapture.cpp RallyEventLog.cpp ModelLoader.cpp -o pickleball_scene.exe -lfreeglut -lopengl32 -lglu32 -lwinmm -lassimp -std=c++11 -Wall"
 
 if %ERRORLEVEL% EQU 0 (
     echo.
@@ -0,0 +1,301 @@
+/*
+ * GpuProfiler.h
+ * Per-pass GPU and CPU timing with a Chrome trace export
+ *
+ * Scopes (shadow map, skybox, opaque, ...) record the CPU time they take
+ * to submit and bracket their GL commands with GL_TIMESTAMP queries, so
+ * scopes can nest. Query results are read GPU_PROFILER_LATENCY frames
+ * later, once they are available - the profiler never waits for the GPU.
+ * If a frame's queries are still not back when its slot is needed again,
+ * that frame is kept with CPU times only and counted as dropped.
+ *
+ * Finished frames (CPU and GPU times on one timeline) are kept for the
+ * last GPU_PROFILER_HISTORY frames; writeChromeTrace() saves them in the
+ * Trace Event format (chrome://tracing, Perfetto), CPU and GPU as two
+ * threads.
+ */
+
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+const int GPU_PROFILER_LATENCY = 3;          // Frames of queries in flight
+const int GPU_PROFILER_MAX_SCOPES = 32;      // Per frame; more are ignored
+const int GPU_PROFILER_HISTORY = 600;        // Finished frames kept for export
+const int GPU_PROFILER_RESYNC_FRAMES = 300;  // Re-align GPU and CPU clocks this often
+
+struct GpuProfileScope {
+    const char* name;       // Not copied: use string literals
+    int depth;              // Nesting level, 0 = top
+    double cpuStartMs;      // Since the profiler started
+    double cpuMs;
+    double gpuStartMs;      // On the CPU timeline; -1 = not measured
+    double gpuMs;
+};
+
+struct GpuProfileFrame {
+    long long index;
+    double cpuStartMs;
+    double cpuMs;
+    double gpuMs;           // First scope start to last scope end, -1 = not measured
+    std::vector<GpuProfileScope> scopes;
+};
+
+// ============================================================================
+// GPU PROFILER
+// ============================================================================
+
+class GpuProfiler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Opens a scope for its lifetime
+    class Scope {
+    public:
+        Scope(GpuProfiler& profiler, const char* name) : owner(profiler) { owner.beginScope(name); }
+        ~Scope() { owner.endScope(); }
+    private:
+        GpuProfiler& owner;
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+    };
+
+    GpuProfiler() : enabled(false), queriesCreated(false), frameOpen(false), writeSlot(0),
+                    frameIndex(0), droppedFrames(0), clockOffsetMs(0.0), clockSyncFrame(-1),
+                    start(Clock::now()) {}
+
+    // Needs the GL context that made the queries
+    ~GpuProfiler() {
+        if (queriesCreated) {
+            for (int i = 0; i < GPU_PROFILER_LATENCY; i++) {
+                glDeleteQueries(GPU_PROFILER_MAX_SCOPES * 2, slots[i].queries);
+            }
+        }
+    }
+
+    // Off by default; when off, scopes cost nothing but a branch
+    void setEnabled(bool on) {
+        if (on == enabled) return;
+        if (!on && frameOpen) endFrame();
+        enabled = on;
+        if (on && !queriesCreated) {
+            for (int i = 0; i < GPU_PROFILER_LATENCY; i++) {
+                glGenQueries(GPU_PROFILER_MAX_SCOPES * 2, slots[i].queries);
+            }
+            queriesCreated = true;
+        }
+    }
+    bool isEnabled() const { return enabled; }
+
+    // Start a frame (a scope outside a frame starts one too)
+    void beginFrame() {
+        if (!enabled) return;
+        if (frameOpen) endFrame();
+        collect();
+
+        Slot& slot = slots[writeSlot];
+        if (slot.pending) {
+            // Still not back after GPU_PROFILER_LATENCY frames: keep the CPU side
+            droppedFrames++;
+            finish(slot, false);
+        }
+        if (clockSyncFrame < 0 || frameIndex - clockSyncFrame >= GPU_PROFILER_RESYNC_FRAMES) syncClocks();
+
+        slot.frame.index = frameIndex++;
+        slot.frame.cpuStartMs = nowMs();
+        slot.frame.cpuMs = 0.0;
+        slot.frame.gpuMs = -1.0;
+        slot.frame.scopes.clear();
+        slot.lastQuery = -1;
+        open.clear();
+        frameOpen = true;
+    }
+
+    // End the frame; its GPU times arrive a few frames later
+    void endFrame() {
+        if (!enabled || !frameOpen) return;
+        while (!open.empty()) endScope();
+        Slot& slot = slots[writeSlot];
+        slot.frame.cpuMs = nowMs() - slot.frame.cpuStartMs;
+        slot.pending = true;
+        writeSlot = (writeSlot + 1) % GPU_PROFILER_LATENCY;
+        frameOpen = false;
+        collect();
+    }
+
+    void beginScope(const char* name) {
+        if (!enabled) return;
+        if (!frameOpen) beginFrame();
+        Slot& slot = slots[writeSlot];
+        int index = (int)slot.frame.scopes.size();
+        if (index >= GPU_PROFILER_MAX_SCOPES) {
+            open.push_back(-1);
+            return;
+        }
+        GpuProfileScope scope;
+        scope.name = name;
+        scope.depth = (int)open.size();
+        scope.cpuStartMs = nowMs();
+        scope.cpuMs = 0.0;
+        scope.gpuStartMs = -1.0;
+        scope.gpuMs = -1.0;
+        slot.frame.scopes.push_back(scope);
+        glQueryCounter(slot.queries[index * 2], GL_TIMESTAMP);
+        slot.lastQuery = index * 2;
+        open.push_back(index);
+    }
+
+    void endScope() {
+        if (!enabled || open.empty()) return;
+        int index = open.back();
+        open.pop_back();
+        if (index < 0) return;
+        Slot& slot = slots[writeSlot];
+        glQueryCounter(slot.queries[index * 2 + 1], GL_TIMESTAMP);
+        slot.lastQuery = index * 2 + 1;
+        GpuProfileScope& scope = slot.frame.scopes[index];
+        scope.cpuMs = nowMs() - scope.cpuStartMs;
+    }
+
+    // Finished frames, oldest first
+    const std::deque<GpuProfileFrame>& frames() const { return history; }
+    const GpuProfileFrame* latest() const { return history.empty() ? NULL : &history.back(); }
+    long long droppedFrameCount() const { return droppedFrames; }
+
+    // Latest frame on one line, e.g. "frame 41: shadow map 1.20/0.31 ms, opaque 3.02/0.40 ms (GPU/CPU)"
+    void describe(char* text, size_t size) const {
+        const GpuProfileFrame* frame = latest();
+        if (!frame) {
+            snprintf(text, size, "no frames");
+            return;
+        }
+        int written = snprintf(text, size, "frame %lld:", frame->index);
+        for (size_t i = 0; i < frame->scopes.size() && written >= 0 && (size_t)written < size; i++) {
+            const GpuProfileScope& s = frame->scopes[i];
+            if (s.depth > 0) continue;
+            written += snprintf(text + written, size - written, "%s %s %.2f/%.2f ms", i ? "," : "",
+                                s.name, s.gpuMs, s.cpuMs);
+        }
+        if (written >= 0 && (size_t)written < size) snprintf(text + written, size - written, " (GPU/CPU)");
+    }
+
+    /**
+     * Save the kept frames in the Chrome Trace Event format
+     * @return false if the file cannot be written
+     */
+    bool writeChromeTrace(const char* path) const {
+        FILE* file = fopen(path, "w");
+        if (!file) return false;
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+        for (size_t f = 0; f < history.size(); f++) {
+            const GpuProfileFrame& frame = history[f];
+            fprintf(file, ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                          "\"args\":{\"frame\":%lld,\"gpuMs\":%.3f}}",
+                    frame.cpuStartMs * 1000.0, frame.cpuMs * 1000.0, frame.index, frame.gpuMs);
+            for (size_t i = 0; i < frame.scopes.size(); i++) {
+                const GpuProfileScope& s = frame.scopes[i];
+                fprintf(file, ",\n{\"name\":\"");
+                writeJsonString(file, s.name);
+                fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%lld}}",
+                        s.cpuStartMs * 1000.0, s.cpuMs * 1000.0, frame.index);
+                if (s.gpuMs < 0.0) continue;
+                fprintf(file, ",\n{\"name\":\"");
+                writeJsonString(file, s.name);
+                fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%lld}}",
+                        s.gpuStartMs * 1000.0, s.gpuMs * 1000.0, frame.index);
+            }
+        }
+        fprintf(file, "\n]}\n");
+        return fclose(file) == 0;
+    }
+
+private:
+    struct Slot {
+        GLuint queries[GPU_PROFILER_MAX_SCOPES * 2];   // Begin/end timestamp per scope
+        bool pending;                                  // Ended, results not read yet
+        int lastQuery;                                 // Last timestamp issued (index into queries), -1 = none
+        GpuProfileFrame frame;
+        Slot() : pending(false), lastQuery(-1) {}
+    };
+
+    bool enabled;
+    bool queriesCreated;
+    bool frameOpen;
+    Slot slots[GPU_PROFILER_LATENCY];
+    int writeSlot;
+    std::vector<int> open;             // Scope indices, -1 = over the limit
+    long long frameIndex;
+    long long droppedFrames;
+    double clockOffsetMs;              // CPU ms = GPU ms + offset
+    long long clockSyncFrame;
+    Clock::time_point start;
+    std::deque<GpuProfileFrame> history;
+
+    double nowMs() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Reads the GPU clock directly; cheap, but not free, so only now and then
+    void syncClocks() {
+        GLint64 gpuNs = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNs);
+        clockOffsetMs = nowMs() - gpuNs / 1.0e6;
+        clockSyncFrame = frameIndex;
+    }
+
+    // Read back the pending frames whose results are in, oldest first
+    void collect() {
+        for (int n = 0; n < GPU_PROFILER_LATENCY; n++) {
+            Slot& slot = slots[(writeSlot + n) % GPU_PROFILER_LATENCY];
+            if (!slot.pending) continue;
+            if (slot.lastQuery >= 0) {
+                // Queries complete in order, so the last one issued stands for
+                // all (with nesting that is an outer scope's end, not the last scope's)
+                GLint available = 0;
+                glGetQueryObjectiv(slot.queries[slot.lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) return;
+            }
+            finish(slot, true);
+        }
+    }
+
+    void finish(Slot& slot, bool withGpu) {
+        GpuProfileFrame& frame = slot.frame;
+        if (withGpu && !frame.scopes.empty()) {
+            double first = 0.0, last = 0.0;
+            for (size_t i = 0; i < frame.scopes.size(); i++) {
+                GLuint64 begin = 0, end = 0;
+                glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+                GpuProfileScope& s = frame.scopes[i];
+                s.gpuStartMs = begin / 1.0e6 + clockOffsetMs;
+                s.gpuMs = (end - begin) / 1.0e6;
+                if (i == 0 || s.gpuStartMs < first) first = s.gpuStartMs;
+                if (i == 0 || s.gpuStartMs + s.gpuMs > last) last = s.gpuStartMs + s.gpuMs;
+            }
+            frame.gpuMs = last - first;
+        }
+        slot.pending = false;
+        history.push_back(frame);
+        if ((int)history.size() > GPU_PROFILER_HISTORY) history.pop_front();
+    }
+
+    static void writeJsonString(FILE* file, const char* text) {
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') fputc('\\', file);
+            if ((unsigned char)*c >= 0x20) fputc(*c, file);
+        }
+    }
+
+    GpuProfiler(const GpuProfiler&);
+    GpuProfiler& operator=(const GpuProfiler&);
+};
+
+#endif // GPU_PROFILER_H
@@ -5,8 +5,70 @@
 
 #include "ModernRenderer.h"
 #include <stb_image.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
+// Camera clip planes
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 100.0f;
+
+// Cascade splits: blend of logarithmic (1) and uniform (0) spacing
+const float SHADOW_SPLIT_LAMBDA = 0.75f;
+// Light-side room for casters in front of a cascade (closer ones are
+// clamped to the near plane, see beginShadowPass)
+const float SHADOW_CASTER_MARGIN = 10.0f;
+// Depth band at the far end of a cascade that blends into the next one
+const float SHADOW_BLEND_BAND = 0.1f;
+// Cascade boxes are this much larger than their slice, so small camera
+// moves keep the box (and the cached static casters) where they are
+const float SHADOW_CASCADE_SLACK = 0.2f;
+// PCSS: light size in light-space units per unit of blocker distance
+// (larger = softer far from the contact point)
+const float SHADOW_PCSS_LIGHT_SIZE = 0.04f;
+// Light direction change that refits the cascades (cos of ~0.5 degrees);
+// smaller changes keep the cached static casters
+const float SHADOW_LIGHT_REFIT_COS = 0.99996f;
+
+// FNV-1a over raw bytes, continuing from hash
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Normal matrix without a general inverse
+ * Rotation with uniform scale (the common case) uses mat3(model) as is.
+ * Otherwise the cofactor matrix - three cross products, no division - is
+ * transpose(inverse(m)) scaled by det(m); the shader renormalizes, so only
+ * the sign of det matters.
+ */
+static glm::mat3 normalMatrixFor(const glm::mat4& model) {
+    glm::vec3 c0(model[0].x, model[0].y, model[0].z);
+    glm::vec3 c1(model[1].x, model[1].y, model[1].z);
+    glm::vec3 c2(model[2].x, model[2].y, model[2].z);
+    float scale = glm::dot(c0, c0);
+    float tolerance = 1e-4f * scale;
+    if (fabsf(glm::dot(c1, c1) - scale) <= tolerance && fabsf(glm::dot(c2, c2) - scale) <= tolerance &&
+        fabsf(glm::dot(c0, c1)) <= tolerance && fabsf(glm::dot(c0, c2)) <= tolerance &&
+        fabsf(glm::dot(c1, c2)) <= tolerance) {
+        return glm::mat3(c0, c1, c2);
+    }
+    glm::vec3 x = glm::cross(c1, c2), y = glm::cross(c2, c0), z = glm::cross(c0, c1);
+    if (glm::dot(c0, x) < 0.0f) {    // Mirrored: keep normals pointing out
+        x = -x;
+        y = -y;
+        z = -z;
+    }
+    return glm::mat3(x, y, z);
+}
+
 // ============================================
 // Camera Implementation
 // ============================================
@@ -64,6 +126,39 @@ void Camera::processMouseScroll(float yoffset) {
 // Mesh Implementation
 // ============================================
 
+// Packed vertex, 24 bytes (was 14 floats = 56)
+struct PackedVertex {
+    float position[3];
+    uint32_t normal;        // GL_INT_2_10_10_10_REV, normalized
+    uint32_t tangent;       // Same, w = bitangent sign (only its sign is reliable)
+    uint16_t texCoord[2];   // Half floats
+};
+static_assert(sizeof(PackedVertex) == 24, "PackedVertex must stay tightly packed");
+
+// Signed normalized 10:10:10:2, x in the low bits
+static uint32_t packSnorm1010102(const glm::vec3& v, float w) {
+    int x = (int)floorf(glm::clamp(v.x, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int y = (int)floorf(glm::clamp(v.y, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int z = (int)floorf(glm::clamp(v.z, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int iw = w < 0.0f ? -1 : 1;
+    return ((uint32_t)x & 0x3FF) | (((uint32_t)y & 0x3FF) << 10) |
+           (((uint32_t)z & 0x3FF) << 20) | (((uint32_t)iw & 0x3) << 30);
+}
+
+// IEEE half, round to nearest; tiny values flush to zero, huge ones to infinity
+static uint16_t toHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (exponent <= 0) return sign;
+    if (exponent >= 31) return (uint16_t)(sign | 0x7C00);
+    uint16_t half = (uint16_t)(sign | (exponent << 10) | (mantissa >> 13));
+    if (mantissa & 0x1000) half++;    // Carries into the exponent correctly
+    return half;
+}
+
 void Mesh::setupMesh() {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -71,54 +166,64 @@ void Mesh::setupMesh() {
     
     glBindVertexArray(VAO);
     
-    // Create interleaved vertex data
-    std::vector<float> vertices;
-    for (size_t i = 0; i < positions.size(); i++) {
-        // Position
-        vertices.push_back(positions[i].x);
-        vertices.push_back(positions[i].y);
-        vertices.push_back(positions[i].z);
-        // Normal
-        vertices.push_back(normals[i].x);
-        vertices.push_back(normals[i].y);
-        vertices.push_back(normals[i].z);
-        // TexCoords
-        vertices.push_back(texCoords[i].x);
-        vertices.push_back(texCoords[i].y);
-        // Tangent
-        vertices.push_back(tangents[i].x);
-        vertices.push_back(tangents[i].y);
-        vertices.push_back(tangents[i].z);
-        // Bitangent
-        vertices.push_back(bitangents[i].x);
-        vertices.push_back(bitangents[i].y);
-        vertices.push_back(bitangents[i].z);
-    }
-    
+    // Pack the vertices straight into the mapped buffer
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+    GLsizeiptr size = (GLsizeiptr)(positions.size() * sizeof(PackedVertex));
+    glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
+    PackedVertex* vertices = size ? (PackedVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) : NULL;
+    if (vertices) {
+        for (size_t i = 0; i < positions.size(); i++) {
+            PackedVertex& v = vertices[i];
+            v.position[0] = positions[i].x;
+            v.position[1] = positions[i].y;
+            v.position[2] = positions[i].z;
+            glm::vec3 normal = i < normals.size() ? normals[i] : glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::vec3 tangent = i < tangents.size() ? tangents[i] : glm::vec3(1.0f, 0.0f, 0.0f);
+            // Handedness of the tangent frame; the shader rebuilds the bitangent from it
+            float sign = i < bitangents.size() && glm::dot(glm::cross(normal, tangent), bitangents[i]) < 0.0f ? -1.0f : 1.0f;
+            v.normal = packSnorm1010102(normal, 1.0f);
+            v.tangent = packSnorm1010102(tangent, sign);
+            glm::vec2 uv = i < texCoords.size() ? texCoords[i] : glm::vec2(0.0f);
+            v.texCoord[0] = toHalf(uv.x);
+            v.texCoord[1] = toHalf(uv.y);
+        }
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.empty() ? NULL : &indices[0], GL_STATIC_DRAW);
     
     // Vertex attributes
+    GLsizei stride = sizeof(PackedVertex);
     // Position
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
     // Normal
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
     // TexCoords
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(6 * sizeof(float)));
-    // Tangent
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoord));
+    // Tangent + bitangent sign
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(8 * sizeof(float)));
-    // Bitangent
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
+    glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, tangent));
     
     glBindVertexArray(0);
+    
+    // Bounding sphere around the box of the positions (for shadow culling)
+    if (!positions.empty()) {
+        glm::vec3 lo = positions[0], hi = positions[0];
+        for (size_t i = 1; i < positions.size(); i++) {
+            lo = glm::min(lo, positions[i]);
+            hi = glm::max(hi, positions[i]);
+        }
+        boundsCenter = (lo + hi) * 0.5f;
+        boundsRadius = 0.0f;
+        for (size_t i = 0; i < positions.size(); i++) {
+            boundsRadius = std::max(boundsRadius, glm::length(positions[i] - boundsCenter));
+        }
+    }
 }
 
 void Mesh::draw() {
@@ -133,7 +238,11 @@ void Mesh::draw() {
 
 ModernRenderer::ModernRenderer(int width, int height) : 
     screenWidth(width), screenHeight(height),
-    depthMapFBO(0), depthMap(0), shadowWidth(2048), shadowHeight(2048),
+    frameUBO(0), lightUBO(0), instanceVBO(0), instanceCapacity(0), instanceOffset(0),
+    profiledSubmit(false),
+    depthMapFBO(0), depthMap(0), staticMapFBO(0), staticDepthMap(0),
+    shadowCompareSampler(0), shadowDepthSampler(0), shadowFilter(SHADOW_FILTER_POISSON),
+    shadowWidth(1024), shadowHeight(1024), shadowDistance(60.0f), shadowLightDir(0.0f), staticCasterHash(0),
     skyboxVAO(0), skyboxVBO(0), cubemapTexture(0),
     fogColor(0.7f, 0.8f, 0.9f), fogDensity(0.02f), fogGradient(1.5f),
     camera(nullptr)
@@ -143,9 +252,16 @@ ModernRenderer::ModernRenderer(int width, int height) :
 ModernRenderer::~ModernRenderer() {
     if (depthMapFBO) glDeleteFramebuffers(1, &depthMapFBO);
     if (depthMap) glDeleteTextures(1, &depthMap);
+    if (staticMapFBO) glDeleteFramebuffers(1, &staticMapFBO);
+    if (staticDepthMap) glDeleteTextures(1, &staticDepthMap);
+    if (shadowCompareSampler) glDeleteSamplers(1, &shadowCompareSampler);
+    if (shadowDepthSampler) glDeleteSamplers(1, &shadowDepthSampler);
     if (skyboxVAO) glDeleteVertexArrays(1, &skyboxVAO);
     if (skyboxVBO) glDeleteBuffers(1, &skyboxVBO);
     if (cubemapTexture) glDeleteTextures(1, &cubemapTexture);
+    if (frameUBO) glDeleteBuffers(1, &frameUBO);
+    if (lightUBO) glDeleteBuffers(1, &lightUBO);
+    if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
 }
 
 bool ModernRenderer::initialize() {
@@ -163,15 +279,19 @@ bool ModernRenderer::initialize() {
     glFrontFace(GL_CCW);
     
     // Load shaders
-    blinnPhongShader.compile("modern_renderer/shaders/blinn_phong.vert", 
-                             "modern_renderer/shaders/blinn_phong.frag");
+    compileLitShaders();
     shadowMapShader.compile("modern_renderer/shaders/shadow_map.vert",
                             "modern_renderer/shaders/shadow_map.frag");
+    shadowMapInstancedShader.compile("modern_renderer/shaders/shadow_map.vert",
+                                     "modern_renderer/shaders/shadow_map.frag", "#define INSTANCED\n");
     skyboxShader.compile("modern_renderer/shaders/skybox.vert",
                         "modern_renderer/shaders/skybox.frag");
+    resolveUniforms();
+    setupUniformBuffers();
+    setupInstanceBuffer();
     
     // Setup shadow map
-    setupShadowMap(2048);
+    setupShadowMap(1024);
     
     // Create default camera if none exists
     if (!camera) {
@@ -181,63 +301,298 @@ bool ModernRenderer::initialize() {
     return true;
 }
 
+// Blinn-Phong variants, built with the current shadow filter
+void ModernRenderer::compileLitShaders() {
+    char defines[64];
+    snprintf(defines, sizeof(defines), "#define SHADOW_FILTER %d\n", (int)shadowFilter);
+    std::string instanced = std::string("#define INSTANCED\n") + defines;
+    blinnPhongShader.compile("modern_renderer/shaders/blinn_phong.vert",
+                             "modern_renderer/shaders/blinn_phong.frag", defines);
+    blinnPhongInstancedShader.compile("modern_renderer/shaders/blinn_phong.vert",
+                                      "modern_renderer/shaders/blinn_phong.frag", instanced.c_str());
+    
+    const Shader* shaders[] = { &blinnPhongShader, &blinnPhongInstancedShader };
+    for (const Shader* shader : shaders) {
+        shader->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+        shader->bindUniformBlock("LightData", LIGHT_UNIFORM_BINDING);
+    }
+}
+
+void ModernRenderer::setShadowFilter(ShadowFilter filter) {
+    if (filter == shadowFilter) return;
+    shadowFilter = filter;
+    if (!blinnPhongShader.ID) return;    // Not initialized yet
+    compileLitShaders();
+    resolveUniforms();
+}
+
+void ModernRenderer::resolveUniforms() {
+    phong.model = blinnPhongShader.uniform<glm::mat4>("model");
+    phong.normalMatrix = blinnPhongShader.uniform<glm::mat3>("normalMatrix");
+    const Shader* phongShaders[] = { &blinnPhongShader, &blinnPhongInstancedShader };
+    MaterialUniforms* materialUniforms[] = { &phong.material, &phongInstanced };
+    for (int i = 0; i < 2; i++) {
+        const Shader& s = *phongShaders[i];
+        materialUniforms[i]->shininess = s.uniform<float>("material.shininess");
+        materialUniforms[i]->hasNormalMap = s.uniform<bool>("material.hasNormalMap");
+        
+        // Texture units never change, so samplers are set once here
+        s.use();
+        s.setInt("material.diffuseMap", 0);
+        s.setInt("material.specularMap", 1);
+        s.setInt("material.normalMap", 2);
+        s.setInt("shadowMap", 3);
+        if (shadowFilter == SHADOW_FILTER_PCSS) s.setInt("shadowDepth", 4);
+    }
+    shadowUniforms.model = shadowMapShader.uniform<glm::mat4>("model");
+    shadowUniforms.cascade = shadowMapShader.uniform<int>("cascade");
+    shadowInstancedCascade = shadowMapInstancedShader.uniform<int>("cascade");
+    
+    skyboxShader.use();
+    skyboxShader.setInt("skybox", 0);
+    glUseProgram(0);
+}
+
+void ModernRenderer::setupUniformBuffers() {
+    glGenBuffers(1, &frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), NULL, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &lightUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightUniformData), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameUBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_UNIFORM_BINDING, lightUBO);
+    
+    const Shader* shaders[] = { &blinnPhongShader, &blinnPhongInstancedShader, &shadowMapShader,
+                                &shadowMapInstancedShader, &skyboxShader };
+    for (const Shader* shader : shaders) {
+        shader->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+        shader->bindUniformBlock("LightData", LIGHT_UNIFORM_BINDING);
+    }
+}
+
+void ModernRenderer::updateFrameUniforms() {
+    FrameUniformData frame;
+    frame.view = camera->getViewMatrix();
+    frame.projection = glm::perspective(glm::radians(camera->fov),
+        (float)screenWidth / (float)screenHeight, CAMERA_NEAR, CAMERA_FAR);
+    frame.viewProjection = frame.projection * frame.view;
+    frame.viewPos = glm::vec4(camera->position, 1.0f);
+    frame.fogColor = glm::vec4(fogColor, fogDensity);
+    frame.fogParams = glm::vec4(fogGradient, 0.0f, 0.0f, 0.0f);
+    
+    LightUniformData light;
+    updateShadowCascades(light);
+    light.direction = glm::vec4(dirLight.direction, 0.0f);
+    light.ambient = glm::vec4(dirLight.ambient, 1.0f);
+    light.diffuse = glm::vec4(dirLight.diffuse, 1.0f);
+    light.specular = glm::vec4(dirLight.specular, 1.0f);
+    
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame), &frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(light), &light);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Depth texture array with one layer per cascade
+GLuint ModernRenderer::createDepthArray(unsigned int width, unsigned int height) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, width, height, SHADOW_CASCADES,
+                 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
 void ModernRenderer::setupShadowMap(unsigned int resolution) {
     shadowWidth = shadowHeight = resolution;
+    if (depthMapFBO) glDeleteFramebuffers(1, &depthMapFBO);
+    if (depthMap) glDeleteTextures(1, &depthMap);
+    if (staticMapFBO) glDeleteFramebuffers(1, &staticMapFBO);
+    if (staticDepthMap) glDeleteTextures(1, &staticDepthMap);
     
-    // Create framebuffer
-    glGenFramebuffers(1, &depthMapFBO);
-    
-    // Create depth texture
-    glGenTextures(1, &depthMap);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, shadowWidth, shadowHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    // Shadow map the scene samples, and the cached static casters it
+    // starts from each frame
+    depthMap = createDepthArray(shadowWidth, shadowHeight);
+    staticDepthMap = createDepthArray(shadowWidth, shadowHeight);
     
-    // Attach depth texture as FBO's depth buffer
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
+    // Depth only; the layer is attached per cascade (beginShadowCascade)
+    GLuint* framebuffers[] = { &depthMapFBO, &staticMapFBO };
+    GLuint textures[] = { depthMap, staticDepthMap };
+    for (int i = 0; i < 2; i++) {
+        glGenFramebuffers(1, framebuffers[i]);
+        glBindFramebuffer(GL_FRAMEBUFFER, *framebuffers[i]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textures[i], 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    // The lit shaders read depthMap twice: through a comparison sampler
+    // (each fetch is a filtered 2x2 PCF) and as raw depths for PCSS
+    if (!shadowCompareSampler) {
+        GLuint samplers[2];
+        glGenSamplers(2, samplers);
+        shadowCompareSampler = samplers[0];
+        shadowDepthSampler = samplers[1];
+        float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (int i = 0; i < 2; i++) {
+            GLint filter = i == 0 ? GL_LINEAR : GL_NEAREST;
+            glSamplerParameteri(samplers[i], GL_TEXTURE_MIN_FILTER, filter);
+            glSamplerParameteri(samplers[i], GL_TEXTURE_MAG_FILTER, filter);
+            glSamplerParameteri(samplers[i], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+            glSamplerParameteri(samplers[i], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+            glSamplerParameterfv(samplers[i], GL_TEXTURE_BORDER_COLOR, borderColor);
+        }
+        glSamplerParameteri(shadowCompareSampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glSamplerParameteri(shadowCompareSampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindSampler(3, shadowCompareSampler);
+        glBindSampler(4, shadowDepthSampler);
+    }
+    
+    // Texel snapping depends on the resolution
+    for (int c = 0; c < SHADOW_CASCADES; c++) cascades[c].fitted = false;
 }
 
-void ModernRenderer::renderShadowMap(const std::vector<Mesh*>& meshes) {
-    // Calculate light space matrix
-    float near_plane = 1.0f, far_plane = 50.0f;
-    float orthoSize = 20.0f;
-    glm::mat4 lightProjection = glm::ortho(-orthoSize, orthoSize, -orthoSize, orthoSize, near_plane, far_plane);
-    glm::mat4 lightView = glm::lookAt(
-        -dirLight.direction * 20.0f,  // Light position
-        glm::vec3(0.0f),              // Look at origin
-        glm::vec3(0.0f, 1.0f, 0.0f)   // Up vector
-    );
-    lightSpaceMatrix = lightProjection * lightView;
-    
-    // Render to shadow map
-    shadowMapShader.use();
-    shadowMapShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+void ModernRenderer::invalidateStaticShadows() {
+    for (int c = 0; c < SHADOW_CASCADES; c++) cascades[c].staticValid = false;
+}
+
+/**
+ * Split the camera frustum (up to shadowDistance) into SHADOW_CASCADES
+ * slices and fit a light-space ortho box around each
+ * - Splits mix logarithmic and uniform spacing (SHADOW_SPLIT_LAMBDA)
+ * - Each box encloses the bounding sphere of its slice, whose size does not
+ *   change when the camera turns, and is moved in whole shadow texels, so
+ *   shadow edges do not crawl or shimmer as the camera moves
+ * - Boxes have SHADOW_CASCADE_SLACK room and are only refitted once the
+ *   slice leaves them or the light turns by more than SHADOW_LIGHT_REFIT_COS;
+ *   a refit invalidates the cascade's cached static casters
+ */
+void ModernRenderer::updateShadowCascades(LightUniformData& light) {
+    float nearPlane = CAMERA_NEAR;
+    float farPlane = std::min(shadowDistance, CAMERA_FAR);
+    float aspect = (float)screenWidth / (float)screenHeight;
+    float tanHalfFov = tanf(glm::radians(camera->fov) * 0.5f);
+    
+    glm::vec3 lightDir = glm::normalize(dirLight.direction);
+    bool lightMoved = glm::dot(lightDir, shadowLightDir) < SHADOW_LIGHT_REFIT_COS;
+    if (lightMoved) shadowLightDir = lightDir;
+    lightDir = shadowLightDir;
+    glm::vec3 up = fabsf(lightDir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
     
+    float sliceNear = nearPlane;
+    for (int i = 0; i < SHADOW_CASCADES; i++) {
+        float f = (float)(i + 1) / SHADOW_CASCADES;
+        float logSplit = nearPlane * powf(farPlane / nearPlane, f);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * f;
+        float sliceFar = SHADOW_SPLIT_LAMBDA * logSplit + (1.0f - SHADOW_SPLIT_LAMBDA) * uniformSplit;
+        
+        // Bounding sphere of the slice's eight corners
+        glm::vec3 corners[8];
+        for (int c = 0; c < 8; c++) {
+            float d = (c & 4) ? sliceFar : sliceNear;
+            float x = ((c & 1) ? 1.0f : -1.0f) * d * tanHalfFov * aspect;
+            float y = ((c & 2) ? 1.0f : -1.0f) * d * tanHalfFov;
+            corners[c] = camera->position + camera->front * d + camera->right * x + camera->up * y;
+        }
+        glm::vec3 center(0.0f);
+        for (int c = 0; c < 8; c++) center += corners[c];
+        center *= 1.0f / 8.0f;
+        float radius = 0.0f;
+        for (int c = 0; c < 8; c++) radius = std::max(radius, glm::length(corners[c] - center));
+        float boxRadius = ceilf(radius * (1.0f + SHADOW_CASCADE_SLACK) * 16.0f) / 16.0f;
+        
+        ShadowCascade& cascade = cascades[i];
+        bool contained = cascade.fitted && cascade.radius == boxRadius &&
+                         glm::length(center - cascade.center) <= boxRadius - radius;
+        if (lightMoved || !contained) {
+            cascade.center = center;
+            cascade.radius = boxRadius;
+            cascade.depthRange = 2.0f * boxRadius + SHADOW_CASTER_MARGIN;
+            cascade.lightView = glm::lookAt(center - lightDir * (boxRadius + SHADOW_CASTER_MARGIN), center, up);
+            glm::mat4 projection = glm::ortho(-boxRadius, boxRadius, -boxRadius, boxRadius, 0.0f, cascade.depthRange);
+            
+            // Snap to the texel grid: round where the world origin lands
+            float halfTexels = shadowWidth * 0.5f;
+            glm::vec4 origin = projection * cascade.lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            projection[3][0] += (floorf(origin.x * halfTexels + 0.5f) - origin.x * halfTexels) / halfTexels;
+            projection[3][1] += (floorf(origin.y * halfTexels + 0.5f) - origin.y * halfTexels) / halfTexels;
+            cascade.lightSpaceMatrix = projection * cascade.lightView;
+            cascade.fitted = true;
+            cascade.staticValid = false;
+        }
+        
+        light.lightSpaceMatrices[i] = cascade.lightSpaceMatrix;
+        light.cascadeSplits[i] = sliceFar;
+        light.cascadeTexelSizes[i] = 2.0f * cascade.radius / shadowWidth;
+        light.cascadeDepthRanges[i] = cascade.depthRange;
+        sliceNear = sliceFar;
+    }
+    light.shadowParams = glm::vec4(SHADOW_BLEND_BAND, SHADOW_PCSS_LIGHT_SIZE, 0.0f, 0.0f);
+}
+
+// Does a world-space sphere touch the cascade's light box? Casters between
+// the light and the box still count (their depth is clamped)
+bool ModernRenderer::inCascade(const ShadowCascade& cascade, const glm::vec3& center, float radius) const {
+    glm::vec4 p = cascade.lightView * glm::vec4(center, 1.0f);
+    float extent = cascade.radius + radius;
+    return fabsf(p.x) <= extent && fabsf(p.y) <= extent && -p.z - radius <= cascade.depthRange;
+}
+
+// Bounding radius of a mesh under model (largest axis scale)
+float ModernRenderer::boundingRadius(const Mesh* mesh, const glm::mat4& model) {
+    float scale = std::max(glm::length(glm::vec3(model[0].x, model[0].y, model[0].z)),
+                  std::max(glm::length(glm::vec3(model[1].x, model[1].y, model[1].z)),
+                           glm::length(glm::vec3(model[2].x, model[2].y, model[2].z))));
+    return mesh->boundsRadius * scale;
+}
+
+void ModernRenderer::beginShadowPass() {
     glViewport(0, 0, shadowWidth, shadowHeight);
+    glCullFace(GL_FRONT); // Peter panning fix
+    glEnable(GL_DEPTH_CLAMP); // Casters in front of the near plane land on it
+}
+
+void ModernRenderer::beginShadowCascade(int cascade) {
     glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthMap, 0, cascade);
     glClear(GL_DEPTH_BUFFER_BIT);
-    
-    glCullFace(GL_FRONT); // Peter panning fix
-    for (auto mesh : meshes) {
-        glm::mat4 model = glm::mat4(1.0f); // You should pass actual model matrices
-        shadowMapShader.setMat4("model", model);
-        mesh->draw();
-    }
+}
+
+void ModernRenderer::endShadowPass() {
+    glDisable(GL_DEPTH_CLAMP);
     glCullFace(GL_BACK);
-    
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, screenWidth, screenHeight);
 }
 
+void ModernRenderer::renderShadowMap(const std::vector<Mesh*>& meshes) {
+    // Render to shadow map (light space matrices are in the light block)
+    shadowMapShader.use();
+    beginShadowPass();
+    glm::mat4 model = glm::mat4(1.0f);    // Loaded meshes are in world space
+    shadowUniforms.model.set(model);
+    for (int c = 0; c < SHADOW_CASCADES; c++) {
+        shadowUniforms.cascade.set(c);
+        beginShadowCascade(c);
+        for (auto mesh : meshes) {
+            if (inCascade(cascades[c], mesh->boundsCenter, mesh->boundsRadius)) mesh->draw();
+        }
+    }
+    endShadowPass();
+}
+
 void ModernRenderer::setupSkybox(const std::vector<std::string>& faces) {
     // Skybox vertices
     float skyboxVertices[] = {
@@ -269,14 +624,7 @@ void ModernRenderer::setupSkybox(const std::vector<std::string>& faces) {
 
 void ModernRenderer::renderSkybox() {
     glDepthFunc(GL_LEQUAL);
-    skyboxShader.use();
-    
-    glm::mat4 view = glm::mat4(glm::mat3(camera->getViewMatrix())); // Remove translation
-    glm::mat4 projection = glm::perspective(glm::radians(camera->fov), 
-        (float)screenWidth / (float)screenHeight, 0.1f, 100.0f);
-    
-    skyboxShader.setMat4("view", view);
-    skyboxShader.setMat4("projection", projection);
+    skyboxShader.use();    // View and projection come from the frame block
     
     glBindVertexArray(skyboxVAO);
     glActiveTexture(GL_TEXTURE0);
@@ -295,73 +643,394 @@ void ModernRenderer::beginFrame() {
 void ModernRenderer::renderMesh(Mesh* mesh, const glm::mat4& model) {
     blinnPhongShader.use();
     
-    // Set matrices
-    glm::mat4 view = camera->getViewMatrix();
-    glm::mat4 projection = glm::perspective(glm::radians(camera->fov),
-        (float)screenWidth / (float)screenHeight, 0.1f, 100.0f);
-    
-    blinnPhongShader.setMat4("model", model);
-    blinnPhongShader.setMat4("view", view);
-    blinnPhongShader.setMat4("projection", projection);
-    blinnPhongShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+    // Per draw: model matrix and material; the rest is in the uniform buffers
+    phong.model.set(model);
+    phong.normalMatrix.set(normalMatrixFor(model));
+    bindMaterial(mesh->material, phong.material);
+    bindShadowMap();
     
-    // Set light
-    blinnPhongShader.setVec3("dirLight.direction", dirLight.direction);
-    blinnPhongShader.setVec3("dirLight.ambient", dirLight.ambient);
-    blinnPhongShader.setVec3("dirLight.diffuse", dirLight.diffuse);
-    blinnPhongShader.setVec3("dirLight.specular", dirLight.specular);
-    
-    // Set material
-    blinnPhongShader.setFloat("material.shininess", mesh->material.shininess);
-    blinnPhongShader.setBool("material.hasNormalMap", mesh->material.hasNormalMap);
-    
-    // Bind textures
+    mesh->draw();
+}
+
+// Shadow map on units 3 (compare sampler) and 4 (raw depth)
+void ModernRenderer::bindShadowMap() {
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthMap);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthMap);
+}
+
+// Material uniforms and textures (units are fixed, see resolveUniforms)
+void ModernRenderer::bindMaterial(const Material& material, const MaterialUniforms& uniforms) {
+    uniforms.shininess.set(material.shininess);
+    uniforms.hasNormalMap.set(material.hasNormalMap);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, mesh->material.diffuseMap);
-    blinnPhongShader.setInt("material.diffuseMap", 0);
-    
+    glBindTexture(GL_TEXTURE_2D, material.diffuseMap);
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, mesh->material.specularMap);
-    blinnPhongShader.setInt("material.specularMap", 1);
-    
+    glBindTexture(GL_TEXTURE_2D, material.specularMap);
     glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, mesh->material.normalMap);
-    blinnPhongShader.setInt("material.normalMap", 2);
+    glBindTexture(GL_TEXTURE_2D, material.normalMap);
+}
+
+void ModernRenderer::renderScene(const std::vector<Mesh*>& meshes) {
+    // Loaded meshes are already in world space and never move; placed and
+    // moving objects go through submit() with their own transform
+    for (auto mesh : meshes) {
+        submit(mesh, glm::mat4(1.0f), NULL, RENDER_STATIC);
+    }
+    renderSubmitted();
+}
+
+// ============================================
+// Instancing
+// ============================================
+
+void ModernRenderer::setupInstanceBuffer() {
+    instanceCapacity = INSTANCE_BUFFER_CAPACITY * sizeof(InstanceData);
+    instanceOffset = 0;
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * Reserve count instances in the stream buffer and map them for writing
+ * Written ranges are never touched again until the buffer is orphaned,
+ * so the map does not wait for draws still reading earlier ranges.
+ * @param offset: Receives the byte offset of the range
+ * @return Pointer to write to; glUnmapBuffer(GL_ARRAY_BUFFER) when done
+ */
+InstanceData* ModernRenderer::mapInstances(size_t count, GLintptr& offset) {
+    size_t bytes = count * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceOffset + bytes > instanceCapacity) {
+        // Orphan: the driver keeps the old storage alive for pending draws
+        if (bytes > instanceCapacity) instanceCapacity = bytes;
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity, NULL, GL_STREAM_DRAW);
+        instanceOffset = 0;
+    }
+    offset = (GLintptr)instanceOffset;
+    instanceOffset += bytes;
+    return (InstanceData*)glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+// Shadow passes leave the normal matrix out (the shader does not read it)
+static void fillInstance(InstanceData& instance, const glm::mat4& model, bool withNormalMatrix) {
+    instance.model = model;
+    if (withNormalMatrix) instance.normalMatrix = normalMatrixFor(model);
+}
+
+// Point attributes 5-11 at a range of instanceVBO and draw (mesh VAO bound)
+void ModernRenderer::drawInstances(Mesh* mesh, GLintptr offset, GLsizei count, bool withNormalMatrix) {
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    GLsizei stride = sizeof(InstanceData);
+    for (GLuint c = 0; c < 4; c++) {
+        glEnableVertexAttribArray(5 + c);
+        glVertexAttribPointer(5 + c, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(offset + c * sizeof(glm::vec4)));
+        glVertexAttribDivisor(5 + c, 1);
+    }
+    if (withNormalMatrix) {
+        for (GLuint c = 0; c < 3; c++) {
+            glEnableVertexAttribArray(9 + c);
+            glVertexAttribPointer(9 + c, 3, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(offset + sizeof(glm::mat4) + c * sizeof(glm::vec3)));
+            glVertexAttribDivisor(9 + c, 1);
+        }
+    }
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)mesh->indices.size(), GL_UNSIGNED_INT, 0, count);
+}
+
+void ModernRenderer::renderInstanced(Mesh* mesh, const glm::mat4* transforms, size_t count) {
+    if (count == 0) return;
+    GLintptr offset;
+    profiler.beginScope("instanced");
+    InstanceData* instances = mapInstances(count, offset);
+    for (size_t i = 0; i < count; i++) fillInstance(instances[i], transforms[i], true);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
     
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    blinnPhongShader.setInt("shadowMap", 3);
+    blinnPhongInstancedShader.use();
+    bindMaterial(mesh->material, phongInstanced);
+    bindShadowMap();
+    glBindVertexArray(mesh->VAO);
+    drawInstances(mesh, offset, (GLsizei)count, true);
+    glBindVertexArray(0);
+    profiler.endScope();
+}
+
+// ============================================
+// Render Queue
+// ============================================
+
+void ModernRenderer::submit(Mesh* mesh, const glm::mat4& model, const Material* material, unsigned int flags) {
+    QueueItem item;
+    item.mesh = mesh;
+    item.material = material ? material : &mesh->material;
+    item.flags = flags;
+    item.model = model;
+    glm::vec4 center = model * glm::vec4(mesh->boundsCenter, 1.0f);
+    item.boundsCenter = glm::vec3(center.x, center.y, center.z);
+    item.boundsRadius = boundingRadius(mesh, model);
+    queueItems.push_back(item);
+}
+
+// Small per-frame id for a mesh or material (first come, first numbered)
+uint32_t ModernRenderer::sortId(const void* object) {
+    std::unordered_map<const void*, uint32_t>::iterator it = sortIds.find(object);
+    if (it != sortIds.end()) return it->second;
+    uint32_t id = (uint32_t)sortIds.size();
+    sortIds[object] = id;
+    return id;
+}
+
+/*
+ * Key layout (ids wrap when a frame has more than fit; batches still
+ * compare the real pointers, only grouping gets worse)
+ * [63-62 pass][61-60 shader][59 two-sided][58-47 diffuse texture][46-37 material][36-25 mesh][24-0 depth]
+ * The shadow pass leaves texture and material at 0, so it groups by mesh only.
+ * Depth is the top 25 bits of the squared eye distance: front to back.
+ */
+uint64_t ModernRenderer::sortKey(const QueueItem& item, int pass, const glm::vec3& eye) {
+    glm::vec3 center(item.model[3].x, item.model[3].y, item.model[3].z);
+    glm::vec3 d = center - eye;
+    float distance2 = glm::dot(d, d);
+    uint32_t depthBits;
+    memcpy(&depthBits, &distance2, sizeof(depthBits));    // >= 0: orders like an integer
     
-    // Set camera and fog
-    blinnPhongShader.setVec3("viewPos", camera->position);
-    blinnPhongShader.setVec3("fogColor", fogColor);
-    blinnPhongShader.setFloat("fogDensity", fogDensity);
-    blinnPhongShader.setFloat("fogGradient", fogGradient);
+    uint64_t shader = pass;     // One program per pass for now
+    uint64_t twoSided = (item.flags & RENDER_TWO_SIDED) ? 1 : 0;
+    uint64_t texture = 0, material = 0;
+    if (pass == 1) {
+        texture = item.material->diffuseMap & 0xFFF;
+        material = sortId(item.material) & 0x3FF;
+    }
+    uint64_t mesh = sortId(item.mesh) & 0xFFF;
+    return ((uint64_t)pass << 62) | (shader << 60) | (twoSided << 59) | (texture << 47) |
+           (material << 37) | (mesh << 25) | (depthBits >> 6);
+}
+
+/**
+ * Stable LSD radix sort on the 64-bit keys, 8 bits per pass
+ * Passes where every key has the same digit are skipped, which is most of
+ * them for a typical frame (few passes, shaders and textures).
+ */
+void ModernRenderer::radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch) {
+    size_t n = entries.size();
+    if (n < 2) return;
+    scratch.resize(n);
+    SortEntry* src = &entries[0];
+    SortEntry* dst = &scratch[0];
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (size_t i = 0; i < n; i++) counts[(src[i].key >> shift) & 0xFF]++;
+        if (counts[(src[0].key >> shift) & 0xFF] == n) continue;
+        size_t total = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = counts[b];
+            counts[b] = total;
+            total += c;
+        }
+        for (size_t i = 0; i < n; i++) dst[counts[(src[i].key >> shift) & 0xFF]++] = src[i];
+        std::swap(src, dst);
+    }
+    if (src != &entries[0]) memcpy(&entries[0], src, n * sizeof(SortEntry));
+}
+
+void ModernRenderer::useProgramCached(const Shader& shader) {
+    if (bound.program == shader.ID) return;
+    glUseProgram(shader.ID);
+    bound.program = shader.ID;
+    queueStats.programBinds++;
+}
+
+void ModernRenderer::bindTextureCached(int unit, GLuint texture) {
+    if (bound.textures[unit] == texture) return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    bound.textures[unit] = texture;
+    queueStats.textureBinds++;
+}
+
+void ModernRenderer::bindVertexArrayCached(GLuint vertexArray) {
+    if (bound.vertexArray == vertexArray) return;
+    glBindVertexArray(vertexArray);
+    bound.vertexArray = vertexArray;
+    queueStats.vertexArrayBinds++;
+}
+
+void ModernRenderer::setCullFaceCached(bool enabled) {
+    if (bound.cullFace == enabled) return;
+    if (enabled) glEnable(GL_CULL_FACE);
+    else glDisable(GL_CULL_FACE);
+    bound.cullFace = enabled;
+}
+
+// Draw sorted entries - all of one pass - as instanced runs
+void ModernRenderer::drawQueuePass(int pass, const SortEntry* entries, size_t count) {
+    if (count == 0) return;
     
-    mesh->draw();
+    // Instance data in sorted order, so every run is a contiguous range
+    GLintptr base;
+    InstanceData* instances = mapInstances(count, base);
+    for (size_t i = 0; i < count; i++) {
+        fillInstance(instances[i], queueItems[entries[i].item].model, pass == 1);
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    
+    const Material* boundMaterial = NULL;
+    size_t runStart = 0;
+    for (size_t i = 0; i < count; i++) {
+        const QueueItem& item = queueItems[entries[i].item];
+        if (i + 1 < count) {
+            const QueueItem& next = queueItems[entries[i + 1].item];
+            bool sameRun = next.mesh == item.mesh &&
+                           (next.flags & RENDER_TWO_SIDED) == (item.flags & RENDER_TWO_SIDED) &&
+                           (pass == 0 || next.material == item.material);
+            if (sameRun) continue;
+        }
+        
+        setCullFaceCached(!(item.flags & RENDER_TWO_SIDED));
+        if (pass == 1 && item.material != boundMaterial) {
+            const Material& material = *item.material;
+            phongInstanced.shininess.set(material.shininess);
+            phongInstanced.hasNormalMap.set(material.hasNormalMap);
+            bindTextureCached(0, material.diffuseMap);
+            bindTextureCached(1, material.specularMap);
+            bindTextureCached(2, material.normalMap);
+            boundMaterial = item.material;
+        }
+        bindVertexArrayCached(item.mesh->VAO);
+        drawInstances(item.mesh, base + (GLintptr)(runStart * sizeof(InstanceData)),
+                      (GLsizei)(i + 1 - runStart), pass == 1);
+        queueStats.draws++;
+        runStart = i + 1;
+    }
 }
 
-void ModernRenderer::renderScene(const std::vector<Mesh*>& meshes) {
-    // 1. Render shadow map
-    renderShadowMap(meshes);
+// Draw the static or the dynamic casters that touch a cascade into the
+// bound layer (shadow entries are sortEntries[0, shadowEnd))
+void ModernRenderer::drawShadowCasters(int cascade, size_t shadowEnd, bool staticCasters) {
+    cascadeEntries.clear();
+    for (size_t i = 0; i < shadowEnd; i++) {
+        const QueueItem& item = queueItems[sortEntries[i].item];
+        if (((item.flags & RENDER_STATIC) != 0) == staticCasters &&
+            inCascade(cascades[cascade], item.boundsCenter, item.boundsRadius)) {
+            cascadeEntries.push_back(sortEntries[i]);
+        }
+    }
+    if (!cascadeEntries.empty()) drawQueuePass(0, &cascadeEntries[0], cascadeEntries.size());
+    queueStats.shadowCasters += (int)cascadeEntries.size();
+}
+
+void ModernRenderer::renderSubmitted() {
+    // Without endFrame() calls, every renderSubmitted() is a profiler frame
+    if (profiledSubmit) profiler.endFrame();
+    profiledSubmit = true;
     
-    // 2. Render scene
-    beginFrame();
+    profiler.beginScope("uniforms");
+    updateFrameUniforms();
+    profiler.endScope();
+    
+    profiler.beginScope("sort");
     
-    // Render skybox first
+    queueStats = RenderQueueStats();
+    queueStats.items = (int)queueItems.size();
+    
+    // One entry per item and pass it takes part in
+    sortIds.clear();
+    sortEntries.clear();
+    glm::vec3 eye = camera->position;
+    uint64_t staticHash = 14695981039346656037ULL;
+    for (size_t i = 0; i < queueItems.size(); i++) {
+        const QueueItem& item = queueItems[i];
+        if (!(item.flags & RENDER_NO_SHADOW)) {
+            SortEntry entry = { sortKey(item, 0, eye), (uint32_t)i };
+            sortEntries.push_back(entry);
+            if (item.flags & RENDER_STATIC) {
+                staticHash = hashBytes(staticHash, &item.mesh, sizeof(item.mesh));
+                staticHash = hashBytes(staticHash, &item.model, sizeof(item.model));
+            }
+        }
+        if (!(item.flags & RENDER_SHADOW_ONLY)) {
+            SortEntry entry = { sortKey(item, 1, eye), (uint32_t)i };
+            sortEntries.push_back(entry);
+        }
+    }
+    radixSort(sortEntries, sortScratch);
+    size_t shadowEnd = 0;
+    while (shadowEnd < sortEntries.size() && (sortEntries[shadowEnd].key >> 62) == 0) shadowEnd++;
+    profiler.endScope();
+    
+    // Nothing is known about the bound state on entry
+    bound.program = bound.vertexArray = ~0u;
+    for (int unit = 0; unit < 3; unit++) bound.textures[unit] = ~0u;
+    bound.cullFace = true;
+    glEnable(GL_CULL_FACE);
+    
+    // Static casters added, removed or moved
+    if (staticHash != staticCasterHash) {
+        staticCasterHash = staticHash;
+        invalidateStaticShadows();
+    }
+    
+    // 1. Shadow map: per cascade, the cached static casters (redrawn only
+    // when stale) plus the dynamic casters that touch it
+    static const char* const cascadeScopes[] = { "cascade 0", "cascade 1", "cascade 2", "cascade 3" };
+    static_assert(sizeof(cascadeScopes) / sizeof(cascadeScopes[0]) == SHADOW_CASCADES, "One scope name per cascade");
+    profiler.beginScope("shadow map");
+    useProgramCached(shadowMapInstancedShader);
+    beginShadowPass();
+    for (int c = 0; c < SHADOW_CASCADES; c++) {
+        profiler.beginScope(cascadeScopes[c]);
+        shadowInstancedCascade.set(c);
+        if (!cascades[c].staticValid) {
+            glBindFramebuffer(GL_FRAMEBUFFER, staticMapFBO);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepthMap, 0, c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawShadowCasters(c, shadowEnd, true);
+            cascades[c].staticValid = true;
+            queueStats.staticShadowRebuilds++;
+        }
+        
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, staticMapFBO);
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepthMap, 0, c);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthMapFBO);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthMap, 0, c);
+        glBlitFramebuffer(0, 0, shadowWidth, shadowHeight, 0, 0, shadowWidth, shadowHeight,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        drawShadowCasters(c, shadowEnd, false);
+        profiler.endScope();
+    }
+    endShadowPass();
+    profiler.endScope();
+    
+    // 2. Scene
+    beginFrame();
     if (cubemapTexture) {
+        profiler.beginScope("skybox");
         renderSkybox();
+        bound.program = bound.vertexArray = ~0u;
+        bound.textures[0] = ~0u;
+        profiler.endScope();
     }
+    profiler.beginScope("opaque");
+    useProgramCached(blinnPhongInstancedShader);
+    bindShadowMap();
+    if (shadowEnd < sortEntries.size()) drawQueuePass(1, &sortEntries[shadowEnd], sortEntries.size() - shadowEnd);
+    profiler.endScope();
     
-    // Render all meshes
-    for (auto mesh : meshes) {
-        glm::mat4 model = glm::mat4(1.0f); // You should manage model transforms
-        renderMesh(mesh, model);
-    }
+    setCullFaceCached(true);
+    glBindVertexArray(0);
+    queueItems.clear();
 }
 
 void ModernRenderer::endFrame() {
     // Swap buffers handled externally
+    profiler.endFrame();
+    profiledSubmit = false;
 }
 
 void ModernRenderer::setFog(const glm::vec3& color, float density, float gradient) {
@@ -11,8 +11,81 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Shader.h"
+#include "GpuProfiler.h"
 #include <vector>
 #include <string>
+#include <stdint.h>
+#include <unordered_map>
+
+// Uniform buffer binding points shared by all shaders
+const GLuint FRAME_UNIFORM_BINDING = 0;
+const GLuint LIGHT_UNIFORM_BINDING = 1;
+
+// Mirrors the std140 FrameData block (only vec4/mat4 members, so no padding rules apply)
+struct FrameUniformData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 viewPos;          // xyz
+    glm::vec4 fogColor;         // rgb, a = density
+    glm::vec4 fogParams;        // x = gradient
+};
+
+// Cascaded shadow maps: layers of one depth texture array, each covering
+// a slice of the camera frustum (must match SHADOW_CASCADES in the shaders)
+const int SHADOW_CASCADES = 4;
+
+// Mirrors the std140 LightData block
+struct LightUniformData {
+    glm::mat4 lightSpaceMatrices[SHADOW_CASCADES];
+    glm::vec4 cascadeSplits;    // Far view depth of each cascade
+    glm::vec4 cascadeTexelSizes; // World size of a shadow texel in each cascade
+    glm::vec4 cascadeDepthRanges; // Light-space depth covered by each cascade
+    glm::vec4 shadowParams;     // x = blend band (fraction of a cascade), y = PCSS light size
+    glm::vec4 direction;        // xyz
+    glm::vec4 ambient;          // rgb
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+// Shadow filter, compiled into the lit shaders (SHADOW_FILTER in
+// blinn_phong.frag). Texture fetches per shadowed pixel in brackets; every
+// fetch of the compare sampler is a hardware-filtered 2x2 PCF
+enum ShadowFilter {
+    SHADOW_FILTER_HARD = 0,     // [1] Single filtered tap
+    SHADOW_FILTER_PCF = 1,      // [4] 4x4 texel box
+    SHADOW_FILTER_POISSON = 2,  // [4-16] Rotated Poisson disk; 4 if those agree
+    SHADOW_FILTER_PCSS = 3      // [16-32] Blocker search + Poisson, contact hardening
+};
+
+// Per-instance vertex data (attributes 5-8 model, 9-11 normal matrix)
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normalMatrix;     // Proportional to transpose(inverse(mat3(model)))
+};
+
+// Stream buffer for instance data, refilled (orphaned) when full
+const size_t INSTANCE_BUFFER_CAPACITY = 16384;   // Instances
+
+// submit() flags
+enum RenderFlags {
+    RENDER_DEFAULT = 0,
+    RENDER_NO_SHADOW = 1,       // Visible, casts no shadow
+    RENDER_SHADOW_ONLY = 2,     // Casts a shadow, not drawn in the main pass
+    RENDER_TWO_SIDED = 4,       // No back-face culling (leaves, fences, nets)
+    RENDER_STATIC = 8           // Never moves: its shadow is cached, not redrawn every frame
+};
+
+// Render queue counters for the last renderSubmitted()
+struct RenderQueueStats {
+    int items;                  // Submitted meshes
+    int draws;                  // Instanced draw calls, both passes
+    int programBinds;           // glUseProgram calls that were not skipped
+    int textureBinds;           // glBindTexture calls that were not skipped
+    int vertexArrayBinds;       // glBindVertexArray calls that were not skipped
+    int shadowCasters;          // Caster instances drawn, summed over cascades
+    int staticShadowRebuilds;   // Cascades whose cached static layer was redrawn
+};
 
 // Material structure
 struct Material {
@@ -43,7 +116,11 @@ struct Mesh {
     GLuint VAO, VBO, EBO;
     Material material;
     
-    Mesh() : VAO(0), VBO(0), EBO(0) {}
+    // Bounding sphere in model space (set by setupMesh)
+    glm::vec3 boundsCenter;
+    float boundsRadius;
+    
+    Mesh() : VAO(0), VBO(0), EBO(0), boundsRadius(0.0f) {}
     
     void setupMesh();
     void draw();
@@ -97,19 +174,56 @@ public:
     bool initialize();
     
     // Shadow mapping
-    void setupShadowMap(unsigned int resolution = 2048);
+    // resolution is per cascade; SHADOW_CASCADES x 1024^2 costs as much as
+    // one 2048^2 map
+    void setupShadowMap(unsigned int resolution = 1024);
     void renderShadowMap(const std::vector<Mesh*>& meshes);
+    // Camera distance the cascades cover; nothing further away is shadowed
+    void setShadowDistance(float distance) { shadowDistance = distance; }
+    // Recompiles the lit shaders; pick per hardware tier (see ShadowFilter)
+    void setShadowFilter(ShadowFilter filter);
+    ShadowFilter getShadowFilter() const { return shadowFilter; }
+    // Redraw the cached RENDER_STATIC casters next frame (changes to the
+    // static submissions themselves are detected automatically)
+    void invalidateStaticShadows();
     
     // Skybox
     void setupSkybox(const std::vector<std::string>& faces);
     void renderSkybox();
     
     // Main rendering
+    // Upload camera, fog and light blocks; once per frame, before the
+    // shadow and scene passes (renderScene does this itself)
+    void updateFrameUniforms();
     void beginFrame();
     void renderMesh(Mesh* mesh, const glm::mat4& model);
     void renderScene(const std::vector<Mesh*>& meshes);
     void endFrame();
     
+    // Instancing
+    // Draw one mesh at every transform with a single draw call (main pass;
+    // updateFrameUniforms() and the shadow map must be current)
+    void renderInstanced(Mesh* mesh, const glm::mat4* transforms, size_t count);
+    
+    /**
+     * Queue a mesh for renderSubmitted()
+     * @param model: Model-to-world transform
+     * @param material: NULL = the mesh's own; must stay valid until rendered
+     * @param flags: RenderFlags
+     */
+    void submit(Mesh* mesh, const glm::mat4& model, const Material* material = NULL,
+                unsigned int flags = RENDER_DEFAULT);
+    
+    // Draw the frame from the queue (shadow pass, skybox, scene) and empty
+    // it. Items are radix-sorted by a 64-bit state key; runs of the same
+    // mesh and material become one instanced draw
+    void renderSubmitted();
+    const RenderQueueStats& getQueueStats() const { return queueStats; }
+    
+    // GPU/CPU pass timings, off until getProfiler().setEnabled(true).
+    // Frames end at endFrame(), or at the next renderSubmitted() without it
+    GpuProfiler& getProfiler() { return profiler; }
+    
     // Getters/Setters
     void setCamera(Camera* cam) { camera = cam; }
     void setLight(const DirectionalLight& light) { dirLight = light; }
@@ -122,14 +236,92 @@ private:
     
     // Shaders
     Shader blinnPhongShader;
+    Shader blinnPhongInstancedShader;
     Shader shadowMapShader;
+    Shader shadowMapInstancedShader;
     Shader skyboxShader;
     
+    // Per-draw uniform handles, resolved once after the shaders are compiled;
+    // everything else comes from the frame and light uniform buffers
+    struct MaterialUniforms {
+        Uniform<float> shininess;
+        Uniform<bool> hasNormalMap;
+    };
+    struct BlinnPhongUniforms {
+        Uniform<glm::mat4> model;
+        Uniform<glm::mat3> normalMatrix;
+        MaterialUniforms material;
+    } phong;
+    MaterialUniforms phongInstanced;
+    
+    struct ShadowMapUniforms {
+        Uniform<glm::mat4> model;
+        Uniform<int> cascade;
+    } shadowUniforms;
+    Uniform<int> shadowInstancedCascade;
+    
+    // Uniform buffers (FRAME_UNIFORM_BINDING, LIGHT_UNIFORM_BINDING)
+    GLuint frameUBO, lightUBO;
+    
+    // Instancing
+    GLuint instanceVBO;
+    size_t instanceCapacity;    // Bytes
+    size_t instanceOffset;      // Next free byte this buffer generation
+    
+    // Render queue
+    struct QueueItem {
+        Mesh* mesh;
+        const Material* material;
+        unsigned int flags;
+        glm::mat4 model;
+        glm::vec3 boundsCenter;     // World space
+        float boundsRadius;
+    };
+    struct SortEntry {
+        uint64_t key;
+        uint32_t item;          // Index into queueItems
+    };
+    std::vector<QueueItem> queueItems;
+    std::vector<SortEntry> sortEntries, sortScratch;
+    std::vector<SortEntry> cascadeEntries;    // Shadow entries inside one cascade
+    std::unordered_map<const void*, uint32_t> sortIds;   // Mesh/material -> per-frame id
+    RenderQueueStats queueStats;
+    
+    GpuProfiler profiler;
+    bool profiledSubmit;        // renderSubmitted() has opened a profiler frame
+    
+    // Bound-state cache, valid inside renderSubmitted()
+    struct BoundState {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint textures[3];     // Material units 0-2 (the shadow map has unit 3 to itself)
+        bool cullFace;
+    } bound;
+    
     // Shadow mapping
+    struct ShadowCascade {
+        glm::mat4 lightView;
+        glm::mat4 lightSpaceMatrix;     // Projection * lightView, texel snapped
+        glm::vec3 center;               // Of the ortho box
+        float radius;                   // Half extent of the ortho box
+        float depthRange;               // Light view depth of the far plane
+        bool fitted;                    // Box is set (kept while the slice stays inside)
+        bool staticValid;               // staticDepthMap layer matches the box
+        
+        ShadowCascade() : radius(0.0f), depthRange(0.0f), fitted(false), staticValid(false) {}
+    };
     GLuint depthMapFBO;
-    GLuint depthMap;
+    GLuint depthMap;                    // GL_TEXTURE_2D_ARRAY, one layer per cascade
+    GLuint staticMapFBO;
+    GLuint staticDepthMap;              // RENDER_STATIC casters only, same layout
+    GLuint shadowCompareSampler;        // depthMap on unit 3: depth comparison, linear (2x2 PCF)
+    GLuint shadowDepthSampler;          // depthMap on unit 4: raw depth (PCSS blocker search)
+    ShadowFilter shadowFilter;
     unsigned int shadowWidth, shadowHeight;
-    glm::mat4 lightSpaceMatrix;
+    float shadowDistance;
+    glm::vec3 shadowLightDir;           // Light direction the cascades are fitted to
+    uint64_t staticCasterHash;          // Of last frame's static submissions
+    ShadowCascade cascades[SHADOW_CASCADES];
     
     // Skybox
     GLuint skyboxVAO, skyboxVBO;
@@ -147,6 +339,30 @@ private:
     Camera* camera;
     
     // Helper functions
+    void compileLitShaders();
+    void resolveUniforms();
+    void bindShadowMap();
+    void setupUniformBuffers();
+    void setupInstanceBuffer();
+    InstanceData* mapInstances(size_t count, GLintptr& offset);
+    void drawInstances(Mesh* mesh, GLintptr offset, GLsizei count, bool withNormalMatrix);
+    void bindMaterial(const Material& material, const MaterialUniforms& uniforms);
+    uint32_t sortId(const void* object);
+    uint64_t sortKey(const QueueItem& item, int pass, const glm::vec3& eye);
+    static void radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+    void drawQueuePass(int pass, const SortEntry* entries, size_t count);
+    void updateShadowCascades(LightUniformData& light);
+    bool inCascade(const ShadowCascade& cascade, const glm::vec3& center, float radius) const;
+    static float boundingRadius(const Mesh* mesh, const glm::mat4& model);
+    void useProgramCached(const Shader& shader);
+    void bindTextureCached(int unit, GLuint texture);
+    void bindVertexArrayCached(GLuint vertexArray);
+    void setCullFaceCached(bool enabled);
+    void beginShadowPass();
+    void beginShadowCascade(int cascade);
+    void drawShadowCasters(int cascade, size_t shadowEnd, bool staticCasters);
+    static GLuint createDepthArray(unsigned int width, unsigned int height);
+    void endShadowPass();
     void calculateTangentSpace(Mesh& mesh);
     GLuint loadTexture(const std::string& path);
     GLuint loadCubemap(const std::vector<std::string>& faces);
@@ -2,6 +2,12 @@
  * Shader.h
  * Modern OpenGL Shader Management System
  * Supports vertex, fragment, geometry, and compute shaders
+ *
+ * After linking, every active uniform is reflected into a hash table
+ * (name -> location, type), so setters never call glGetUniformLocation.
+ * Hot code resolves Uniform<T> handles once and sets them with no string
+ * work at all; names that are not active uniforms and handles whose type
+ * does not match the GLSL declaration are reported once.
  */
 
 #ifndef SHADER_H
@@ -12,23 +18,107 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <set>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// ============================================================================
+// UNIFORM HANDLES
+// ============================================================================
+
+inline void uploadUniform(GLint location, bool value) { glUniform1i(location, (int)value); }
+inline void uploadUniform(GLint location, int value) { glUniform1i(location, value); }
+inline void uploadUniform(GLint location, float value) { glUniform1f(location, value); }
+inline void uploadUniform(GLint location, const glm::vec2& value) { glUniform2fv(location, 1, &value[0]); }
+inline void uploadUniform(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, &value[0]); }
+inline void uploadUniform(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, &value[0]); }
+inline void uploadUniform(GLint location, const glm::mat3& value) {
+    glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]);
+}
+inline void uploadUniform(GLint location, const glm::mat4& value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+inline bool isSamplerType(GLenum type) {
+    switch (type) {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+            return true;
+    }
+    return false;
+}
+
+// GLSL types a C++ value type can be uploaded to
+template <typename T> struct UniformType;
+template <> struct UniformType<bool> {
+    static bool accepts(GLenum type) { return type == GL_BOOL || type == GL_INT; }
+};
+template <> struct UniformType<int> {
+    static bool accepts(GLenum type) { return type == GL_INT || type == GL_BOOL || isSamplerType(type); }
+};
+template <> struct UniformType<float> { static bool accepts(GLenum type) { return type == GL_FLOAT; } };
+template <> struct UniformType<glm::vec2> { static bool accepts(GLenum type) { return type == GL_FLOAT_VEC2; } };
+template <> struct UniformType<glm::vec3> { static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; } };
+template <> struct UniformType<glm::vec4> { static bool accepts(GLenum type) { return type == GL_FLOAT_VEC4; } };
+template <> struct UniformType<glm::mat3> { static bool accepts(GLenum type) { return type == GL_FLOAT_MAT3; } };
+template <> struct UniformType<glm::mat4> { static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; } };
+
+/**
+ * Pre-resolved uniform location of one program (see Shader::uniform)
+ * An unresolved handle (-1) ignores set(), like GL itself does.
+ * The program must be in use when set() is called.
+ */
+template <typename T>
+class Uniform {
+public:
+    Uniform() : location(-1) {}
+    explicit Uniform(GLint loc) : location(loc) {}
+    
+    void set(const T& value) const {
+        if (location >= 0) uploadUniform(location, value);
+    }
+    
+    bool isValid() const { return location >= 0; }
+    GLint getLocation() const { return location; }
+    
+private:
+    GLint location;
+};
+
+// Reflected active uniform
+struct UniformInfo {
+    std::string name;     // Empty = free slot
+    unsigned int hash;
+    GLint location;
+    GLenum type;          // GL_FLOAT_MAT4, GL_SAMPLER_2D, ...
+    GLint size;           // Array elements from this one on, 1 for plain uniforms
+};
+
+// ============================================================================
+// SHADER
+// ============================================================================
+
 class Shader {
 public:
     GLuint ID;
     
     // Constructor
-    Shader() : ID(0) {}
+    Shader() : ID(0), uniformCount(0) {}
     
     // Load shader from file
-    Shader(const char* vertexPath, const char* fragmentPath) {
-        compile(vertexPath, fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath, const char* defines = NULL) : ID(0), uniformCount(0) {
+        compile(vertexPath, fragmentPath, defines);
     }
     
-    // Compile shader from source
-    void compile(const char* vertexPath, const char* fragmentPath) {
+    /**
+     * Compile shader from source
+     * @param defines: Lines inserted after #version in both stages, e.g.
+     *                 "#define INSTANCED\n", to build variants of one source
+     */
+    void compile(const char* vertexPath, const char* fragmentPath, const char* defines = NULL) {
         // 1. Retrieve source code
         std::string vertexCode;
         std::string fragmentCode;
@@ -52,6 +142,11 @@ public:
             return;
         }
         
+        if (defines) {
+            insertDefines(vertexCode, defines);
+            insertDefines(fragmentCode, defines);
+        }
+        
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
         
@@ -70,7 +165,9 @@ public:
         glCompileShader(fragment);
         checkCompileErrors(fragment, "FRAGMENT");
         
-        // Shader Program
+        // Shader Program (recompiling replaces the old one)
+        if (ID) glDeleteProgram(ID);
+        warned.clear();
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
@@ -80,6 +177,8 @@ public:
         // Delete shaders (they're linked now)
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        
+        reflectUniforms();
     }
     
     // Activate shader
@@ -87,40 +186,170 @@ public:
         glUseProgram(ID);
     }
     
-    // Utility uniform functions
-    void setBool(const std::string& name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    /**
+     * Resolve a uniform once, for hot code
+     * @param name: GLSL name, e.g. "material.shininess" or "lights[2].color"
+     * @return Handle that ignores set() if the uniform is not active
+     */
+    template <typename T>
+    Uniform<T> uniform(const char* name) const {
+        const UniformInfo* info = findUniform(name);
+        if (!info) return Uniform<T>();
+        if (!UniformType<T>::accepts(info->type)) {
+            warnOnce(name, "handle type does not match the GLSL declaration");
+            return Uniform<T>();
+        }
+        return Uniform<T>(info->location);
     }
     
-    void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    // Location of an active uniform, -1 if there is none (no GL call)
+    GLint location(const char* name) const {
+        const UniformInfo* info = findUniform(name);
+        return info ? info->location : -1;
     }
     
-    void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    // Number of active uniforms found at link time
+    int activeUniformCount() const { return uniformCount; }
+    
+    /**
+     * Attach a uniform block to a binding point (GLSL 3.30 has no layout(binding))
+     * @return false if the program does not use the block
+     */
+    bool bindUniformBlock(const char* blockName, GLuint binding) const {
+        GLuint index = glGetUniformBlockIndex(ID, blockName);
+        if (index == GL_INVALID_INDEX) return false;
+        glUniformBlockBinding(ID, index, binding);
+        return true;
     }
     
-    void setVec2(const std::string& name, const glm::vec2& value) const {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    // Utility uniform functions (table lookup; prefer uniform<T>() in loops)
+    void setBool(const char* name, bool value) const { uploadUniform(location(name), value); }
+    void setInt(const char* name, int value) const { uploadUniform(location(name), value); }
+    void setFloat(const char* name, float value) const { uploadUniform(location(name), value); }
+    void setVec2(const char* name, const glm::vec2& value) const { uploadUniform(location(name), value); }
+    void setVec3(const char* name, const glm::vec3& value) const { uploadUniform(location(name), value); }
+    void setVec4(const char* name, const glm::vec4& value) const { uploadUniform(location(name), value); }
+    void setMat3(const char* name, const glm::mat3& mat) const { uploadUniform(location(name), mat); }
+    void setMat4(const char* name, const glm::mat4& mat) const { uploadUniform(location(name), mat); }
+    
+    void setBool(const std::string& name, bool value) const { setBool(name.c_str(), value); }
+    void setInt(const std::string& name, int value) const { setInt(name.c_str(), value); }
+    void setFloat(const std::string& name, float value) const { setFloat(name.c_str(), value); }
+    void setVec2(const std::string& name, const glm::vec2& value) const { setVec2(name.c_str(), value); }
+    void setVec3(const std::string& name, const glm::vec3& value) const { setVec3(name.c_str(), value); }
+    void setVec4(const std::string& name, const glm::vec4& value) const { setVec4(name.c_str(), value); }
+    void setMat3(const std::string& name, const glm::mat3& mat) const { setMat3(name.c_str(), mat); }
+    void setMat4(const std::string& name, const glm::mat4& mat) const { setMat4(name.c_str(), mat); }
+    
+private:
+    // Open addressing, linear probing, power-of-two size (at most half full)
+    std::vector<UniformInfo> uniformTable;
+    int uniformCount;
+    mutable std::set<std::string> warned;
+    
+    // After the #version line, which must stay first
+    static void insertDefines(std::string& code, const char* defines) {
+        size_t version = code.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : code.find('\n', version);
+        if (lineEnd == std::string::npos) code.insert(0, defines);
+        else code.insert(lineEnd + 1, defines);
     }
     
-    void setVec3(const std::string& name, const glm::vec3& value) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    // FNV-1a, so lookups hash the caller's C string without a std::string
+    static unsigned int hashName(const char* name) {
+        unsigned int hash = 2166136261u;
+        for (const char* c = name; *c; c++) {
+            hash ^= (unsigned char)*c;
+            hash *= 16777619u;
+        }
+        return hash;
     }
     
-    void setVec4(const std::string& name, const glm::vec4& value) const {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    const UniformInfo* findUniform(const char* name) const {
+        if (!uniformTable.empty()) {
+            unsigned int hash = hashName(name);
+            size_t mask = uniformTable.size() - 1;
+            for (size_t i = hash & mask; !uniformTable[i].name.empty(); i = (i + 1) & mask) {
+                if (uniformTable[i].hash == hash && uniformTable[i].name == name) return &uniformTable[i];
+            }
+        }
+        warnOnce(name, "is not an active uniform (misspelt, or optimised out by the compiler)");
+        return NULL;
     }
     
-    void setMat3(const std::string& name, const glm::mat3& mat) const {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void insertUniform(const std::string& name, GLint location, GLenum type, GLint size) {
+        unsigned int hash = hashName(name.c_str());
+        size_t mask = uniformTable.size() - 1;
+        size_t i = hash & mask;
+        while (!uniformTable[i].name.empty()) {
+            if (uniformTable[i].name == name) return;
+            i = (i + 1) & mask;
+        }
+        UniformInfo& info = uniformTable[i];
+        info.name = name;
+        info.hash = hash;
+        info.location = location;
+        info.type = type;
+        info.size = size;
     }
     
-    void setMat4(const std::string& name, const glm::mat4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void reflectUniforms() {
+        uniformTable.clear();
+        warned.clear();
+        uniformCount = 0;
+        
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        
+        std::vector<GLchar> nameBuffer(maxLength > 0 ? maxLength : 1);
+        std::vector<std::string> names(count);
+        std::vector<GLint> sizes(count);
+        std::vector<GLenum> types(count);
+        size_t entries = 0;
+        for (GLint i = 0; i < count; i++) {
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuffer.size(), NULL, &sizes[i], &types[i], &nameBuffer[0]);
+            names[i] = &nameBuffer[0];
+            entries += sizes[i] + 1;
+        }
+        
+        // Arrays are stored once per element ("weights[0]", "weights[1]", ...)
+        // plus under the bare name ("weights")
+        size_t tableSize = 16;
+        while (tableSize < entries * 2) tableSize *= 2;
+        uniformTable.assign(tableSize, UniformInfo());
+        
+        for (GLint i = 0; i < count; i++) {
+            const std::string& name = names[i];
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0) continue;    // Member of a uniform block
+            
+            insertUniform(name, location, types[i], sizes[i]);
+            size_t bracket = name.rfind("[0]");
+            if (bracket != std::string::npos && bracket + 3 == name.size()) {
+                std::string base = name.substr(0, bracket);
+                insertUniform(base, location, types[i], sizes[i]);
+                
+                // Element locations need not be consecutive, so ask for each
+                for (GLint element = 1; element < sizes[i]; element++) {
+                    std::ostringstream elementName;
+                    elementName << base << '[' << element << ']';
+                    GLint elementLocation = glGetUniformLocation(ID, elementName.str().c_str());
+                    if (elementLocation >= 0) {
+                        insertUniform(elementName.str(), elementLocation, types[i], sizes[i] - element);
+                    }
+                }
+            }
+            uniformCount++;
+        }
+    }
+    
+    void warnOnce(const char* name, const char* problem) const {
+        if (!warned.insert(name).second) return;
+        std::cout << "WARNING::SHADER::UNIFORM \"" << name << "\" " << problem
+                  << " (program " << ID << ")" << std::endl;
     }
     
-private:
     // Check for shader compilation/linking errors
     void checkCompileErrors(GLuint shader, std::string type) {
         GLint success;
@@ -8,6 +8,7 @@
 #include "modern_renderer/ModernRenderer.h"
 #include "modern_renderer/Shader.h"
 #include <GLFW/glfw3.h>
+#include <cstring>
 #include <iostream>
 
 // Window dimensions
@@ -30,8 +31,11 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 
-int main()
+int main(int argc, char** argv)
 {
+    // --trace: profile every pass and write a Chrome trace on exit
+    bool trace = argc > 1 && strcmp(argv[1], "--trace") == 0;
+
     // Initialize GLFW
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -103,6 +107,8 @@ int main()
     std::cout << "  Scroll - Zoom" << std::endl;
     std::cout << "  ESC - Exit" << std::endl;
     
+    renderer.getProfiler().setEnabled(trace);
+    
     // Render loop
     while (!glfwWindowShouldClose(window))
     {
@@ -116,12 +122,17 @@ int main()
 
         // Render scene
         renderer.renderScene(sceneMeshes);
+        renderer.endFrame();
 
         // Swap buffers and poll events
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    if (trace && renderer.getProfiler().writeChromeTrace("modern_renderer_trace.json")) {
+        std::cout << "Wrote modern_renderer_trace.json" << std::endl;
+    }
+
     // Cleanup
     for (auto mesh : sceneMeshes) {
         delete mesh;
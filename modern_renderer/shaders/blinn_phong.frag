@@ -1,17 +1,29 @@
 /*
  * blinn_phong.frag
  * Fragment Shader for Blinn-Phong with Normal Mapping, Shadow Mapping PCF, and Fog
+ * SHADOW_FILTER: one of the SHADOW_FILTER_* below (ShadowFilter in ModernRenderer.h)
  */
 
 #version 330 core
 
+// Shadow map layers (SHADOW_CASCADES in ModernRenderer.h)
+#define SHADOW_CASCADES 4
+
+#define SHADOW_FILTER_HARD 0
+#define SHADOW_FILTER_PCF 1
+#define SHADOW_FILTER_POISSON 2
+#define SHADOW_FILTER_PCSS 3
+#ifndef SHADOW_FILTER
+#define SHADOW_FILTER SHADOW_FILTER_POISSON
+#endif
+
 out vec4 FragColor;
 
 in VS_OUT {
     vec3 FragPos;
     vec2 TexCoords;
     vec3 Normal;
-    vec4 FragPosLightSpace;
+    float ViewDepth;
     mat3 TBN;
 } fs_in;
 
@@ -32,47 +44,166 @@ struct DirLight {
     vec3 specular;
 };
 
+// Per-frame data, written once per frame (FrameUniformData in ModernRenderer.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPos;         // xyz
+    vec4 fogColor;        // rgb, a = density
+    vec4 fogParams;       // x = gradient
+};
+
+// Sun light, written once per frame (LightUniformData in ModernRenderer.h)
+layout (std140) uniform LightData {
+    mat4 lightSpaceMatrices[SHADOW_CASCADES];
+    vec4 cascadeSplits;   // Far view depth of each cascade
+    vec4 cascadeTexelSizes; // World size of a shadow texel in each cascade
+    vec4 cascadeDepthRanges; // Light-space depth covered by each cascade
+    vec4 shadowParams;    // x = blend band (fraction of a cascade), y = PCSS light size
+    vec4 lightDirection;  // xyz
+    vec4 lightAmbient;    // rgb
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
 uniform Material material;
-uniform DirLight dirLight;
-uniform sampler2D shadowMap;
+uniform sampler2DArrayShadow shadowMap;   // One layer per cascade; each fetch is a 2x2 PCF
+#if SHADOW_FILTER == SHADOW_FILTER_PCSS
+uniform sampler2DArray shadowDepth;       // Same texture, raw depths for the blocker search
+#endif
 
-uniform vec3 viewPos;
-uniform vec3 fogColor;
-uniform float fogDensity;
-uniform float fogGradient;
+// Filter radius in shadow texels (Poisson; PCSS clamps to the max)
+const float POISSON_RADIUS = 2.5;
+const float PCSS_SEARCH_RADIUS = 6.0;
+const float PCSS_MAX_RADIUS = 8.0;
 
-// Shadow calculation with PCF (Percentage-Closer Filtering)
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
+// 16-point Poisson disk; the first four are spread out for the early-out
+const vec2 poissonDisk[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+    vec2(0.97484398, 0.75648379), vec2(-0.81409955, 0.91437590),
+    vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760),
+    vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543, 0.27676845), vec2(0.44323325, -0.97511554),
+    vec2(0.53742981, -0.47373420), vec2(-0.26496911, -0.41893023),
+    vec2(0.79197514, 0.19090188), vec2(-0.24188840, 0.99706507),
+    vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
+);
+
+// Per-pixel rotation of the Poisson disk (interleaved gradient noise):
+// turns banding into fine noise
+mat2 DiskRotation()
 {
+    float angle = 6.2831853 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float s = sin(angle), c = cos(angle);
+    return mat2(c, s, -s, c);
+}
+
+// Fraction of a rotated Poisson disk in shadow (radius in texels)
+float PoissonShadow(vec3 coords, float layer, float reference, vec2 texelSize, float radius)
+{
+    mat2 rotation = DiskRotation();
+    vec2 scale = texelSize * radius;
+    float lit = 0.0;
+    for(int i = 0; i < 4; ++i)
+        lit += texture(shadowMap, vec4(coords.xy + rotation * poissonDisk[i] * scale, layer, reference));
+    // Outer taps agree: fully lit or fully shadowed, skip the rest
+    if(lit == 0.0 || lit == 4.0)
+        return 1.0 - lit * 0.25;
+    for(int i = 4; i < 16; ++i)
+        lit += texture(shadowMap, vec4(coords.xy + rotation * poissonDisk[i] * scale, layer, reference));
+    return 1.0 - lit / 16.0;
+}
+
+// Shadow from one cascade, filtered by SHADOW_FILTER
+float CascadeShadow(int cascade, vec3 normal, vec3 lightDir)
+{
+    // Look up a little off the surface, scaled to this cascade's texels
+    vec3 position = fs_in.FragPos + normal * cascadeTexelSizes[cascade] * 1.5;
+    vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(position, 1.0);
+    
     // Perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     
     // Transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
     
-    // Get closest depth value from light's perspective
-    float currentDepth = projCoords.z;
-    
     // Check if outside shadow map
     if(projCoords.z > 1.0)
         return 0.0;
     
     // Calculate bias to prevent shadow acne
     float bias = max(0.005 * (1.0 - dot(normal, lightDir)), 0.0005);
+    float reference = projCoords.z - bias;
+    float layer = float(cascade);
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
     
-    // PCF (Percentage-Closer Filtering) for soft shadows
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-    
-    for(int x = -2; x <= 2; ++x)
+#if SHADOW_FILTER == SHADOW_FILTER_HARD
+    return 1.0 - texture(shadowMap, vec4(projCoords.xy, layer, reference));
+#elif SHADOW_FILTER == SHADOW_FILTER_PCF
+    // Four 2x2 taps one texel off centre cover a 4x4 box
+    float lit = 0.0;
+    lit += texture(shadowMap, vec4(projCoords.xy + vec2(-1.0, -1.0) * texelSize, layer, reference));
+    lit += texture(shadowMap, vec4(projCoords.xy + vec2( 1.0, -1.0) * texelSize, layer, reference));
+    lit += texture(shadowMap, vec4(projCoords.xy + vec2(-1.0,  1.0) * texelSize, layer, reference));
+    lit += texture(shadowMap, vec4(projCoords.xy + vec2( 1.0,  1.0) * texelSize, layer, reference));
+    return 1.0 - lit * 0.25;
+#elif SHADOW_FILTER == SHADOW_FILTER_POISSON
+    return PoissonShadow(projCoords, layer, reference, texelSize, POISSON_RADIUS);
+#else
+    // PCSS: average depth of the blockers around the pixel...
+    mat2 rotation = DiskRotation();
+    float blockerSum = 0.0;
+    float blockers = 0.0;
+    for(int i = 0; i < 16; ++i)
     {
-        for(int y = -2; y <= 2; ++y)
+        vec2 offset = rotation * poissonDisk[i] * texelSize * PCSS_SEARCH_RADIUS;
+        float depth = texture(shadowDepth, vec3(projCoords.xy + offset, layer)).r;
+        if(depth < reference)
         {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+            blockerSum += depth;
+            blockers += 1.0;
         }
     }
-    shadow /= 25.0; // 5x5 kernel
+    if(blockers == 0.0)
+        return 0.0;
+    
+    // ...sets the penumbra: wider the further the receiver is behind them
+    float blockerDistance = (reference - blockerSum / blockers) * cascadeDepthRanges[cascade];
+    float penumbra = blockerDistance * shadowParams.y / cascadeTexelSizes[cascade];
+    return PoissonShadow(projCoords, layer, reference, texelSize, clamp(penumbra, 1.0, PCSS_MAX_RADIUS));
+#endif
+}
+
+// Pick the cascade by view depth; near the end of a cascade blend into
+// the next one (after the last one, fade the shadow out)
+float ShadowCalculation(vec3 normal, vec3 lightDir)
+{
+    // Facing away from the light: unlit anyway, no lookups needed
+    if(dot(normal, lightDir) <= 0.0)
+        return 1.0;
+    
+    float depth = fs_in.ViewDepth;
+    if(depth >= cascadeSplits[SHADOW_CASCADES - 1])
+        return 0.0;
+    
+    int cascade = 0;
+    for(int i = 0; i < SHADOW_CASCADES - 1; ++i)
+    {
+        if(depth > cascadeSplits[i])
+            cascade = i + 1;
+    }
+    float shadow = CascadeShadow(cascade, normal, lightDir);
+    
+    float sliceStart = cascade == 0 ? 0.0 : cascadeSplits[cascade - 1];
+    float sliceEnd = cascadeSplits[cascade];
+    float band = (sliceEnd - sliceStart) * shadowParams.x;
+    float blend = clamp((depth - (sliceEnd - band)) / band, 0.0, 1.0);
+    if(blend > 0.0)
+    {
+        float next = cascade < SHADOW_CASCADES - 1 ? CascadeShadow(cascade + 1, normal, lightDir) : 0.0;
+        shadow = mix(shadow, next, blend);
+    }
     
     return shadow;
 }
@@ -95,7 +226,7 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseTex, ve
     vec3 specular = light.specular * spec * specularTex;
     
     // Shadow
-    float shadow = ShadowCalculation(fs_in.FragPosLightSpace, normal, lightDir);
+    float shadow = ShadowCalculation(normal, lightDir);
     
     // Apply shadow only to diffuse and specular, not ambient
     return ambient + (1.0 - shadow) * (diffuse + specular);
@@ -117,17 +248,18 @@ void main()
         normal = normalize(fs_in.Normal);
     }
     
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - fs_in.FragPos);
     
     // Calculate lighting
+    DirLight dirLight = DirLight(lightDirection.xyz, lightAmbient.rgb, lightDiffuse.rgb, lightSpecular.rgb);
     vec3 result = CalcDirLight(dirLight, normal, viewDir, diffuseTex, specularTex);
     
     // Apply fog
-    float distanceToCamera = length(viewPos - fs_in.FragPos);
-    float fogFactor = exp(-pow(distanceToCamera * fogDensity, fogGradient));
+    float distanceToCamera = length(viewPos.xyz - fs_in.FragPos);
+    float fogFactor = exp(-pow(distanceToCamera * fogColor.a, fogParams.x));
     fogFactor = clamp(fogFactor, 0.0, 1.0);
     
-    result = mix(fogColor, result, fogFactor);
+    result = mix(fogColor.rgb, result, fogFactor);
     
     FragColor = vec4(result, 1.0);
 }
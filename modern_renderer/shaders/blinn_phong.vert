@@ -1,47 +1,80 @@
 /*
  * blinn_phong.vert
  * Vertex Shader for Blinn-Phong with Normal Mapping and Shadow Mapping
+ * INSTANCED: model and normal matrix come per instance from attributes 5-11
+ * The normal matrix is only known up to scale; normals are renormalized
  */
 
 #version 330 core
 
+// Shadow map layers (SHADOW_CASCADES in ModernRenderer.h)
+#define SHADOW_CASCADES 4
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
+layout (location = 3) in vec4 aTangent;   // w = bitangent sign
 
 out VS_OUT {
     vec3 FragPos;
     vec2 TexCoords;
     vec3 Normal;
-    vec4 FragPosLightSpace;
+    float ViewDepth;      // Distance along the view direction (cascade selection)
     mat3 TBN;
 } vs_out;
 
+// Per-frame data, written once per frame (FrameUniformData in ModernRenderer.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPos;         // xyz
+    vec4 fogColor;        // rgb, a = density
+    vec4 fogParams;       // x = gradient
+};
+
+// Sun light, written once per frame (LightUniformData in ModernRenderer.h)
+layout (std140) uniform LightData {
+    mat4 lightSpaceMatrices[SHADOW_CASCADES];
+    vec4 cascadeSplits;   // Far view depth of each cascade
+    vec4 cascadeTexelSizes; // World size of a shadow texel in each cascade
+    vec4 cascadeDepthRanges; // Light-space depth covered by each cascade
+    vec4 shadowParams;    // x = blend band (fraction of a cascade), y = PCSS light size
+    vec4 lightDirection;  // xyz
+    vec4 lightAmbient;    // rgb
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+#ifdef INSTANCED
+layout (location = 5) in mat4 aModel;         // Locations 5-8
+layout (location = 9) in mat3 aNormalMatrix;  // Locations 9-11
+#else
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
+uniform mat3 normalMatrix;    // From the CPU, once per draw
+#endif
 
 void main()
 {
+#ifdef INSTANCED
+    mat4 model = aModel;
+    mat3 normalMatrix = aNormalMatrix;
+#endif
     vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
     vs_out.TexCoords = aTexCoords;
     
     // Calculate normal in world space
-    mat3 normalMatrix = transpose(inverse(mat3(model)));
-    vec3 T = normalize(normalMatrix * aTangent);
+    vec3 T = normalize(normalMatrix * aTangent.xyz);
     vec3 N = normalize(normalMatrix * aNormal);
     // Re-orthogonalize T with respect to N
     T = normalize(T - dot(T, N) * N);
-    vec3 B = cross(N, T);
+    // Only the sign of w: GL 3.3 decodes the 2-bit -1 as -1/3
+    vec3 B = cross(N, T) * (aTangent.w < 0.0 ? -1.0 : 1.0);
     
     vs_out.TBN = mat3(T, B, N);
     vs_out.Normal = normalMatrix * aNormal;
     
-    // Position in light space for shadow mapping
-    vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
+    vs_out.ViewDepth = -(view * vec4(vs_out.FragPos, 1.0)).z;
     
-    gl_Position = projection * view * vec4(vs_out.FragPos, 1.0);
+    gl_Position = viewProjection * vec4(vs_out.FragPos, 1.0);
 }
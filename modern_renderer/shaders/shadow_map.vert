@@ -1,16 +1,41 @@
 /*
  * shadow_map.vert
  * Vertex Shader for Shadow Map Generation
+ * INSTANCED: model matrix comes per instance from attributes 5-8
  */
 
 #version 330 core
 
+// Shadow map layers (SHADOW_CASCADES in ModernRenderer.h)
+#define SHADOW_CASCADES 4
+
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 lightSpaceMatrix;
+// Sun light, written once per frame (LightUniformData in ModernRenderer.h)
+layout (std140) uniform LightData {
+    mat4 lightSpaceMatrices[SHADOW_CASCADES];
+    vec4 cascadeSplits;   // Far view depth of each cascade
+    vec4 cascadeTexelSizes; // World size of a shadow texel in each cascade
+    vec4 cascadeDepthRanges; // Light-space depth covered by each cascade
+    vec4 shadowParams;    // x = blend band (fraction of a cascade), y = PCSS light size
+    vec4 lightDirection;  // xyz
+    vec4 lightAmbient;    // rgb
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+#ifdef INSTANCED
+layout (location = 5) in mat4 aModel;
+#else
 uniform mat4 model;
+#endif
+
+uniform int cascade;    // Layer being rendered
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+#ifdef INSTANCED
+    mat4 model = aModel;
+#endif
+    gl_Position = lightSpaceMatrices[cascade] * model * vec4(aPos, 1.0);
 }
@@ -9,8 +9,15 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+// Per-frame data, written once per frame (FrameUniformData in ModernRenderer.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPos;         // xyz
+    vec4 fogColor;        // rgb, a = density
+    vec4 fogParams;       // x = gradient
+};
 
 void main()
 {
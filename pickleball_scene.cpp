@@ -16,7 +16,10 @@
  * - A/D: Rotate camera left/right
  * - Q/E: Adjust camera height
  * - R/F: Adjust wind speed
+ * - P: Toggle profiler overlay
+ * - G: Toggle adaptive quality (with --budget)
  * - SPACE: Pause/Resume animations
+ * - [ / ]: Seek back/forward 10 s while replaying (--replay)
  * - ESC: Exit
  */
 
@@ -24,14 +27,22 @@
 #include <cmath>
 #include <cstdio>
 #include <vector>
-#include <cstdlib>  // for rand()
+#include <cstdlib>  // for atoi(), strtoull()
+#include <cstring>  // for memcmp(), strcmp()
 #include "GraphicsUtils_v2.h" // Enhanced graphics: Shadows (Fixed)
 #include "ModelLoader.h"  // 3D Model loader with Assimp
+#include "Simulation.h"   // Rally simulation (no GL)
+#include "RenderQueue.h"   // Sorted opaque/transparent draw queue
+#include "CloudLayer.h"    // Billboard clouds from a pre-rendered atlas
+#include "FrameProfiler.h" // CPU/GPU frame timings and overlay (P key)
+#include "ReplayLog.h"     // --record / --replay input logs
+#include "FrameCapture.h"  // --capture / --capture-pipe footage
+#include "QualityGovernor.h"   // --budget: adaptive quality (G key)
+#include "SceneRenderTarget.h" // Scaled / multisampled scene framebuffer
+#include "RallyEventLog.h"     // Rally events printed/logged off the render thread
+#include "FramePacer.h"        // Frame scheduling and jitter statistics
 
-// Constants
-const float PI = 3.14159265359f;
-const float COURT_LENGTH = 20.115f;  // Scaled 1.5x (was 13.41f)
-const float COURT_WIDTH = 9.15f;     // Scaled 1.5x (was 6.10f)
+// Constants (PI, court size) come from Simulation.h
 
 // Out-of-bounds Area Margins (Global Settings)
 const float MARGIN_X = 3.0f;  // Side margins (meters) - UNIFORM
@@ -40,36 +51,39 @@ const float MARGIN_Z = 10.0f;  // End margins (meters) - SCALED TO MATCH
 // Global variables
 float timeOfDay = 0.5f;  // 0=midnight, 0.5=noon, 1.0=midnight again
 
-// Ball state for rally simulation - IMPROVED for continuous rally
-float ballPosX = -3.5f;  
-float ballPosY = 1.5f;   // Start well above net (0.914m)
-float ballPosZ = 0.0f;   
-float ballVelocityX = 0.08f;  // Moderate horizontal speed
-float ballVelocityY = 0.03f;  // Gentle arc for consistent net clearance  
-float ballVelocityZ = 0.0f;   
-bool isPaused = false;
-
-// Rally control
-int rallyCount = 0;
-int currentServer = 1;  // 1 or 2
-float serveDelay = 0.0f;
-
-// Smooth interpolation for animations
-float targetArmSwing1 = 0.0f;
-float targetArmSwing2 = 0.0f;
-float smoothFactor = 0.15f;  // Interpolation speed
+// Rally simulation state: ball, players, walkers, dog (see Simulation.h)
+SimulationState sim;
+
+// Hits, bounces, net and wall events posted by the simulation
+RallyEventQueue rallyEvents;
+RallyEventLog rallyLog;
 
 // Camera variables - ADJUSTED for symmetrical view
 float cameraDistance = 25.0f;  // Increased for better overview
 float cameraAngle = 0.0f;      // Front view (was 45° diagonal)
 float cameraHeight = 15.0f;    // Higher for better perspective
 
+// Quality settings driven by the quality governor (full quality by default)
+float propDetail = 1.0f;   // Tessellation scale for spheres, cylinders and cones
+int shadowDetail = 0;      // 0 = all ground shadows, 1 = characters only, 2 = none
+
+// Slice/stack count scaled by propDetail
+int lodSlices(int count) {
+    int n = (int)(count * propDetail + 0.5f);
+    return n < 4 ? 4 : n;
+}
+
 // Animation variables
 float playerSwing1 = 0.0f;
 float playerSwing2 = 0.0f;
-float windTime = 0.0f;
-float windStrength = 1.0f;
-float animationTime = 0.0f;
+
+// === FIXED-STEP SIMULATION ===
+// Physics runs at a fixed tick rate in real units (m, s) and is decoupled
+// from rendering (tuning constants live in Simulation.h)
+float simTickRate = 60.0f;        // Simulation steps per second (configurable)
+int targetFrameRate = 60;         // Render rate: 30, 60, 144... 0 = uncapped (or vsync)
+FramePacer pacer;                 // Schedules redraws at targetFrameRate
+const float MAX_FRAME_TIME = 0.25f;  // Longer hitches are dropped (avoids spiral of death)
 
 // 3D Model loaders - NEW!
 ModelLoader treeModel;
@@ -77,44 +91,6 @@ ModelLoader paddleModel;
 ModelLoader playerModel;
 bool use3DModels = false;  // Will be set to true if models load successfully
 
-// Player animation states
-struct PlayerState {
-    float legAngle1, legAngle2;
-    float armSwing;
-    float bodyTilt;
-    float jumpHeight;
-    // Movement
-    float posX, posZ;        // Current position
-    float targetX, targetZ;  // Target position (where ball will land)
-    float moveSpeed;         // Movement speed
-};
-
-PlayerState player1State = {0, 0, 0, 0, 0, -COURT_LENGTH/4, 0, -COURT_LENGTH/4, 0, 0.08f};
-PlayerState player2State = {0, 0, 0, 0, 0, COURT_LENGTH/4, 0, COURT_LENGTH/4, 0, 0.08f};
-
-// Walker animation states (people walking/jogging on track)
-struct WalkerState {
-    float posX, posZ;        // Current position
-    float angle;             // Direction angle (0-360)
-    float speed;             // Walking/jogging speed
-    float legAngle1, legAngle2;
-    float armSwing1, armSwing2;
-    int pathSegment;         // Which segment of track (0=bottom, 1=right, 2=top, 3=left)
-    float pathProgress;      // Progress along current segment (0-1)
-};
-
-// Initialize 4 walkers on different parts of the track
-// Track offset = 9.0f, trackWidth = 3.0f, middle of track = 10.5f from center
-WalkerState walker1 = {-COURT_LENGTH/2 - 10.5f, -COURT_WIDTH/2 - 10.5f, 0, 0.04f, 0, 0, 0, 0, 3, 0.0f};  // Person with dog
-WalkerState walker2 = {COURT_LENGTH/2 + 10.5f, -COURT_WIDTH/2 - 10.0f, 180, 0.04f, 0, 0, 0, 0, 0, 0.5f}; // Walking couple (person 1 - left)
-WalkerState walker3 = {COURT_LENGTH/2 + 10.5f, -COURT_WIDTH/2 - 11.0f, 180, 0.04f, 0, 0, 0, 0, 0, 0.5f}; // Walking couple (person 2 - right)
-WalkerState walker4 = {-COURT_LENGTH/2 - 10.5f, COURT_WIDTH/2 + 10.5f, 270, 0.04f, 0, 0, 0, 0, 2, 0.7f}; // Walker (same speed)
-
-// Dog position (follows walker1)
-float dogPosX = walker1.posX + 1.5f;
-float dogPosZ = walker1.posZ;
-float dogAngle = walker1.angle; // Dog faces same direction as walker
-
 // Sky color structure
 struct SkyColor {
     float r, g, b;
@@ -155,118 +131,226 @@ void getSunPosition(float t, float &x, float &y, float &z) {
     z = 0.0f;
 }
 
-// Function to set lighting based on time of day
-void setupLighting() {
-    float sunX, sunY, sunZ;
-    getSunPosition(timeOfDay, sunX, sunY, sunZ);
-    
-    bool isNight = (timeOfDay < 0.3f || timeOfDay > 0.7f);
+// ============================================================================
+// DAY CYCLE LOOKUP TABLE
+// ============================================================================
+// Sky color, sun position and light terms are baked once over the whole
+// day. 240 samples (every 6 minutes) line up with the 0.05 steps used by
+// the lighting thresholds below. setupLighting() interpolates the table
+// and only talks to GL when something actually changed.
+
+const int DAY_CYCLE_SAMPLES = 240;
+
+struct DayCycleSample {
+    float sky[3];
+    float sunPos[3];
+    float globalAmbient[4];
+    float sunAmbient[4];
+    float sunDiffuse[4];      // Also used as sun specular
+    bool sunOn;               // GL_LIGHT0
+    bool floodlightsOn;       // GL_LIGHT1..4
+};
+
+DayCycleSample dayCycle[DAY_CYCLE_SAMPLES + 1];  // Last entry wraps to midnight
+DayCycleSample currentLighting;                  // Result of the last lookup
+
+// Sun down, floodlights on
+bool isNightTime(float t) {
+    return t < 0.3f || t > 0.7f;
+}
+
+// Fill one sample with the lighting rules for time t
+void computeDayCycleSample(float t, DayCycleSample& s) {
+    SkyColor sky = getSkyColor(t);
+    s.sky[0] = sky.r;
+    s.sky[1] = sky.g;
+    s.sky[2] = sky.b;
+    getSunPosition(t, s.sunPos[0], s.sunPos[1], s.sunPos[2]);
+    
+    bool isNight = isNightTime(t);
+    s.sunOn = !isNight;
+    s.floodlightsOn = isNight;
     
     if (isNight) {
-        // === NIGHT MODE: Dark environment with stadium floodlights ===
-        
         // Very low ambient light (dark night)
         GLfloat darkAmbient[] = {0.05f, 0.05f, 0.08f, 1.0f};
-        glLightModelfv(GL_LIGHT_MODEL_AMBIENT, darkAmbient);
-        
-        // Disable sun (GL_LIGHT0)
-        glDisable(GL_LIGHT0);
-        
-        // === STADIUM FLOODLIGHTS (4 powerful spotlights) ===
-        // Floodlight positions (matching drawCourtFloodlight positions)
-        float floodlightData[][3] = {
-            // x, z, height at 4 corners
-            {-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 - 2, 10.0f},  // Bottom-left
-            {COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 2, 10.0f},   // Bottom-right
-            {-COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 2, 10.0f},   // Top-left
-            {COURT_LENGTH/2 + 2, COURT_WIDTH/2 + 2, 10.0f}     // Top-right
-        };
-        
-        // Enable and configure 4 floodlights
-        GLenum lights[] = {GL_LIGHT1, GL_LIGHT2, GL_LIGHT3, GL_LIGHT4};
-        
-        for (int i = 0; i < 4; i++) {
-            glEnable(lights[i]);
-            
-            // Position at top of pole
-            GLfloat pos[] = {floodlightData[i][0], floodlightData[i][2], floodlightData[i][1], 1.0f};
-            glLightfv(lights[i], GL_POSITION, pos);
-            
-            // VERY BRIGHT white light (stadium quality - ENHANCED)
-            GLfloat diffuse[] = {1.5f, 1.5f, 1.4f, 1.0f};  // Boosted intensity
-            GLfloat specular[] = {1.0f, 1.0f, 1.0f, 1.0f};
-            GLfloat ambient[] = {0.3f, 0.3f, 0.3f, 1.0f};  // Added ambient contribution
-            glLightfv(lights[i], GL_DIFFUSE, diffuse);
-            glLightfv(lights[i], GL_SPECULAR, specular);
-            glLightfv(lights[i], GL_AMBIENT, ambient);
-            
-            // Spotlight parameters - ALL lights converge to CENTER
-            // All 4 floodlights focus on the exact center of the court
-            GLfloat centerY = 0.0f;  // Court surface level
-            
-            // ALL lights target the CENTER (0, 0)
-            GLfloat targetX = 0.0f;  // Center X
-            GLfloat targetZ = -3.2f;  // Center Z
-            
-            GLfloat dirX = targetX - floodlightData[i][0];
-            GLfloat dirY = centerY - floodlightData[i][2];
-            GLfloat dirZ = targetZ - floodlightData[i][1];
-            
-            GLfloat spotDir[] = {dirX, dirY, dirZ};
-            glLightfv(lights[i], GL_SPOT_DIRECTION, spotDir);
-            glLightf(lights[i], GL_SPOT_CUTOFF, 55.0f);  // Wider cone for overlap
-            glLightf(lights[i], GL_SPOT_EXPONENT, 6.0f);  // Very soft falloff
-            
-            // Minimal attenuation for maximum coverage
-            glLightf(lights[i], GL_CONSTANT_ATTENUATION, 1.0f);
-            glLightf(lights[i], GL_LINEAR_ATTENUATION, 0.002f);  // Very low
-            glLightf(lights[i], GL_QUADRATIC_ATTENUATION, 0.0002f);
-        }
-
+        memcpy(s.globalAmbient, darkAmbient, sizeof(darkAmbient));
         
+        // Sun is off - keep its last daytime colors so nothing is re-uploaded
+        GLfloat sunAmbient[] = {0.6f, 0.6f, 0.65f, 1.0f};
+        GLfloat sunDiffuse[] = {1.0f * 0.9f, 0.8f * 0.9f, 0.6f * 0.9f, 1.0f};
+        memcpy(s.sunAmbient, sunAmbient, sizeof(sunAmbient));
+        memcpy(s.sunDiffuse, sunDiffuse, sizeof(sunDiffuse));
     } else {
-        // === DAY MODE: Natural sunlight ===
-        
-        // Disable stadium lights
-        glDisable(GL_LIGHT1);
-        glDisable(GL_LIGHT2);
-        glDisable(GL_LIGHT3);
-        glDisable(GL_LIGHT4);
-        
-        // Enable sun
-        glEnable(GL_LIGHT0);
-        
-        // Sun position and color
-        GLfloat lightPos[] = {sunX, sunY, sunZ, 1.0f};
-        
         float intensity = 1.0f;
-        GLfloat lightColor[4];
-        
-        if (timeOfDay < 0.35f || timeOfDay > 0.65f) {  // Dawn/Dusk
+        if (t < 0.35f || t > 0.65f) {  // Dawn/Dusk
             intensity = 0.9f;
-            lightColor[0] = 1.0f * intensity;
-            lightColor[1] = 0.8f * intensity;
-            lightColor[2] = 0.6f * intensity;
+            s.sunDiffuse[0] = 1.0f * intensity;
+            s.sunDiffuse[1] = 0.8f * intensity;
+            s.sunDiffuse[2] = 0.6f * intensity;
         } else {  // Full daylight
-            intensity = 1.0f;
-            lightColor[0] = 1.0f;
-            lightColor[1] = 1.0f;
-            lightColor[2] = 0.95f;
+            s.sunDiffuse[0] = 1.0f;
+            s.sunDiffuse[1] = 1.0f;
+            s.sunDiffuse[2] = 0.95f;
         }
-        lightColor[3] = 1.0f;
-        
-        glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
-        glLightfv(GL_LIGHT0, GL_DIFFUSE, lightColor);
-        glLightfv(GL_LIGHT0, GL_SPECULAR, lightColor);
+        s.sunDiffuse[3] = 1.0f;
         
         // Bright ambient for daytime
         GLfloat ambient[] = {0.6f, 0.6f, 0.65f, 1.0f};
-        glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
+        memcpy(s.sunAmbient, ambient, sizeof(ambient));
         
         // Bright global ambient
         GLfloat globalAmbient[] = {0.4f, 0.4f, 0.45f, 1.0f};
-        glLightModelfv(GL_LIGHT_MODEL_AMBIENT, globalAmbient);
+        memcpy(s.globalAmbient, globalAmbient, sizeof(globalAmbient));
+    }
+}
+
+// Bake the whole day once at startup
+void bakeDayCycle() {
+    for (int i = 0; i <= DAY_CYCLE_SAMPLES; i++) {
+        computeDayCycleSample((float)i / DAY_CYCLE_SAMPLES, dayCycle[i]);
+    }
+}
+
+// Interpolated table lookup. Light on/off flags are exact for t, only the
+// colors come from the table.
+void lookupDayCycle(float t, DayCycleSample& out) {
+    float f = t * DAY_CYCLE_SAMPLES;
+    if (f < 0.0f) f = 0.0f;
+    if (f > DAY_CYCLE_SAMPLES) f = (float)DAY_CYCLE_SAMPLES;
+    int i = (int)f;
+    if (i >= DAY_CYCLE_SAMPLES) i = DAY_CYCLE_SAMPLES - 1;
+    float w = f - i;
+    
+    const DayCycleSample& a = dayCycle[i];
+    const DayCycleSample& b = dayCycle[i + 1];
+    
+    // Across a day/night switch, take the light colors from the side t is on
+    bool isNight = isNightTime(t);
+    out = (a.sunOn == !isNight) ? a : b;
+    out.sunOn = !isNight;
+    out.floodlightsOn = isNight;
+    for (int k = 0; k < 3; k++) {
+        out.sky[k] = a.sky[k] + (b.sky[k] - a.sky[k]) * w;
+        out.sunPos[k] = a.sunPos[k] + (b.sunPos[k] - a.sunPos[k]) * w;
+    }
+    
+    // Light colors are piecewise constant - only blend inside the same lighting mode
+    if (a.sunOn == b.sunOn) {
+        for (int k = 0; k < 4; k++) {
+            out.globalAmbient[k] = a.globalAmbient[k] + (b.globalAmbient[k] - a.globalAmbient[k]) * w;
+            out.sunAmbient[k] = a.sunAmbient[k] + (b.sunAmbient[k] - a.sunAmbient[k]) * w;
+            out.sunDiffuse[k] = a.sunDiffuse[k] + (b.sunDiffuse[k] - a.sunDiffuse[k]) * w;
+        }
+    }
+}
+
+// Floodlight positions (matching drawCourtFloodlight positions)
+const float FLOODLIGHT_DATA[][3] = {
+    // x, z, height at 4 corners
+    {-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 - 2, 10.0f},  // Bottom-left
+    {COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 2, 10.0f},   // Bottom-right
+    {-COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 2, 10.0f},   // Top-left
+    {COURT_LENGTH/2 + 2, COURT_WIDTH/2 + 2, 10.0f}     // Top-right
+};
+const GLenum FLOODLIGHTS[] = {GL_LIGHT1, GL_LIGHT2, GL_LIGHT3, GL_LIGHT4};
+
+// Floodlight colors and cone never change - uploaded once
+void setupFloodlightParameters() {
+    for (int i = 0; i < 4; i++) {
+        // VERY BRIGHT white light (stadium quality - ENHANCED)
+        GLfloat diffuse[] = {1.5f, 1.5f, 1.4f, 1.0f};  // Boosted intensity
+        GLfloat specular[] = {1.0f, 1.0f, 1.0f, 1.0f};
+        GLfloat ambient[] = {0.3f, 0.3f, 0.3f, 1.0f};  // Added ambient contribution
+        glLightfv(FLOODLIGHTS[i], GL_DIFFUSE, diffuse);
+        glLightfv(FLOODLIGHTS[i], GL_SPECULAR, specular);
+        glLightfv(FLOODLIGHTS[i], GL_AMBIENT, ambient);
+        
+        glLightf(FLOODLIGHTS[i], GL_SPOT_CUTOFF, 55.0f);  // Wider cone for overlap
+        glLightf(FLOODLIGHTS[i], GL_SPOT_EXPONENT, 6.0f);  // Very soft falloff
+        
+        // Minimal attenuation for maximum coverage
+        glLightf(FLOODLIGHTS[i], GL_CONSTANT_ATTENUATION, 1.0f);
+        glLightf(FLOODLIGHTS[i], GL_LINEAR_ATTENUATION, 0.002f);  // Very low
+        glLightf(FLOODLIGHTS[i], GL_QUADRATIC_ATTENUATION, 0.0002f);
+    }
+}
+
+// Light positions/directions are transformed by the current modelview,
+// so they have to be re-sent whenever the camera moves
+void uploadFloodlightPositions() {
+    for (int i = 0; i < 4; i++) {
+        // Position at top of pole
+        GLfloat pos[] = {FLOODLIGHT_DATA[i][0], FLOODLIGHT_DATA[i][2], FLOODLIGHT_DATA[i][1], 1.0f};
+        glLightfv(FLOODLIGHTS[i], GL_POSITION, pos);
+        
+        // Spotlight parameters - ALL lights converge to CENTER
+        GLfloat centerY = 0.0f;  // Court surface level
+        GLfloat targetX = 0.0f;  // Center X
+        GLfloat targetZ = -3.2f;  // Center Z
+        
+        GLfloat spotDir[] = {targetX - FLOODLIGHT_DATA[i][0],
+                             centerY - FLOODLIGHT_DATA[i][2],
+                             targetZ - FLOODLIGHT_DATA[i][1]};
+        glLightfv(FLOODLIGHTS[i], GL_SPOT_DIRECTION, spotDir);
+    }
+}
+
+// What was last sent to GL (so unchanged frames cost nothing)
+DayCycleSample uploadedLighting;
+GLfloat uploadedView[16];
+bool lightingUploaded = false;
+
+// Function to set lighting based on time of day
+// Call after the camera transform; only changed values are uploaded
+void setupLighting() {
+    lookupDayCycle(timeOfDay, currentLighting);
+    const DayCycleSample& s = currentLighting;
+    const DayCycleSample& old = uploadedLighting;
+    
+    GLfloat view[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, view);
+    bool viewChanged = !lightingUploaded || memcmp(view, uploadedView, sizeof(view)) != 0;
+    bool first = !lightingUploaded;
+    
+    // === Light switches (sun by day, stadium floodlights at night) ===
+    if (first || s.sunOn != old.sunOn) {
+        if (s.sunOn) glEnable(GL_LIGHT0);
+        else glDisable(GL_LIGHT0);
+    }
+    if (first || s.floodlightsOn != old.floodlightsOn) {
+        for (int i = 0; i < 4; i++) {
+            if (s.floodlightsOn) glEnable(FLOODLIGHTS[i]);
+            else glDisable(FLOODLIGHTS[i]);
+        }
+    }
+    if (first) setupFloodlightParameters();
+    
+    // === Colors ===
+    if (first || memcmp(s.globalAmbient, old.globalAmbient, sizeof(s.globalAmbient)) != 0) {
+        glLightModelfv(GL_LIGHT_MODEL_AMBIENT, s.globalAmbient);
     }
+    if (first || memcmp(s.sunDiffuse, old.sunDiffuse, sizeof(s.sunDiffuse)) != 0) {
+        glLightfv(GL_LIGHT0, GL_DIFFUSE, s.sunDiffuse);
+        glLightfv(GL_LIGHT0, GL_SPECULAR, s.sunDiffuse);
+    }
+    if (first || memcmp(s.sunAmbient, old.sunAmbient, sizeof(s.sunAmbient)) != 0) {
+        glLightfv(GL_LIGHT0, GL_AMBIENT, s.sunAmbient);
+    }
+    
+    // === Positions (eye space, depend on the camera) ===
+    bool sunMoved = memcmp(s.sunPos, old.sunPos, sizeof(s.sunPos)) != 0;
+    if (s.sunOn && (viewChanged || sunMoved || !old.sunOn)) {
+        GLfloat lightPos[] = {s.sunPos[0], s.sunPos[1], s.sunPos[2], 1.0f};
+        glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+    }
+    if (s.floodlightsOn && (viewChanged || !old.floodlightsOn)) {
+        uploadFloodlightPositions();
+    }
+    
+    uploadedLighting = s;
+    memcpy(uploadedView, view, sizeof(view));
+    lightingUploaded = true;
 }
 
 // Draw the court surface - FLAT COLOR
@@ -359,13 +443,12 @@ void drawCourt() {
     glPopMatrix();
 }
 
-// Draw the net
+// Draw the net posts
 void drawNet() {
     glPushMatrix();
     
     // Net posts
-    GLfloat postMaterial[] = {0.3f, 0.3f, 0.3f, 1.0f};
-    //glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, postMaterial);
+    glColor3f(0.3f, 0.3f, 0.3f);  // Dark gray posts
     
     glPushMatrix();
     glTranslatef(0, 0.5f, -COURT_WIDTH/2 - 0.1f);
@@ -379,14 +462,21 @@ void drawNet() {
     glutSolidCube(1.0f);
     glPopMatrix();
     
+    glPopMatrix();
+}
+
+// Draw the net mesh (transparent pass - blend state is set by the render queue)
+void drawNetMesh() {
+    glPushMatrix();
+    
     // Net mesh - WHITE with emission
     GLfloat netColor[] = {1.0f, 1.0f, 1.0f, 0.9f};
     GLfloat netEmission[] = {0.3f, 0.3f, 0.3f, 1.0f};
     //glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, netColor);
     //glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, netEmission);
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4fv(netColor);
+    glLineWidth(4.0f);
     
     glBegin(GL_LINES);
     for (float z = -COURT_WIDTH/2; z <= COURT_WIDTH/2; z += 0.1f) {
@@ -411,7 +501,7 @@ void drawTree(float x, float z) {
     glPushMatrix();
     glTranslatef(x, 0, z);
     
-    float swayAngle = sin(windTime + x * 0.5f + z * 0.3f) * windStrength * 3.0f;
+    float swayAngle = sin(sim.windTime + x * 0.5f + z * 0.3f) * sim.windStrength * 3.0f;
     
     // Try to use 3D model if loaded
     if (treeModel.getMeshCount() > 0) {
@@ -431,7 +521,7 @@ void drawTree(float x, float z) {
         // glTranslatef(0, 1.5f, 0); 
         glRotatef(-90, 1, 0, 0);
         GLUquadric* quad = gluNewQuadric();
-        gluCylinder(quad, 0.35f, 0.25f, 3.0f, 16, 4);
+        gluCylinder(quad, 0.35f, 0.25f, 3.0f, lodSlices(16), 4);
         gluDeleteQuadric(quad);
         glPopMatrix();
         
@@ -445,19 +535,19 @@ void drawTree(float x, float z) {
         
         glPushMatrix();
         glTranslatef(0, 0.0f, 0);
-        glutSolidSphere(1.4f, 16, 16);
+        glutSolidSphere(1.4f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glColor3f(0.35f, 0.75f, 0.35f);  // Even brighter
         glPushMatrix();
         glTranslatef(0, 0.8f, 0);
-        glutSolidSphere(1.1f, 16, 16);
+        glutSolidSphere(1.1f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glColor3f(0.4f, 0.8f, 0.4f);  // Lightest green (sun-lit)
         glPushMatrix();
         glTranslatef(0, 1.5f, 0);
-        glutSolidSphere(0.8f, 16, 16);
+        glutSolidSphere(0.8f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glColor3f(0.3f, 0.7f, 0.3f);
@@ -466,7 +556,7 @@ void drawTree(float x, float z) {
             glPushMatrix();
             glRotatef(angle, 0, 1, 0);
             glTranslatef(0.9f, 0.5f, 0);
-            glutSolidSphere(0.4f, 12, 12);
+            glutSolidSphere(0.4f, lodSlices(12), lodSlices(12));
             glPopMatrix();
         }
         
@@ -485,7 +575,7 @@ void drawSmallTree(float x, float z) {
     glPushMatrix();
     glTranslatef(x, 0, z);
     
-    float swayAngle = sin(windTime + x * 0.5f + z * 0.3f) * windStrength * 3.0f;
+    float swayAngle = sin(sim.windTime + x * 0.5f + z * 0.3f) * sim.windStrength * 3.0f;
     
     // Try to use 3D model if loaded
     if (treeModel.getMeshCount() > 0) {
@@ -497,7 +587,7 @@ void drawSmallTree(float x, float z) {
         glPushMatrix();
         glRotatef(-90, 1, 0, 0);
         GLUquadric* quad = gluNewQuadric();
-        gluCylinder(quad, 0.21f, 0.15f, 1.8f, 16, 4);
+        gluCylinder(quad, 0.21f, 0.15f, 1.8f, lodSlices(16), 4);
         gluDeleteQuadric(quad);
         glPopMatrix();
         
@@ -506,18 +596,18 @@ void drawSmallTree(float x, float z) {
         glRotatef(swayAngle, 0, 0, 1);
         
         glColor3f(0.3f, 0.7f, 0.3f);
-        glutSolidSphere(0.84f, 16, 16);
+        glutSolidSphere(0.84f, lodSlices(16), lodSlices(16));
         
         glColor3f(0.35f, 0.75f, 0.35f);
         glPushMatrix();
         glTranslatef(0, 0.48f, 0);
-        glutSolidSphere(0.66f, 16, 16);
+        glutSolidSphere(0.66f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glColor3f(0.4f, 0.8f, 0.4f);
         glPushMatrix();
         glTranslatef(0, 0.9f, 0);
-        glutSolidSphere(0.48f, 16, 16);
+        glutSolidSphere(0.48f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glPopMatrix();
@@ -531,7 +621,7 @@ void drawMediumTree(float x, float z) {
     glPushMatrix();
     glTranslatef(x, 0, z);
     
-    float swayAngle = sin(windTime + x * 0.5f + z * 0.3f) * windStrength * 3.0f;
+    float swayAngle = sin(sim.windTime + x * 0.5f + z * 0.3f) * sim.windStrength * 3.0f;
     
     if (treeModel.getMeshCount() > 0) {
         glRotatef(swayAngle, 0, 0, 1);
@@ -541,7 +631,7 @@ void drawMediumTree(float x, float z) {
         glPushMatrix();
         glRotatef(-90, 1, 0, 0);
         GLUquadric* quad = gluNewQuadric();
-        gluCylinder(quad, 0.28f, 0.20f, 2.4f, 16, 4);
+        gluCylinder(quad, 0.28f, 0.20f, 2.4f, lodSlices(16), 4);
         gluDeleteQuadric(quad);
         glPopMatrix();
         
@@ -550,18 +640,18 @@ void drawMediumTree(float x, float z) {
         glRotatef(swayAngle, 0, 0, 1);
         
         glColor3f(0.3f, 0.7f, 0.3f);
-        glutSolidSphere(1.12f, 16, 16);
+        glutSolidSphere(1.12f, lodSlices(16), lodSlices(16));
         
         glColor3f(0.35f, 0.75f, 0.35f);
         glPushMatrix();
         glTranslatef(0, 0.64f, 0);
-        glutSolidSphere(0.88f, 16, 16);
+        glutSolidSphere(0.88f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glColor3f(0.4f, 0.8f, 0.4f);
         glPushMatrix();
         glTranslatef(0, 1.2f, 0);
-        glutSolidSphere(0.64f, 16, 16);
+        glutSolidSphere(0.64f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glPopMatrix();
@@ -575,7 +665,7 @@ void drawLargeTree(float x, float z) {
     glPushMatrix();
     glTranslatef(x, 0, z);
     
-    float swayAngle = sin(windTime + x * 0.5f + z * 0.3f) * windStrength * 3.0f;
+    float swayAngle = sin(sim.windTime + x * 0.5f + z * 0.3f) * sim.windStrength * 3.0f;
     
     if (treeModel.getMeshCount() > 0) {
         glRotatef(swayAngle, 0, 0, 1);
@@ -585,7 +675,7 @@ void drawLargeTree(float x, float z) {
         glPushMatrix();
         glRotatef(-90, 1, 0, 0);
         GLUquadric* quad = gluNewQuadric();
-        gluCylinder(quad, 0.42f, 0.30f, 3.6f, 16, 4);
+        gluCylinder(quad, 0.42f, 0.30f, 3.6f, lodSlices(16), 4);
         gluDeleteQuadric(quad);
         glPopMatrix();
         
@@ -594,18 +684,18 @@ void drawLargeTree(float x, float z) {
         glRotatef(swayAngle, 0, 0, 1);
         
         glColor3f(0.3f, 0.7f, 0.3f);
-        glutSolidSphere(1.68f, 16, 16);
+        glutSolidSphere(1.68f, lodSlices(16), lodSlices(16));
         
         glColor3f(0.35f, 0.75f, 0.35f);
         glPushMatrix();
         glTranslatef(0, 0.96f, 0);
-        glutSolidSphere(1.32f, 16, 16);
+        glutSolidSphere(1.32f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glColor3f(0.4f, 0.8f, 0.4f);
         glPushMatrix();
         glTranslatef(0, 1.8f, 0);
-        glutSolidSphere(0.96f, 16, 16);
+        glutSolidSphere(0.96f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         glPopMatrix();
@@ -620,8 +710,7 @@ void drawBench(float x, float z, float rotation) {
     glTranslatef(x, 0, z);
     glRotatef(rotation, 0, 1, 0);
     
-    GLfloat benchColor[] = {0.5f, 0.3f, 0.15f, 1.0f};
-    //glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, benchColor);
+    glColor3f(0.5f, 0.3f, 0.15f);  // Wood brown
     
     // Seat
     glPushMatrix();
@@ -651,6 +740,14 @@ void drawBench(float x, float z, float rotation) {
     glPopMatrix();
 }
 
+// Floodlight head layout shared by the pole and its glow
+const float FLOODLIGHT_HEADS[4][2] = {
+    {-0.45f, 0.45f},   // Top-left
+    {0.45f, 0.45f},    // Top-right
+    {-0.45f, -0.45f},  // Bottom-left
+    {0.45f, -0.45f}    // Bottom-right
+};
+
 // Draw professional stadium floodlight (high-power, like football stadiums)
 void drawCourtFloodlight(float x, float z) {
     glPushMatrix();
@@ -671,7 +768,7 @@ void drawCourtFloodlight(float x, float z) {
     glTranslatef(0, 0.4f, 0);
     glRotatef(-90, 1, 0, 0);
     GLUquadric* pole = gluNewQuadric();
-    gluCylinder(pole, 0.18f, 0.14f, 9.6f, 20, 1);  // 10m pole
+    gluCylinder(pole, 0.18f, 0.14f, 9.6f, lodSlices(20), 1);  // 10m pole
     gluDeleteQuadric(pole);
     glPopMatrix();
     
@@ -686,17 +783,9 @@ void drawCourtFloodlight(float x, float z) {
     // === LIGHT HEADS (4 large stadium spotlights) ===
     bool lightsOn = (timeOfDay < 0.3f || timeOfDay > 0.7f);  // Night mode
     
-    // Floodlight positions (arranged in square pattern)
-    float lightPositions[][2] = {
-        {-0.45f, 0.45f},   // Top-left
-        {0.45f, 0.45f},    // Top-right
-        {-0.45f, -0.45f},  // Bottom-left
-        {0.45f, -0.45f}    // Bottom-right
-    };
-    
     for (int i = 0; i < 4; i++) {
         glPushMatrix();
-        glTranslatef(lightPositions[i][0], 10.0f, lightPositions[i][1]);
+        glTranslatef(FLOODLIGHT_HEADS[i][0], 10.0f, FLOODLIGHT_HEADS[i][1]);
         
         // === MOUNTING ARM ===
         glColor3f(0.15f, 0.15f, 0.15f);
@@ -738,43 +827,46 @@ void drawCourtFloodlight(float x, float z) {
         
         // Large circular lens
         glScalef(0.28f, 0.28f, 0.15f);
-        glutSolidSphere(1.0f, 16, 16);
+        glutSolidSphere(1.0f, lodSlices(16), lodSlices(16));
         glPopMatrix();
         
         // Reset emission after drawing
         GLfloat noEmission[] = {0.0f, 0.0f, 0.0f, 1.0f};
         glMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
         
-        // === LIGHT GLOW EFFECT (when ON) - Enhanced ===
-        if (lightsOn) {
-            // Enable blending for glow
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-            glDepthMask(GL_FALSE);
-            
-            glPushMatrix();
-            glTranslatef(0, -0.75f, 0.12f);
-            glRotatef(45, 1, 0, 0);
-            
-            // Inner bright glow
-            glColor4f(1.0f, 1.0f, 0.95f, 0.8f);
-            glScalef(0.32f, 0.32f, 0.18f);
-            glutSolidSphere(1.0f, 12, 12);
-            glPopMatrix();
-            
-            // Outer soft glow
-            glPushMatrix();
-            glTranslatef(0, -0.75f, 0.12f);
-            glRotatef(45, 1, 0, 0);
-            glColor4f(1.0f, 1.0f, 0.85f, 0.4f);
-            glScalef(0.45f, 0.45f, 0.25f);
-            glutSolidSphere(1.0f, 12, 12);
-            glPopMatrix();
-            
-            // Restore states
-            glDepthMask(GL_TRUE);
-            glDisable(GL_BLEND);
-        }
+        glPopMatrix();
+    }
+    
+    glPopMatrix();
+}
+
+// Draw the additive glow around the 4 floodlight heads (transparent pass, night only)
+void drawFloodlightGlow(float x, float z) {
+    glPushMatrix();
+    glTranslatef(x, 0, z);
+    
+    for (int i = 0; i < 4; i++) {
+        glPushMatrix();
+        glTranslatef(FLOODLIGHT_HEADS[i][0], 10.0f, FLOODLIGHT_HEADS[i][1]);
+        
+        glPushMatrix();
+        glTranslatef(0, -0.75f, 0.12f);
+        glRotatef(45, 1, 0, 0);
+        
+        // Inner bright glow
+        glColor4f(1.0f, 1.0f, 0.95f, 0.8f);
+        glScalef(0.32f, 0.32f, 0.18f);
+        glutSolidSphere(1.0f, lodSlices(12), lodSlices(12));
+        glPopMatrix();
+        
+        // Outer soft glow
+        glPushMatrix();
+        glTranslatef(0, -0.75f, 0.12f);
+        glRotatef(45, 1, 0, 0);
+        glColor4f(1.0f, 1.0f, 0.85f, 0.4f);
+        glScalef(0.45f, 0.45f, 0.25f);
+        glutSolidSphere(1.0f, lodSlices(12), lodSlices(12));
+        glPopMatrix();
         
         glPopMatrix();
     }
@@ -795,12 +887,12 @@ void drawStreetLamp(float x, float z, float rotation) {
     glPushMatrix();
     glRotatef(-90, 1, 0, 0);
     GLUquadric* quad = gluNewQuadric();
-    gluCylinder(quad, 0.1f, 0.08f, 5.0f, 16, 1);  // 5m height (smaller than floodlights)
+    gluCylinder(quad, 0.1f, 0.08f, 5.0f, lodSlices(16), 1);  // 5m height (smaller than floodlights)
     
     // Top cap ball
     glPushMatrix();
     glTranslatef(0, 0, 5.0f);
-    glutSolidSphere(0.12f, 12, 12);
+    glutSolidSphere(0.12f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     gluDeleteQuadric(quad);
@@ -828,7 +920,7 @@ void drawStreetLamp(float x, float z, float rotation) {
         glRotatef(-90, 0, 1, 0); // Cylinder along X
         
         GLUquadric* arm = gluNewQuadric();
-        gluCylinder(arm, 0.07f, 0.07f, armLen/segments, 8, 1);
+        gluCylinder(arm, 0.07f, 0.07f, armLen/segments, lodSlices(8), 1);
         gluDeleteQuadric(arm);
         glPopMatrix();
         
@@ -838,10 +930,6 @@ void drawStreetLamp(float x, float z, float rotation) {
         currentY += (armLen/segments) * sin(ang);
     }
     
-    // Save final arm position for light effect
-    float finalArmX = currentX;
-    float finalArmY = currentY;
-    
     // === 3. LAMP HEAD ===
     glTranslatef(currentX, currentY, 0);
     glRotatef(-10, 0, 0, 1); // Tilt head slightly down
@@ -878,58 +966,71 @@ void drawStreetLamp(float x, float z, float rotation) {
     
     glPopMatrix(); // End Arm/Head
     
-    // === 4. LIGHT CONE & GROUND SPOT (Visual Effect) ===
-    if (isNight) {
-        // Use actual arm position
-        float lightHeight = 4.5f + finalArmY;
-        
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
-        glDepthMask(GL_FALSE);
-        
-        // 4.1 Light Cone (Shaft) - pointing downward
-        glPushMatrix();
-        glTranslatef(finalArmX, 0, 0);
-        glRotatef(-90, 1, 0, 0); // Point down (cone apex down)
-        
-        // Transparent Yellow Cone
-        glColor4f(1.0f, 0.9f, 0.4f, 0.15f); 
-        glutSolidCone(1.8f, lightHeight, 16, 1); 
-        glPopMatrix();
-        
-        // 4.2 Light Spot on Ground (Track illumination)
-        glPushMatrix();
-        glTranslatef(finalArmX, 0.02f, 0); // Just above ground
-        
-        // Bright center spot
-        glColor4f(1.0f, 0.9f, 0.5f, 0.35f);
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex3f(0, 0, 0);
-        for(int i=0; i<=16; i++) {
-            float a = i * 2.0f * PI / 16.0f;
-            glVertex3f(cos(a)*1.2f, 0, sin(a)*1.2f);
-        }
-        glEnd();
-        
-        // Softer outer glow (Yellow)
-        glColor4f(1.0f, 0.85f, 0.3f, 0.2f);
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex3f(0, 0, 0);
-        for(int i=0; i<=16; i++) {
-            float a = i * 2.0f * PI / 16.0f;
-            glVertex3f(cos(a)*3.0f, 0, sin(a)*3.0f);
-        }
-        glEnd();
-        
-        glPopMatrix();
-        
-        glDepthMask(GL_TRUE);
-        glDisable(GL_BLEND);
-        
-        // Restore standard blending if needed elsewhere
-        glEnable(GL_BLEND); 
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glPopMatrix();
+}
+
+// Tip of the curved lamp arm relative to the pole base (arm starts 4.5m up)
+void getStreetLampArmEnd(float& armX, float& armY) {
+    float armLen = 1.5f;
+    float angleStep = 10.0f;
+    int segments = 4;
+    
+    armX = 0;
+    armY = 0;
+    for (int i = 0; i < segments; i++) {
+        float ang = (30.0f - i*angleStep) * PI / 180.0f;
+        armX += (armLen/segments) * cos(ang);
+        armY += (armLen/segments) * sin(ang);
+    }
+}
+
+// Draw the light cone and ground spot under a street lamp (transparent pass, night only)
+void drawStreetLampGlow(float x, float z, float rotation) {
+    float finalArmX, finalArmY;
+    getStreetLampArmEnd(finalArmX, finalArmY);
+    
+    glPushMatrix();
+    glTranslatef(x, 0, z);
+    glRotatef(rotation, 0, 1, 0);
+    
+    // Use actual arm position
+    float lightHeight = 4.5f + finalArmY;
+    
+    // 4.1 Light Cone (Shaft) - pointing downward
+    glPushMatrix();
+    glTranslatef(finalArmX, 0, 0);
+    glRotatef(-90, 1, 0, 0); // Point down (cone apex down)
+    
+    // Transparent Yellow Cone
+    glColor4f(1.0f, 0.9f, 0.4f, 0.15f); 
+    glutSolidCone(1.8f, lightHeight, lodSlices(16), 1); 
+    glPopMatrix();
+    
+    // 4.2 Light Spot on Ground (Track illumination)
+    glPushMatrix();
+    glTranslatef(finalArmX, 0.02f, 0); // Just above ground
+    
+    // Bright center spot
+    glColor4f(1.0f, 0.9f, 0.5f, 0.35f);
+    glBegin(GL_TRIANGLE_FAN);
+    glVertex3f(0, 0, 0);
+    for(int i=0; i<=16; i++) {
+        float a = i * 2.0f * PI / 16.0f;
+        glVertex3f(cos(a)*1.2f, 0, sin(a)*1.2f);
+    }
+    glEnd();
+    
+    // Softer outer glow (Yellow)
+    glColor4f(1.0f, 0.85f, 0.3f, 0.2f);
+    glBegin(GL_TRIANGLE_FAN);
+    glVertex3f(0, 0, 0);
+    for(int i=0; i<=16; i++) {
+        float a = i * 2.0f * PI / 16.0f;
+        glVertex3f(cos(a)*3.0f, 0, sin(a)*3.0f);
     }
+    glEnd();
+    
+    glPopMatrix();
     
     glPopMatrix();
 }
@@ -1003,14 +1104,14 @@ void drawOrnamentalFence(float x, float z, float rotation, float sectionWidth =
         glPushMatrix();
         glRotatef(-90, 1, 0, 0);
         GLUquadric* capCone = gluNewQuadric();
-        gluCylinder(capCone, postWidth * 0.7f, 0.0f, 0.3f, 8, 1);
+        gluCylinder(capCone, postWidth * 0.7f, 0.0f, 0.3f, lodSlices(8), 1);
         gluDeleteQuadric(capCone);
         glPopMatrix();
         
         // Decorative ball/sphere finial on top
         glTranslatef(0, 0.4f, 0);
         glColor3f(0.18f, 0.18f, 0.18f);
-        glutSolidSphere(0.12f, 12, 12);
+        glutSolidSphere(0.12f, lodSlices(12), lodSlices(12));
         
         glPopMatrix();
         glPopMatrix();
@@ -1063,7 +1164,7 @@ void drawOrnamentalFence(float x, float z, float rotation, float sectionWidth =
         glTranslatef(0, barHeight, 0);
         glRotatef(-90, 1, 0, 0);
         GLUquadric* spike = gluNewQuadric();
-        gluCylinder(spike, barThickness, 0.0f, 0.15f, 6, 1);
+        gluCylinder(spike, barThickness, 0.0f, 0.15f, lodSlices(6), 1);
         gluDeleteQuadric(spike);
         glPopMatrix();
         
@@ -1081,7 +1182,7 @@ void drawOrnamentalFence(float x, float z, float rotation, float sectionWidth =
         glPushMatrix();
         glTranslatef(decorX, 0, 0);
         glScalef(0.08f, 0.08f, 0.03f);
-        glutSolidSphere(1.0f, 8, 8);
+        glutSolidSphere(1.0f, lodSlices(8), lodSlices(8));
         glPopMatrix();
     }
     glPopMatrix();
@@ -1170,7 +1271,7 @@ void drawBush(float x, float z) {
     glPushMatrix();
     glTranslatef(x, 0, z);
     
-    float swayAngle = sin(windTime + x * 0.3f) * windStrength * 2.0f;
+    float swayAngle = sin(sim.windTime + x * 0.3f) * sim.windStrength * 2.0f;
     glRotatef(swayAngle, 0, 0, 1);
     
     // Dark green bush
@@ -1178,17 +1279,17 @@ void drawBush(float x, float z) {
     
     glPushMatrix();
     glTranslatef(0, 0.4f, 0);
-    glutSolidSphere(0.5f, 12, 12);
+    glutSolidSphere(0.5f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPushMatrix();
     glTranslatef(-0.2f, 0.3f, 0);
-    glutSolidSphere(0.35f, 12, 12);
+    glutSolidSphere(0.35f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPushMatrix();
     glTranslatef(0.2f, 0.3f, 0);
-    glutSolidSphere(0.35f, 12, 12);
+    glutSolidSphere(0.35f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPopMatrix();
@@ -1227,7 +1328,7 @@ void drawFlowers(float x, float z) {
         glColor3f(colors[colorIdx][0], colors[colorIdx][1], colors[colorIdx][2]);
         glPushMatrix();
         glTranslatef(0, 0.1f, 0);
-        glutSolidSphere(0.05f, 8, 8);
+        glutSolidSphere(0.05f, lodSlices(8), lodSlices(8));
         glPopMatrix();
         
         glPopMatrix();
@@ -1290,7 +1391,7 @@ void drawGardenBed(float x, float z, float width, float length) {
             glColor3f(colors[flowerType][0], colors[flowerType][1], colors[flowerType][2]);
             glPushMatrix();
             glTranslatef(fx, 0.16f, fz);
-            glutSolidSphere(0.06f, 8, 8);
+            glutSolidSphere(0.06f, lodSlices(8), lodSlices(8));
             glPopMatrix();
         }
     }
@@ -1334,7 +1435,7 @@ void drawCircularFlowerPatch(float x, float z, float radius) {
             glColor3f(colors[colorIdx][0], colors[colorIdx][1], colors[colorIdx][2]);
             glPushMatrix();
             glTranslatef(fx, 0.1f, fz);
-            glutSolidSphere(0.05f, 6, 6);
+            glutSolidSphere(0.05f, lodSlices(6), lodSlices(6));
             glPopMatrix();
         }
     }
@@ -1363,7 +1464,7 @@ void drawRockCluster(float x, float z) {
         glPushMatrix();
         glTranslatef(rockPositions[i][0], 0.08f, rockPositions[i][2]);
         glScalef(1.0f, 0.6f, 0.8f);
-        glutSolidSphere(0.15f - i * 0.02f, 8, 8);
+        glutSolidSphere(0.15f - i * 0.02f, lodSlices(8), lodSlices(8));
         glPopMatrix();
     }
     
@@ -1495,7 +1596,7 @@ void drawFountain(float x, float z) {
     glTranslatef(0, 0.75f, 0);
     glRotatef(-90, 1, 0, 0);
     GLUquadric* quad = gluNewQuadric();
-    gluCylinder(quad, 0.1f, 0.08f, 0.5f, 12, 1);
+    gluCylinder(quad, 0.1f, 0.08f, 0.5f, lodSlices(12), 1);
     gluDeleteQuadric(quad);
     glPopMatrix();
     
@@ -1508,7 +1609,7 @@ void drawFountain(float x, float z) {
     glPopMatrix();
     
     // Water jet (animated)
-    float jetHeight = 0.3f + 0.1f * sin(windTime * 3.0f);
+    float jetHeight = 0.3f + 0.1f * sin(sim.windTime * 3.0f);
     glPushMatrix();
     glTranslatef(0, 1.0f + jetHeight/2, 0);
     glScalef(0.05f, jetHeight, 0.05f);
@@ -1518,25 +1619,6 @@ void drawFountain(float x, float z) {
     glPopMatrix();
 }
 
-// Draw clouds
-void drawCloud(float x, float y, float z, float scale) {
-    glPushMatrix();
-    glTranslatef(x, y, z);
-    glScalef(scale, scale, scale);
-    
-    glColor4f(1.0f, 1.0f, 1.0f, 0.8f);  // White with transparency
-    
-    // Cloud is made of several spheres
-    for (int i = 0; i < 5; i++) {
-        glPushMatrix();
-        glTranslatef(-1.0f + i * 0.5f, sin(i * 0.8f) * 0.2f, 0);
-        glutSolidSphere(0.5f, 12, 12);
-        glPopMatrix();
-    }
-    
-    glPopMatrix();
-}
-
 // Draw Parabolic Arch Gate (White entrance gate)
 void drawArchGate(float x, float z) {
     glPushMatrix();
@@ -1826,9 +1908,6 @@ void drawPaddleFace(float width, float height, float thickness) {
 
 // Draw detailed realistic player with animations
 void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
-    // Draw shadow FIRST (before transforming player)
-    drawEllipticalShadow(x, z, 0.4f, 0.35f, 0.4f);
-    
     glPushMatrix();
     glTranslatef(x, state.jumpHeight, z);
     
@@ -1843,10 +1922,10 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     
     // Additional rotation to face ball (when hitting)
     if (isPlayer1) {
-        float ballDir = atan2(ballPosZ - z, ballPosX - x) * 180.0f / PI;
+        float ballDir = atan2(sim.ballPosZ - z, sim.ballPosX - x) * 180.0f / PI;
         glRotatef(ballDir - 90, 0, 1, 0);  // Turn toward ball
     } else {
-        float ballDir = atan2(ballPosZ - z, ballPosX - x) * 180.0f / PI;
+        float ballDir = atan2(sim.ballPosZ - z, sim.ballPosX - x) * 180.0f / PI;
         glRotatef(ballDir + 90, 0, 1, 0);  // Turn toward ball
     }
     
@@ -1874,7 +1953,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     glColor3f(0.85f, 0.7f, 0.6f);
     glPushMatrix();
     glTranslatef(0, -0.2f, 0);
-    glutSolidSphere(0.12f, 12, 12);
+    glutSolidSphere(0.12f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     // Lower leg
@@ -1910,7 +1989,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     //glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, skinColor);
     glPushMatrix();
     glTranslatef(0, -0.2f, 0);
-    glutSolidSphere(0.12f, 12, 12);
+    glutSolidSphere(0.12f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPushMatrix();
@@ -1951,18 +2030,18 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     glTranslatef(0, 1.95f, 0);
     
     // Face
-    glutSolidSphere(0.22f, 16, 16);
+    glutSolidSphere(0.22f, lodSlices(16), lodSlices(16));
     
     // Eyes
     GLfloat eyeColor[] = {0.1f, 0.1f, 0.1f, 1.0f};
     //glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, eyeColor);
     glPushMatrix();
     glTranslatef(-0.08f, 0.05f, 0.18f);
-    glutSolidSphere(0.03f, 8, 8);
+    glutSolidSphere(0.03f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     glPushMatrix();
     glTranslatef(0.08f, 0.05f, 0.18f);
-    glutSolidSphere(0.03f, 8, 8);
+    glutSolidSphere(0.03f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     
     // Hair
@@ -1971,7 +2050,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     glPushMatrix();
     glTranslatef(0, 0.15f, 0);
     glScalef(1.1f, 0.8f, 1.0f);
-    glutSolidSphere(0.22f, 12, 12);
+    glutSolidSphere(0.22f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPopMatrix(); // End head
@@ -1995,7 +2074,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     // Elbow
     glPushMatrix();
     glTranslatef(0, -0.18f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     // Forearm
@@ -2008,7 +2087,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     // Hand
     glPushMatrix();
     glTranslatef(0, -0.58f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     glPopMatrix(); // End left arm
@@ -2033,7 +2112,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     // Elbow
     glPushMatrix();
     glTranslatef(0, -0.18f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     // Forearm
@@ -2046,7 +2125,7 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
     // Hand
     glPushMatrix();
     glTranslatef(0, -0.58f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     
     // === ENHANCED REALISTIC PADDLE ===
     GLfloat paddleColor[] = {0.98f, 0.35f, 0.15f, 1.0f};  // Bright orange-red
@@ -2155,9 +2234,6 @@ void drawPlayer(float x, float z, PlayerState& state, bool isPlayer1) {
 
 // Draw a person walking/jogging on the track (similar to drawPlayer but without paddle)
 void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJogging) {
-    // Draw shadow FIRST
-    drawEllipticalShadow(x, z, 0.4f, 0.35f, 0.4f);
-    
     glPushMatrix();
     glTranslatef(x, 0, z);
     
@@ -2190,7 +2266,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     glColor3f(0.85f, 0.7f, 0.6f);
     glPushMatrix();
     glTranslatef(0, -0.2f, 0);
-    glutSolidSphere(0.12f, 12, 12);
+    glutSolidSphere(0.12f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     // Lower leg
@@ -2230,7 +2306,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     glColor3f(0.85f, 0.7f, 0.6f);
     glPushMatrix();
     glTranslatef(0, -0.2f, 0);
-    glutSolidSphere(0.12f, 12, 12);
+    glutSolidSphere(0.12f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPushMatrix();
@@ -2275,17 +2351,17 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     glTranslatef(0, 1.95f, 0);
     
     // Face
-    glutSolidSphere(0.22f, 16, 16);
+    glutSolidSphere(0.22f, lodSlices(16), lodSlices(16));
     
     // Eyes
     glColor3f(0.1f, 0.1f, 0.1f);
     glPushMatrix();
     glTranslatef(-0.08f, 0.05f, 0.18f);
-    glutSolidSphere(0.03f, 8, 8);
+    glutSolidSphere(0.03f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     glPushMatrix();
     glTranslatef(0.08f, 0.05f, 0.18f);
-    glutSolidSphere(0.03f, 8, 8);
+    glutSolidSphere(0.03f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     
     // Hair
@@ -2293,7 +2369,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     glPushMatrix();
     glTranslatef(0, 0.15f, 0);
     glScalef(1.1f, 0.8f, 1.0f);
-    glutSolidSphere(0.22f, 12, 12);
+    glutSolidSphere(0.22f, lodSlices(12), lodSlices(12));
     glPopMatrix();
     
     glPopMatrix(); // End head
@@ -2316,7 +2392,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     // Elbow
     glPushMatrix();
     glTranslatef(0, -0.18f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     // Forearm
@@ -2329,7 +2405,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     // Hand
     glPushMatrix();
     glTranslatef(0, -0.58f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     glPopMatrix(); // End left arm
@@ -2349,7 +2425,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     // Elbow
     glPushMatrix();
     glTranslatef(0, -0.18f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     // Forearm
@@ -2362,7 +2438,7 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
     // Hand
     glPushMatrix();
     glTranslatef(0, -0.58f, 0);
-    glutSolidSphere(0.08f, 10, 10);
+    glutSolidSphere(0.08f, lodSlices(10), lodSlices(10));
     glPopMatrix();
     
     glPopMatrix(); // End right arm
@@ -2372,9 +2448,6 @@ void drawWalker(float x, float z, WalkerState& state, bool isMale, bool isJoggin
 
 // Draw a dog (simple but recognizable)
 void drawDog(float x, float z, float angle) {
-    // Draw shadow
-    drawEllipticalShadow(x, z, 0.3f, 0.25f, 0.3f);
-    
     glPushMatrix();
     glTranslatef(x, 0, z);
     glRotatef(angle, 0, 1, 0);
@@ -2392,14 +2465,14 @@ void drawDog(float x, float z, float angle) {
     // === HEAD ===
     glPushMatrix();
     glTranslatef(0.3f, 0.4f, 0);
-    glutSolidSphere(0.15f, 12, 12);
+    glutSolidSphere(0.15f, lodSlices(12), lodSlices(12));
     
     // Snout
     glColor3f(0.5f, 0.3f, 0.15f);
     glPushMatrix();
     glTranslatef(0.12f, -0.02f, 0);
     glScalef(0.8f, 0.6f, 0.6f);
-    glutSolidSphere(0.1f, 8, 8);
+    glutSolidSphere(0.1f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     
     // Ears
@@ -2407,12 +2480,12 @@ void drawDog(float x, float z, float angle) {
     glPushMatrix();
     glTranslatef(-0.05f, 0.12f, -0.1f);
     glScalef(0.6f, 1.2f, 0.4f);
-    glutSolidSphere(0.08f, 8, 8);
+    glutSolidSphere(0.08f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     glPushMatrix();
     glTranslatef(-0.05f, 0.12f, 0.1f);
     glScalef(0.6f, 1.2f, 0.4f);
-    glutSolidSphere(0.08f, 8, 8);
+    glutSolidSphere(0.08f, lodSlices(8), lodSlices(8));
     glPopMatrix();
     
     glPopMatrix(); // End head
@@ -2696,66 +2769,81 @@ void drawRunningTrack() {
     glVertex3f(-outerX, 0.01f, outerZ);  // Top-left
     glEnd();
     
-    
-    // === STREET LAMPS along the track ===
-    // Place lamps close to the track edge
-    float lampMargin = trackOffset + trackWidth + 0.3f;  // Very close to track
-    
+    glPopMatrix();
+}
+
+// Street lamps along the track: {x, z, rotation}
+// Placed close to the track edge: trackOffset (9) + trackWidth (3) + 0.3m
+const float LAMP_TRACK_OFFSET = 9.0f;
+const float LAMP_MARGIN = 9.0f + 3.0f + 0.3f;
+const float STREET_LAMPS[][3] = {
     // Bottom side (-Z) - 4 lamps
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset, -COURT_WIDTH/2 - lampMargin, -90);
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset + 10.0f, -COURT_WIDTH/2 - lampMargin, -90);
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset + 28.0f, -COURT_WIDTH/2 - lampMargin, -90);
-    drawStreetLamp(COURT_LENGTH/2 + trackOffset, -COURT_WIDTH/2 - lampMargin, -90);
-    
-    // Top side (+Z) - 4 lamps
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset, COURT_WIDTH/2 + lampMargin, 90);
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset + 10.0f, COURT_WIDTH/2 + lampMargin, 90);
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset + 19.0f, COURT_WIDTH/2 + lampMargin, 90);
-    drawStreetLamp(-COURT_LENGTH/2 - trackOffset + 28.0f, COURT_WIDTH/2 + lampMargin, 90);
-    drawStreetLamp(COURT_LENGTH/2 + trackOffset, COURT_WIDTH/2 + lampMargin, 90);
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET, -COURT_WIDTH/2 - LAMP_MARGIN, -90},
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET + 10.0f, -COURT_WIDTH/2 - LAMP_MARGIN, -90},
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET + 28.0f, -COURT_WIDTH/2 - LAMP_MARGIN, -90},
+    {COURT_LENGTH/2 + LAMP_TRACK_OFFSET, -COURT_WIDTH/2 - LAMP_MARGIN, -90},
+    
+    // Top side (+Z) - 5 lamps
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET, COURT_WIDTH/2 + LAMP_MARGIN, 90},
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET + 10.0f, COURT_WIDTH/2 + LAMP_MARGIN, 90},
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET + 19.0f, COURT_WIDTH/2 + LAMP_MARGIN, 90},
+    {-COURT_LENGTH/2 - LAMP_TRACK_OFFSET + 28.0f, COURT_WIDTH/2 + LAMP_MARGIN, 90},
+    {COURT_LENGTH/2 + LAMP_TRACK_OFFSET, COURT_WIDTH/2 + LAMP_MARGIN, 90},
     
     // Left side (-X) - 2 lamps
-    drawStreetLamp(-COURT_LENGTH/2 - lampMargin, -COURT_WIDTH/2 - trackOffset + 8.0f, 0);
-    drawStreetLamp(-COURT_LENGTH/2 - lampMargin, -COURT_WIDTH/2 - trackOffset + 20.0f, 0);
+    {-COURT_LENGTH/2 - LAMP_MARGIN, -COURT_WIDTH/2 - LAMP_TRACK_OFFSET + 8.0f, 0},
+    {-COURT_LENGTH/2 - LAMP_MARGIN, -COURT_WIDTH/2 - LAMP_TRACK_OFFSET + 20.0f, 0},
     
     // Right side (+X) - 2 lamps
-    drawStreetLamp(COURT_LENGTH/2 + lampMargin, -COURT_WIDTH/2 - trackOffset + 8.0f, 180);
-    drawStreetLamp(COURT_LENGTH/2 + lampMargin, -COURT_WIDTH/2 - trackOffset + 20.0f, 180);
+    {COURT_LENGTH/2 + LAMP_MARGIN, -COURT_WIDTH/2 - LAMP_TRACK_OFFSET + 8.0f, 180},
+    {COURT_LENGTH/2 + LAMP_MARGIN, -COURT_WIDTH/2 - LAMP_TRACK_OFFSET + 20.0f, 180}
+};
+const int NUM_STREET_LAMPS = sizeof(STREET_LAMPS) / sizeof(STREET_LAMPS[0]);
+
+// Sun is only drawn during the day and above the horizon
+bool isSunVisible(float& sunX, float& sunY, float& sunZ) {
+    if (timeOfDay < 0.25f || timeOfDay > 0.75f) return false; // Only draw during day
+    
+    // Baked position from the day cycle table (updated by setupLighting)
+    sunX = currentLighting.sunPos[0];
+    sunY = currentLighting.sunPos[1];
+    sunZ = currentLighting.sunPos[2];
+    return sunY >= 0; // Sun is below horizon otherwise
+}
+
+// Draw the solid sun core (unlit, opaque)
+void drawSunCore() {
+    float sunX, sunY, sunZ;
+    if (!isSunVisible(sunX, sunY, sunZ)) return;
+    
+    glPushMatrix();
+    glTranslatef(sunX, sunY, sunZ);
     
+    // Sun core
+    glColor4f(1.0f, 1.0f, 0.8f, 1.0f);
+    glutSolidSphere(2.0f, lodSlices(20), lodSlices(20));
     
     glPopMatrix();
 }
 
-
-// Draw sun with rays for atmosphere
-void drawSun() {
-    if (timeOfDay < 0.25f || timeOfDay > 0.75f) return; // Only draw during day
-    
+// Draw sun glow and rays for atmosphere (unlit, transparent)
+void drawSunGlow() {
     float sunX, sunY, sunZ;
-    getSunPosition(timeOfDay, sunX, sunY, sunZ);
-    
-    if (sunY < 0) return; // Sun is below horizon
-    
-    glDisable(GL_LIGHTING);
+    if (!isSunVisible(sunX, sunY, sunZ)) return;
     
-    // Sun body
     glPushMatrix();
     glTranslatef(sunX, sunY, sunZ);
     
     // Sun glow
     glColor4f(1.0f, 0.95f, 0.7f, 0.3f);
-    glutSolidSphere(3.0f, 20, 20);
-    
-    // Sun core
-    glColor4f(1.0f, 1.0f, 0.8f, 1.0f);
-    glutSolidSphere(2.0f, 20, 20);
+    glutSolidSphere(3.0f, lodSlices(20), lodSlices(20));
     
     // Sun rays
     glColor4f(1.0f, 0.95f, 0.6f, 0.2f);
     for (int i = 0; i < 12; i++) {
         float angle = i * 30.0f;
         glPushMatrix();
-        glRotatef(angle + windTime * 10.0f, 0, 0, 1);
+        glRotatef(angle + sim.windTime * 10.0f, 0, 0, 1);
         glTranslatef(2.5f, 0, 0);
         glScalef(1.5f, 0.2f, 0.2f);
         glutSolidCube(1.0f);
@@ -2763,463 +2851,413 @@ void drawSun() {
     }
     
     glPopMatrix();
-    
-    glEnable(GL_LIGHTING);
 }
 
 // Draw the ball
 void drawBall() {
     glPushMatrix();
-    glTranslatef(ballPosX, ballPosY, ballPosZ);
+    glTranslatef(sim.ballPosX, sim.ballPosY, sim.ballPosZ);
     
-    GLfloat ballColor[] = {1.0f, 0.9f, 0.1f, 1.0f};
-    //glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, ballColor);
-    
-    glutSolidSphere(0.15f, 16, 16);
+    glColor3f(1.0f, 0.9f, 0.1f);  // Pickleball yellow
+    glutSolidSphere(0.15f, lodSlices(16), lodSlices(16));
     
     glPopMatrix();
 }
 
-// Calculate paddle position in world space
-void getPaddlePosition(PlayerState& state, bool isPlayer1, float& paddleX, float& paddleY, float& paddleZ) {
-    // Paddle is attached to right arm, extended forward
-    float armExtension = 0.6f;  // How far paddle extends from body
-    
-    if (isPlayer1) {
-        paddleX = state.posX + armExtension * cos(state.armSwing * PI / 180.0f);
-        paddleY = 1.2f + state.jumpHeight + 0.3f * sin(state.armSwing * PI / 180.0f);
-        paddleZ = state.posZ;
-    } else {
-        paddleX = state.posX - armExtension * cos(state.armSwing * PI / 180.0f);
-        paddleY = 1.2f + state.jumpHeight + 0.3f * sin(state.armSwing * PI / 180.0f);
-        paddleZ = state.posZ;
-    }
+// ============================================================================
+// FIXED-STEP LOOP - Interpolation between simulation ticks
+// ============================================================================
+
+SimulationState previousState;  // State at the second-to-last tick (sim holds the last)
+float simAccumulator = 0.0f;    // Real time not yet simulated (seconds)
+
+float lerpf(float a, float b, float t) {
+    return a + (b - a) * t;
 }
 
-// Check if ball hits paddle
-bool checkPaddleHit(float paddleX, float paddleY, float paddleZ) {
-    float dx = ballPosX - paddleX;
-    float dy = ballPosY - paddleY;
-    float dz = ballPosZ - paddleZ;
-    float distance = sqrt(dx*dx + dy*dy + dz*dz);
-    
-    const float PADDLE_RADIUS = 0.5f;  // Paddle hit zone
-    return distance < PADDLE_RADIUS;
+void blendPlayer(const PlayerState& a, const PlayerState& b, float t, PlayerState& out) {
+    out = b;
+    out.legAngle1 = lerpf(a.legAngle1, b.legAngle1, t);
+    out.legAngle2 = lerpf(a.legAngle2, b.legAngle2, t);
+    out.armSwing = lerpf(a.armSwing, b.armSwing, t);
+    out.bodyTilt = lerpf(a.bodyTilt, b.bodyTilt, t);
+    out.jumpHeight = lerpf(a.jumpHeight, b.jumpHeight, t);
+    out.posX = lerpf(a.posX, b.posX, t);
+    out.posZ = lerpf(a.posZ, b.posZ, t);
 }
 
-// Update ball physics - CONTINUOUS RALLY without going out of bounds
-void updateBall() {
-    if (isPaused) return;
-    
-    animationTime += 0.016f;
-    windTime += 0.02f * windStrength;
-    
-    // Ball physics with gravity
-    ballPosX += ballVelocityX;
-    ballPosY += ballVelocityY;
-    ballPosZ += ballVelocityZ;
-    ballVelocityY -= 0.008f;  // Gravity
-    
-    // === PLAYER MOVEMENT - Chase the ball intelligently ===
-    
-    // Player 1 movement (left side) - moves to intercept
-    if (ballVelocityX < 0) {  // Ball coming to player 1
-        player1State.targetX = ballPosX - 0.8f;  // Position to hit
-        player1State.targetZ = ballPosZ;         // Track ball Z
-        
-        // Keep in left side
-        if (player1State.targetX > -1.0f) player1State.targetX = -1.0f;
-        if (player1State.targetX < -COURT_LENGTH/2 + 0.5f) player1State.targetX = -COURT_LENGTH/2 + 0.5f;
-        if (abs(player1State.targetZ) > COURT_WIDTH/2 - 0.5f) {
-            player1State.targetZ = (player1State.targetZ > 0 ? 1 : -1) * (COURT_WIDTH/2 - 0.5f);
-        }
-    } else {
-        // Return to center ready position
-        player1State.targetX = -COURT_LENGTH/4;
-        player1State.targetZ = 0;
+// Blend two ticks. Discrete values (walker heading, track segment) come from the newer one.
+void blendStates(const SimulationState& a, const SimulationState& b, float t, SimulationState& out) {
+    out = b;
+    // A ball that jumped this tick (reset, wall save, paddle or net snap) is
+    // drawn where it landed rather than sliding across the court
+    if (a.ballTeleports == b.ballTeleports) {
+        out.ballPosX = lerpf(a.ballPosX, b.ballPosX, t);
+        out.ballPosY = lerpf(a.ballPosY, b.ballPosY, t);
+        out.ballPosZ = lerpf(a.ballPosZ, b.ballPosZ, t);
     }
-    
-    // Smooth movement
-    player1State.posX += (player1State.targetX - player1State.posX) * 0.12f;
-    player1State.posZ += (player1State.targetZ - player1State.posZ) * 0.12f;
-    
-    // Player 2 movement (right side)
-    if (ballVelocityX > 0) {  // Ball coming to player 2
-        player2State.targetX = ballPosX + 0.8f;
-        player2State.targetZ = ballPosZ;
-        
-        // Keep in right side
-        if (player2State.targetX < 1.0f) player2State.targetX = 1.0f;
-        if (player2State.targetX > COURT_LENGTH/2 - 0.5f) player2State.targetX = COURT_LENGTH/2 - 0.5f;
-        if (abs(player2State.targetZ) > COURT_WIDTH/2 - 0.5f) {
-            player2State.targetZ = (player2State.targetZ > 0 ? 1 : -1) * (COURT_WIDTH/2 - 0.5f);
-        }
-    } else {
-        player2State.targetX = COURT_LENGTH/4;
-        player2State.targetZ = 0;
+    blendPlayer(a.player1, b.player1, t, out.player1);
+    blendPlayer(a.player2, b.player2, t, out.player2);
+    for (int i = 0; i < 4; i++) {
+        out.walkers[i].posX = lerpf(a.walkers[i].posX, b.walkers[i].posX, t);
+        out.walkers[i].posZ = lerpf(a.walkers[i].posZ, b.walkers[i].posZ, t);
+        out.walkers[i].legAngle1 = lerpf(a.walkers[i].legAngle1, b.walkers[i].legAngle1, t);
+        out.walkers[i].legAngle2 = lerpf(a.walkers[i].legAngle2, b.walkers[i].legAngle2, t);
+        out.walkers[i].armSwing1 = lerpf(a.walkers[i].armSwing1, b.walkers[i].armSwing1, t);
+        out.walkers[i].armSwing2 = lerpf(a.walkers[i].armSwing2, b.walkers[i].armSwing2, t);
     }
-    
-    player2State.posX += (player2State.targetX - player2State.posX) * 0.12f;
-    player2State.posZ += (player2State.targetZ - player2State.posZ) * 0.12f;
-    
-    // === PADDLE COLLISION DETECTION ===
-    
-    float paddle1X, paddle1Y, paddle1Z;
-    float paddle2X, paddle2Y, paddle2Z;
-    getPaddlePosition(player1State, true, paddle1X, paddle1Y, paddle1Z);
-    getPaddlePosition(player2State, false, paddle2X, paddle2Y, paddle2Z);
-    
-    // Player 1 paddle hit (ball going left)
-    if (ballVelocityX < 0 && ballPosX < -0.5f && checkPaddleHit(paddle1X, paddle1Y, paddle1Z)) {
-        // HIT! Send to player 2 with proper arc
-        ballPosX = paddle1X + 0.5f;
-        ballVelocityX = 0.09f + (rand() % 20) * 0.001f;   // To player 2, slight variation
-        ballVelocityY = 0.18f + (rand() % 10) * 0.005f;  // Arc over net
-        ballVelocityZ = (rand() % 5 - 2) * 0.01f;        // Slight side angle
-        rallyCount++;
-        
-        // Swing animation
-        targetArmSwing1 = 70.0f;
-        player1State.jumpHeight = 0.2f;
-        player1State.bodyTilt = -15.0f;
-        
-        printf("✓ Player 1 HIT! Rally: %d\n", rallyCount);
-    }
-    
-    // Player 2 paddle hit (ball going right)
-    if (ballVelocityX > 0 && ballPosX > 0.5f && checkPaddleHit(paddle2X, paddle2Y, paddle2Z)) {
-        // HIT! Send to player 1 with proper arc
-        ballPosX = paddle2X - 0.5f;
-        ballVelocityX = -0.09f - (rand() % 20) * 0.001f;  // To player 1
-        ballVelocityY = 0.18f + (rand() % 10) * 0.005f;   // Arc over net
-        ballVelocityZ = (rand() % 5 - 2) * 0.01f;
-        rallyCount++;
-        
-        targetArmSwing2 = 70.0f;
-        player2State.jumpHeight = 0.2f;
-        player2State.bodyTilt = 15.0f;
-        
-        printf("✓ Player 2 HIT! Rally: %d\n", rallyCount);
-    }
-    
-    // === COURT BOUNDARIES - Keep ball in play! ===
-    
-    // Bounce on ground (with energy loss)
-    if (ballPosY < 0.15f && ballVelocityY < 0) {
-        ballPosY = 0.15f;
-        ballVelocityY = -ballVelocityY * 0.6f;  // Bouncy!
-    }
-    
-    // Net collision - if ball hits net, bounce it back gently
-    const float NET_HEIGHT = 0.914f;
-    if (abs(ballPosX) < 0.2f && ballPosY < NET_HEIGHT && ballPosY > 0) {
-        // Net hit! Bounce back
-        ballVelocityX *= -0.5f;
-        ballVelocityY = 0.12f;  // Pop up
-        ballPosX = (ballPosX > 0) ? 0.25f : -0.25f;
-        printf("⚠ Net hit! Rally continues...\n");
-    }
-    
-    // Side boundaries - bounce off sides to keep in play
-    if (abs(ballPosZ) > COURT_WIDTH/2 - 0.3f) {
-        float sign = (ballPosZ > 0) ? 1.0f : -1.0f;
-        ballPosZ = sign * (COURT_WIDTH/2 - 0.3f);
-        ballVelocityZ *= -0.8f;  // Bounce inward
-    }
-    
-    // PREVENT going out! If ball goes too far, auto-return it
-    if (ballPosX < -COURT_LENGTH/2) {
-        // Too far left - bounce back toward player 2
-        ballPosX = -COURT_LENGTH/2 + 0.3f;
-        ballVelocityX = abs(ballVelocityX) * 0.8f;  // Reverse direction
-        ballVelocityY = 0.15f;  // Pop up
-        printf("⚠ Ball bounced off back wall (left)\n");
-    }
-    
-    if (ballPosX > COURT_LENGTH/2) {
-        // Too far right - bounce back toward player 1
-        ballPosX = COURT_LENGTH/2 - 0.3f;
-        ballVelocityX = -abs(ballVelocityX) * 0.8f;  // Reverse direction
-        ballVelocityY = 0.15f;
-        printf("⚠ Ball bounced off back wall (right)\n");
-    }
-    
-    // If ball goes too high or too low (emergency reset)
-    if (ballPosY > 6.0f || ballPosY < -0.5f) {
-        printf("⚠ Emergency reset - ball too high/low\n");
-        // Gentle reset to current server
-        ballPosX = (currentServer == 1) ? -3.0f : 3.0f;
-        ballPosY = 1.5f;
-        ballPosZ = 0.0f;
-        ballVelocityX = (currentServer == 1) ? 0.08f : -0.08f;
-        ballVelocityY = 0.03f;
-        ballVelocityZ = 0.0f;
-        currentServer = (currentServer == 1) ? 2 : 1;  // Alternate
-    }
-    
-    // === SMOOTH ANIMATIONS ===
-    
-    // Arm swing decay
-    player1State.armSwing += (targetArmSwing1 - player1State.armSwing) * smoothFactor;
-    player2State.armSwing += (targetArmSwing2 - player2State.armSwing) * smoothFactor;
-    targetArmSwing1 *= 0.90f;  // Decay
-    targetArmSwing2 *= 0.90f;
-    
-    // Walking/running animation based on movement speed
-    float moveSpeed1 = sqrt(pow(player1State.posX - player1State.targetX, 2) + 
-                            pow(player1State.posZ - player1State.targetZ, 2));
-    float moveSpeed2 = sqrt(pow(player2State.posX - player2State.targetX, 2) + 
-                            pow(player2State.posZ - player2State.targetZ, 2));
-    
-    if (moveSpeed1 > 0.08f) {
-        // Running!
-        player1State.legAngle1 = sin(animationTime * 20.0f) * 35.0f;
-        player1State.legAngle2 = -player1State.legAngle1;
-    } else if (moveSpeed1 > 0.03f) {
-        // Walking
-        player1State.legAngle1 = sin(animationTime * 12.0f) * 20.0f;
-        player1State.legAngle2 = -player1State.legAngle1;
-    } else {
-        // Idle stance
-        player1State.legAngle1 = sin(animationTime * 2.0f) * 5.0f;
-        player1State.legAngle2 = -player1State.legAngle1 * 0.5f;
+    out.dogPosX = lerpf(a.dogPosX, b.dogPosX, t);
+    out.dogPosZ = lerpf(a.dogPosZ, b.dogPosZ, t);
+    out.windTime = lerpf(a.windTime, b.windTime, t);
+    out.animationTime = lerpf(a.animationTime, b.animationTime, t);
+}
+
+// ============================================================================
+// REPLAY - Record inputs per tick, play them back deterministically
+// ============================================================================
+
+ReplayRecorder replayRecorder;
+ReplayPlayer replayPlayer;
+bool replayMode = false;               // Inputs come from replayPlayer, not the keyboard
+bool replayDesyncReported = false;
+const int REPLAY_KEYFRAME_INTERVAL = 120;   // Ticks between keyframes (2 s at 60 Hz)
+const int REPLAY_VIEW_WORDS = 4;            // Camera distance/angle/height, time of day
+const float REPLAY_SEEK_SECONDS = 10.0f;    // [ and ] in replay mode
+
+void applyKey(unsigned char key);
+void applySpecialKey(int key);
+
+// Render-side state stored with each keyframe (needed when seeking)
+void packView(uint32_t* view) {
+    float values[REPLAY_VIEW_WORDS] = {cameraDistance, cameraAngle, cameraHeight, timeOfDay};
+    memcpy(view, values, sizeof(values));
+}
+
+void unpackView(const uint32_t* view) {
+    float values[REPLAY_VIEW_WORDS];
+    memcpy(values, view, sizeof(values));
+    cameraDistance = values[0];
+    cameraAngle = values[1];
+    cameraHeight = values[2];
+    timeOfDay = values[3];
+}
+
+void recordReplayKeyframe() {
+    uint32_t state[SIM_STATE_WORDS];
+    uint32_t view[REPLAY_VIEW_WORDS];
+    packSimulationState(sim, state);
+    packView(view);
+    replayRecorder.recordKeyframe(sim.tick, state, view);
+}
+
+// Final keyframe marks the end of the log (also runs on ESC / exit())
+void stopRecording() {
+    if (!replayRecorder.isRecording()) return;
+    recordReplayKeyframe();
+    replayRecorder.stop();
+}
+
+// Inputs logged for the tick about to be simulated
+void applyReplayInputs() {
+    ReplayInput input;
+    while (replayPlayer.nextInput(sim.tick, input)) {
+        if (input.type == REPLAY_KEY) applyKey((unsigned char)input.code);
+        else applySpecialKey(input.code);
     }
-    
-    if (moveSpeed2 > 0.08f) {
-        player2State.legAngle1 = sin(animationTime * 20.0f) * 35.0f;
-        player2State.legAngle2 = -player2State.legAngle1;
-    } else if (moveSpeed2 > 0.03f) {
-        player2State.legAngle1 = sin(animationTime * 12.0f) * 20.0f;
-        player2State.legAngle2 = -player2State.legAngle1;
-    } else {
-        player2State.legAngle1 = sin(animationTime * 2.0f) * 5.0f;
-        player2State.legAngle2 = -player2State.legAngle1 * 0.5f;
+}
+
+// Compare against the recorded keyframe - any difference means the build
+// or platform does not reproduce the recording bit for bit
+void checkReplayKeyframe() {
+    const ReplayKeyframe* keyframe = replayPlayer.keyframeAt(sim.tick);
+    if (!keyframe || replayDesyncReported) return;
+    uint32_t state[SIM_STATE_WORDS];
+    packSimulationState(sim, state);
+    if (memcmp(state, &keyframe->words[0], sizeof(state)) != 0) {
+        printf("Replay diverged from the recording at tick %lld\n", sim.tick);
+        replayDesyncReported = true;
     }
-    
-    // Decay jump and body tilt smoothly
-    player1State.bodyTilt *= 0.85f;
-    player1State.jumpHeight *= 0.85f;
-    player2State.bodyTilt *= 0.85f;
-    player2State.jumpHeight *= 0.85f;
 }
 
-// Update walker positions and animations along the running track
-void updateWalkers() {
-    if (isPaused) return;
-    
-    // Track parameters (matching drawRunningTrack)
-    float trackOffset = 9.0f;
-    float trackWidth = 3.0f;
-    float trackMiddle = trackOffset + trackWidth / 2.0f; // Middle of track = 10.5f
-    
-    // Track dimensions
-    float trackHalfLength = COURT_LENGTH/2 + trackMiddle;
-    float trackHalfWidth = COURT_WIDTH/2 + trackMiddle;
-    
-    // Update each walker
-    WalkerState* walkers[] = {&walker1, &walker2, &walker3, &walker4};
-    bool isJogging[] = {false, false, false, false}; // All walkers walk at same pace
-    
-    for (int i = 0; i < 4; i++) {
-        WalkerState* w = walkers[i];
-        float walkSpeed = w->speed;
-        
-        // Update leg and arm animations (walking/jogging motion)
-        float animSpeed = isJogging[i] ? 15.0f : 10.0f;
-        float legAngleMax = isJogging[i] ? 40.0f : 25.0f;
-        float armAngleMax = isJogging[i] ? 30.0f : 20.0f;
-        
-        w->legAngle1 = sin(animationTime * animSpeed) * legAngleMax;
-        w->legAngle2 = -w->legAngle1; // Opposite leg
-        w->armSwing1 = sin(animationTime * animSpeed) * armAngleMax;
-        w->armSwing2 = -w->armSwing1; // Opposite arm
-        
-        // Move walker along track
-        // Track segments: 0=bottom, 1=right, 2=top, 3=left
-        switch(w->pathSegment) {
-            case 0: // Bottom segment (moving right, +X direction)
-                w->posX += walkSpeed;
-                w->angle = 90;
-                if (w->posX >= trackHalfLength) {
-                    w->pathSegment = 1;
-                    w->posX = trackHalfLength;
-                }
-                break;
-                
-            case 1: // Right segment (moving up, +Z direction)
-                w->posZ += walkSpeed;
-                w->angle = 0;
-                if (w->posZ >= trackHalfWidth) {
-                    w->pathSegment = 2;
-                    w->posZ = trackHalfWidth;
-                }
-                break;
-                
-            case 2: // Top segment (moving left, -X direction)
-                w->posX -= walkSpeed;
-                w->angle = 270;
-                if (w->posX <= -trackHalfLength) {
-                    w->pathSegment = 3;
-                    w->posX = -trackHalfLength;
-                }
-                break;
-                
-            case 3: // Left segment (moving down, -Z direction)
-                w->posZ -= walkSpeed;
-                w->angle = 180;
-                if (w->posZ <= -trackHalfWidth) {
-                    w->pathSegment = 0;
-                    w->posZ = -trackHalfWidth;
-                }
+// Restore the nearest keyframe and simulate forward to the exact tick
+void seekReplay(long long targetTick) {
+    if (targetTick < 0) targetTick = 0;
+    if (targetTick > replayPlayer.lastTick()) targetTick = replayPlayer.lastTick();
+    const ReplayKeyframe* keyframe = replayPlayer.seek(targetTick);
+    unpackSimulationState(&keyframe->words[0], sim);
+    unpackView(&keyframe->words[SIM_STATE_WORDS]);
+    
+    // Skipped-over ticks post no events
+    RallyEventQueue* events = sim.events;
+    sim.events = NULL;
+    float dt = 1.0f / simTickRate;
+    while (sim.tick < targetTick) {
+        applyReplayInputs();
+        stepSimulationTick(sim, dt);
+    }
+    sim.events = events;
+    previousState = sim;
+    simAccumulator = 0.0f;
+    printf("Replay: tick %lld / %lld\n", sim.tick, replayPlayer.lastTick());
+}
+
+// Run as many fixed ticks as the elapsed real time covers
+void stepSimulation(float frameTime) {
+    if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+    if (frameTime < 0.0f) frameTime = 0.0f;
+    simAccumulator += frameTime;
+    
+    float dt = 1.0f / simTickRate;
+    while (simAccumulator >= dt) {
+        if (replayMode) {
+            if (sim.tick >= replayPlayer.lastTick()) {   // End of the log: hold the last frame
+                simAccumulator = 0.0f;
+                previousState = sim;
                 break;
+            }
+            applyReplayInputs();
         }
+        previousState = sim;
+        stepSimulationTick(sim, dt);
+        simAccumulator -= dt;
+        
+        if (replayMode) checkReplayKeyframe();
+        else if (replayRecorder.isRecording() && sim.tick % REPLAY_KEYFRAME_INTERVAL == 0) recordReplayKeyframe();
     }
-    
-    // Keep walker2 and walker3 walking side-by-side (parallel formation)
-    // Walker2 moves freely, walker3 follows with perpendicular offset
-    float coupleOffset = 0.5f; // Distance between the two people
-    
-    // Sync their segment and angle
-    walker3.pathSegment = walker2.pathSegment;
-    walker3.angle = walker2.angle;
-    
-    // Position walker3 relative to walker2 with perpendicular offset
-    switch(walker2.pathSegment) {
-        case 0: // Bottom segment - walking along +X direction
-            walker3.posX = walker2.posX; // Same X (forward) position
-            walker3.posZ = walker2.posZ + coupleOffset; // Offset to the side
-            break;
-            
-        case 1: // Right segment - walking along +Z direction
-            walker3.posZ = walker2.posZ; // Same Z (forward) position
-            walker3.posX = walker2.posX + coupleOffset; // Offset to the side
-            break;
-            
-        case 2: // Top segment - walking along -X direction
-            walker3.posX = walker2.posX; // Same X (forward) position
-            walker3.posZ = walker2.posZ - coupleOffset; // Offset to the side (opposite)
-            break;
-            
-        case 3: // Left segment - walking along -Z direction
-            walker3.posZ = walker2.posZ; // Same Z (forward) position
-            walker3.posX = walker2.posX - coupleOffset; // Offset to the side (opposite)
-            break;
+}
+
+// ============================================================================
+// RENDER QUEUE - Scene submission
+// ============================================================================
+
+// Sorted draw queue for the whole scene (see RenderQueue.h)
+RenderQueue renderQueue;
+
+// Frame timings, shown with the P key (see FrameProfiler.h)
+FrameProfiler profiler;
+
+// Time-of-day dependent parts of the static scene (bitmask)
+const int SCENE_DAYTIME = 1;      // 0.3 - 0.7: floodlights off, full cloud cover
+const int SCENE_SUN_UP = 2;       // (0.25, 0.75): extra daytime clouds
+const int SCENE_LAMPS_ON = 4;     // < 0.25 or > 0.75: street lamp glow
+int staticSceneVariant = -1;      // Variant the static items were built for
+
+// All ground shadows go through one batch (see GraphicsUtils_v2.h)
+ShadowDecalBatch shadowBatch;
+
+// Blob shadows of static scenery, collected when the static scene is built
+struct ShadowCaster {
+    float x, z;
+    float radiusX, radiusZ;
+    float opacity;
+    float rotation;
+};
+std::vector<ShadowCaster> staticShadows;
+
+void addStaticShadow(float x, float z, float radiusX, float radiusZ, float opacity, float rotation = 0.0f) {
+    ShadowCaster caster = {x, z, radiusX, radiusZ, opacity, rotation};
+    staticShadows.push_back(caster);
+}
+
+int getSceneVariant() {
+    int variant = 0;
+    if (timeOfDay >= 0.3f && timeOfDay <= 0.7f) variant |= SCENE_DAYTIME;
+    if (timeOfDay > 0.25f && timeOfDay < 0.75f) variant |= SCENE_SUN_UP;
+    if (timeOfDay < 0.25f || timeOfDay > 0.75f) variant |= SCENE_LAMPS_ON;
+    return variant;
+}
+
+// Static scenery helpers - position is the sort point, color the dominant material
+void queueStatic(float x, float y, float z, float r, float g, float b, std::function<void()> draw) {
+    renderQueue.submitStatic(makeOpaqueItem(x, y, z, r, g, b, draw));
+}
+
+void queueFence(float x, float z, float rotation) {
+    renderQueue.setZone("Fences");
+    queueStatic(x, 0.5f, z, 0.6f, 0.4f, 0.2f, [=]() { drawFence(x, z, rotation); });
+}
+
+void queueTree(float x, float z) {
+    renderQueue.setZone("Trees");
+    queueStatic(x, 2.5f, z, 0.2f, 0.6f, 0.2f, [=]() { drawTree(x, z); });
+    addStaticShadow(x, z, 1.4f, 1.4f, 0.3f);
+}
+
+void queueSmallTree(float x, float z) {
+    renderQueue.setZone("Trees");
+    queueStatic(x, 1.5f, z, 0.2f, 0.6f, 0.2f, [=]() { drawSmallTree(x, z); });
+    addStaticShadow(x, z, 0.84f, 0.84f, 0.3f);
+}
+
+void queueMediumTree(float x, float z) {
+    renderQueue.setZone("Trees");
+    queueStatic(x, 2.0f, z, 0.2f, 0.6f, 0.2f, [=]() { drawMediumTree(x, z); });
+    addStaticShadow(x, z, 1.12f, 1.12f, 0.3f);
+}
+
+void queueLargeTree(float x, float z) {
+    renderQueue.setZone("Trees");
+    queueStatic(x, 3.0f, z, 0.2f, 0.6f, 0.2f, [=]() { drawLargeTree(x, z); });
+    addStaticShadow(x, z, 1.68f, 1.68f, 0.3f);
+}
+
+void queueBush(float x, float z) {
+    renderQueue.setZone("Bushes");
+    queueStatic(x, 0.4f, z, 0.2f, 0.5f, 0.2f, [=]() { drawBush(x, z); });
+}
+
+void queueFlowers(float x, float z) {
+    renderQueue.setZone("Flowers");
+    queueStatic(x, 0.2f, z, 0.2f, 0.6f, 0.2f, [=]() { drawFlowers(x, z); });
+}
+
+void queueBench(float x, float z, float rotation) {
+    renderQueue.setZone("Benches");
+    queueStatic(x, 0.5f, z, 0.5f, 0.3f, 0.15f, [=]() { drawBench(x, z, rotation); });
+    addStaticShadow(x, z, 0.8f, 0.35f, 0.3f, rotation);
+}
+
+// Pole is opaque; the head glow goes to the transparent pass at night
+void queueCourtFloodlight(float x, float z) {
+    renderQueue.setZone("Floodlights");
+    queueStatic(x, 5.0f, z, 0.4f, 0.4f, 0.4f, [=]() { drawCourtFloodlight(x, z); });
+    if (!(staticSceneVariant & SCENE_DAYTIME)) {
+        renderQueue.submitStatic(makeTransparentItem(x, 9.3f, z, BLEND_ADDITIVE,
+                                                     [=]() { drawFloodlightGlow(x, z); }));
     }
-    
-    // Update dog position to follow walker1 (person with dog)
-    // Dog walks slightly behind and to the side
-    float dogOffsetDistance = 1.5f;
-    float angleRad = (walker1.angle - 45) * PI / 180.0f; // 45 degrees offset
-    dogPosX = walker1.posX - cos(angleRad) * dogOffsetDistance;
-    dogPosZ = walker1.posZ - sin(angleRad) * dogOffsetDistance;
-    dogAngle = walker1.angle - 90.0f; // Correct orientation: Dog faces movement direction
 }
 
-// Display function
-void display() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    
-    // Set sky color - BRIGHT SKY BLUE!
-    glClearColor(0.53f, 0.81f, 0.92f, 1.0f);  // Sky blue!
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Camera position - Look at center of court
-    float camX = cameraDistance * cos(cameraAngle * PI / 180.0f);
-    float camZ = cameraDistance * sin(cameraAngle * PI / 180.0f);
-    gluLookAt(camX, cameraHeight, camZ,  // Camera position
-              0, 0, 0,                    // Look at center of court (FIXED!)
-              0, 1, 0);                   // Up vector
-    
-    // Update lighting based on time of day - CRITICAL!
-    setupLighting();
-    
-    // Draw scene elements
-    drawGrassField();  // Draw grass first (background)
-    drawRunningTrack(); // Draw running track around the court
-    drawPerimeterFence(); // Draw ornamental iron fence around entire map
-    drawSun();         // Draw sun with rays
-    
-    // === CLOUDS - Floating in the sky ===
-    // Daytime: All clouds visible
-    // Nighttime: Fewer clouds (only high and some medium clouds)
-    bool isDaytime = (timeOfDay >= 0.3f && timeOfDay <= 0.7f);
-    
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void queueStreetLamp(float x, float z, float rotation) {
+    renderQueue.setZone("Street lamps");
+    queueStatic(x, 2.5f, z, 0.7f, 0.75f, 0.8f, [=]() { drawStreetLamp(x, z, rotation); });
+    if (staticSceneVariant & SCENE_LAMPS_ON) {
+        renderQueue.submitStatic(makeTransparentItem(x, 2.5f, z, BLEND_ADDITIVE,
+                                                     [=]() { drawStreetLampGlow(x, z, rotation); }));
+    }
+}
+
+void queueTrashBin(float x, float z) {
+    renderQueue.setZone("Props");
+    queueStatic(x, 0.4f, z, 0.3f, 0.3f, 0.3f, [=]() { drawTrashBin(x, z); });
+}
+
+void queueSignpost(float x, float z, const char* text) {
+    renderQueue.setZone("Props");
+    queueStatic(x, 1.0f, z, 0.4f, 0.3f, 0.2f, [=]() { drawSignpost(x, z, text); });
+}
+
+void queuePicnicTable(float x, float z, float rotation) {
+    renderQueue.setZone("Props");
+    queueStatic(x, 0.5f, z, 0.55f, 0.35f, 0.2f, [=]() { drawPicnicTable(x, z, rotation); });
+}
+
+void queueRockCluster(float x, float z) {
+    renderQueue.setZone("Props");
+    queueStatic(x, 0.1f, z, 0.5f, 0.5f, 0.5f, [=]() { drawRockCluster(x, z); });
+}
+
+void queueArchGate(float x, float z) {
+    renderQueue.setZone("Props");
+    queueStatic(x, 3.0f, z, 1.0f, 1.0f, 1.0f, [=]() { drawArchGate(x, z); });
+}
+
+// Sky clouds drawn as one batch of billboards (see CloudLayer.h)
+CloudLayer skyClouds;
+
+// Fill the cloud layer once; visibility follows the scene variant flags
+void setupClouds() {
+    skyClouds.clear();
     
     // === HIGH CLOUDS (25-30m) - Always visible (day and night) ===
-    drawCloud(0.0f, 28.0f, -15.0f, 1.8f);
-    drawCloud(-5.0f, 30.0f, 15.0f, 1.0f);
-    drawCloud(5.0f, 29.0f, 8.0f, 1.6f);
-    drawCloud(-18.0f, 27.0f, -12.0f, 1.3f);
-    drawCloud(22.0f, 30.0f, 5.0f, 1.1f);
-    drawCloud(-28.0f, 28.0f, 18.0f, 1.4f);
-    drawCloud(12.0f, 29.0f, -18.0f, 1.2f);
-    
-    if (isDaytime) {
-        // === DAYTIME: Show all medium and low clouds ===
-        
-        // MEDIUM CLOUDS (18-24m)
-        drawCloud(-15.0f, 20.0f, -10.0f, 1.2f);
-        drawCloud(10.0f, 22.0f, -5.0f, 1.5f);
-        drawCloud(20.0f, 18.0f, 10.0f, 1.3f);
-        drawCloud(-20.0f, 21.0f, 5.0f, 1.1f);
-        drawCloud(15.0f, 24.0f, -20.0f, 1.4f);
-        drawCloud(-10.0f, 19.0f, 20.0f, 1.0f);
-        drawCloud(-25.0f, 23.0f, -8.0f, 1.2f);
-        drawCloud(8.0f, 20.0f, 12.0f, 1.7f);
-        drawCloud(-12.0f, 22.0f, -15.0f, 1.3f);
-        drawCloud(25.0f, 21.0f, -3.0f, 1.5f);
-        drawCloud(-8.0f, 24.0f, 22.0f, 1.0f);
-        
-        // LOW CLOUDS (12-17m)
-        drawCloud(-18.0f, 14.0f, -8.0f, 2.0f);
-        drawCloud(14.0f, 13.0f, -12.0f, 1.8f);
-        drawCloud(-6.0f, 15.0f, 18.0f, 1.9f);
-        drawCloud(18.0f, 12.0f, 6.0f, 2.2f);
-        drawCloud(-22.0f, 16.0f, 12.0f, 1.7f);
-        drawCloud(6.0f, 14.0f, -18.0f, 2.1f);
-        drawCloud(-14.0f, 17.0f, -5.0f, 1.6f);
-        drawCloud(22.0f, 15.0f, -15.0f, 1.9f);
-        drawCloud(-3.0f, 13.0f, 10.0f, 2.3f);
-        drawCloud(10.0f, 16.0f, 16.0f, 1.8f);
-        drawCloud(-26.0f, 14.0f, -18.0f, 2.0f);
-        drawCloud(26.0f, 13.0f, 8.0f, 1.7f);
-        drawCloud(0.0f, 15.0f, -22.0f, 2.4f);
-        drawCloud(-10.0f, 12.0f, -12.0f, 2.1f);
+    skyClouds.add(0.0f, 28.0f, -15.0f, 1.8f);
+    skyClouds.add(-5.0f, 30.0f, 15.0f, 1.0f);
+    skyClouds.add(5.0f, 29.0f, 8.0f, 1.6f);
+    skyClouds.add(-18.0f, 27.0f, -12.0f, 1.3f);
+    skyClouds.add(22.0f, 30.0f, 5.0f, 1.1f);
+    skyClouds.add(-28.0f, 28.0f, 18.0f, 1.4f);
+    skyClouds.add(12.0f, 29.0f, -18.0f, 1.2f);
+    
+    // === MEDIUM CLOUDS (18-24m) - Some stay visible at night ===
+    skyClouds.add(-15.0f, 20.0f, -10.0f, 1.2f);
+    skyClouds.add(10.0f, 22.0f, -5.0f, 1.5f, SCENE_DAYTIME);
+    skyClouds.add(20.0f, 18.0f, 10.0f, 1.3f);
+    skyClouds.add(-20.0f, 21.0f, 5.0f, 1.1f, SCENE_DAYTIME);
+    skyClouds.add(15.0f, 24.0f, -20.0f, 1.4f);
+    skyClouds.add(-10.0f, 19.0f, 20.0f, 1.0f, SCENE_DAYTIME);
+    skyClouds.add(-25.0f, 23.0f, -8.0f, 1.2f);
+    skyClouds.add(8.0f, 20.0f, 12.0f, 1.7f, SCENE_DAYTIME);
+    skyClouds.add(-12.0f, 22.0f, -15.0f, 1.3f, SCENE_DAYTIME);
+    skyClouds.add(25.0f, 21.0f, -3.0f, 1.5f);
+    skyClouds.add(-8.0f, 24.0f, 22.0f, 1.0f, SCENE_DAYTIME);
+    
+    // === LOW CLOUDS (12-17m) - Daytime only ===
+    skyClouds.add(-18.0f, 14.0f, -8.0f, 2.0f, SCENE_DAYTIME);
+    skyClouds.add(14.0f, 13.0f, -12.0f, 1.8f, SCENE_DAYTIME);
+    skyClouds.add(-6.0f, 15.0f, 18.0f, 1.9f, SCENE_DAYTIME);
+    skyClouds.add(18.0f, 12.0f, 6.0f, 2.2f, SCENE_DAYTIME);
+    skyClouds.add(-22.0f, 16.0f, 12.0f, 1.7f, SCENE_DAYTIME);
+    skyClouds.add(6.0f, 14.0f, -18.0f, 2.1f, SCENE_DAYTIME);
+    skyClouds.add(-14.0f, 17.0f, -5.0f, 1.6f, SCENE_DAYTIME);
+    skyClouds.add(22.0f, 15.0f, -15.0f, 1.9f, SCENE_DAYTIME);
+    skyClouds.add(-3.0f, 13.0f, 10.0f, 2.3f, SCENE_DAYTIME);
+    skyClouds.add(10.0f, 16.0f, 16.0f, 1.8f, SCENE_DAYTIME);
+    skyClouds.add(-26.0f, 14.0f, -18.0f, 2.0f, SCENE_DAYTIME);
+    skyClouds.add(26.0f, 13.0f, 8.0f, 1.7f, SCENE_DAYTIME);
+    skyClouds.add(0.0f, 15.0f, -22.0f, 2.4f, SCENE_DAYTIME);
+    skyClouds.add(-10.0f, 12.0f, -12.0f, 2.1f, SCENE_DAYTIME);
+    
+    // === CLOUDS - Fluffy sky decoration (while the sun is up) ===
+    skyClouds.add(-15, 20, -10, 1.5f, SCENE_SUN_UP);
+    skyClouds.add(15, 22, 5, 1.2f, SCENE_SUN_UP);
+    skyClouds.add(0, 25, -15, 1.8f, SCENE_SUN_UP);
+    skyClouds.add(-8, 18, 10, 1.0f, SCENE_SUN_UP);
+    skyClouds.add(12, 21, -5, 1.3f, SCENE_SUN_UP);
+    skyClouds.add(-20, 19, 8, 1.4f, SCENE_SUN_UP);
+    skyClouds.add(18, 23, -12, 1.1f, SCENE_SUN_UP);
+    skyClouds.add(-5, 24, 12, 1.6f, SCENE_SUN_UP);
+    skyClouds.add(8, 17, -8, 0.9f, SCENE_SUN_UP);
+    skyClouds.add(-12, 21, 3, 1.0f, SCENE_SUN_UP);
+}
+
+// Cloud color follows the scene lighting (same levels as setupLighting)
+void updateCloudTint() {
+    if (timeOfDay < 0.3f || timeOfDay > 0.7f) {
+        skyClouds.setTint(0.15f, 0.15f, 0.2f);   // Night: barely lit
+    } else if (timeOfDay < 0.35f || timeOfDay > 0.65f) {
+        skyClouds.setTint(1.0f, 0.9f, 0.8f);     // Dawn/Dusk: warm
     } else {
-        // === NIGHTTIME: Show only some medium clouds (fewer) ===
-        drawCloud(-15.0f, 20.0f, -10.0f, 1.2f);
-        drawCloud(20.0f, 18.0f, 10.0f, 1.3f);
-        drawCloud(15.0f, 24.0f, -20.0f, 1.4f);
-        drawCloud(-25.0f, 23.0f, -8.0f, 1.2f);
-        drawCloud(25.0f, 21.0f, -3.0f, 1.5f);
+        skyClouds.setTint(1.0f, 1.0f, 1.0f);     // Full daylight
     }
-    
-    glDisable(GL_BLEND);
-    
-    drawCourt();
-    drawNet();
-    drawBall();
+}
 
+// Rebuild everything that does not move. Only needed when the
+// time-of-day variant changes (lamp and floodlight glow).
+void buildStaticScene(int variant) {
+    renderQueue.clearStatic();
+    staticShadows.clear();
+    staticSceneVariant = variant;
+    
+    // Ground layers share the same plane - keep them in one item so
+    // grass, track and court are still drawn in this order
+    renderQueue.setZone("Ground");
+    queueStatic(0, 0, 0, 0.3f, 0.6f, 0.3f, []() {
+        drawGrassField();    // Draw grass first (background)
+        drawRunningTrack();  // Draw running track around the court
+        drawCourt();
+    });
     
-    // Draw players using DYNAMIC POSITIONS
-    drawPlayer(player1State.posX, player1State.posZ, player1State, true);   
-    drawPlayer(player2State.posX, player2State.posZ, player2State, false);
-    
-    // === WALKERS ON RUNNING TRACK - People enjoying the park ===
-    // Walker 1: Person with dog (male, walking)
-    drawWalker(walker1.posX, walker1.posZ, walker1, true, false);
-    drawDog(dogPosX, dogPosZ, dogAngle);
+    // === STREET LAMPS along the track ===
+    for (int i = 0; i < NUM_STREET_LAMPS; i++) {
+        queueStreetLamp(STREET_LAMPS[i][0], STREET_LAMPS[i][1], STREET_LAMPS[i][2]);
+    }
     
-    // Walker 2 & 3: Walking couple (close together)
-    drawWalker(walker2.posX, walker2.posZ, walker2, true, false);   // Male
-    drawWalker(walker3.posX, walker3.posZ, walker3, false, false);  // Female
+    renderQueue.setZone("Fences");
+    queueStatic(0, 1.0f, 0, 0.1f, 0.1f, 0.1f, drawPerimeterFence); // Ornamental iron fence around entire map
     
-    // Walker 4: Walker (male, walking at same speed)
-    drawWalker(walker4.posX, walker4.posZ, walker4, true, false);
+    // Net posts are opaque, the mesh is see-through
+    renderQueue.setZone("Net");
+    queueStatic(0, 0.5f, 0, 0.3f, 0.3f, 0.3f, drawNet);
+    renderQueue.submitStatic(makeTransparentItem(0, 0.5f, 0, BLEND_ALPHA, drawNetMesh, true));
     
     // Draw park scenery - BEAUTIFUL ENHANCED PARK ATMOSPHERE! 🌳🌸
     
@@ -3239,173 +3277,173 @@ void display() {
     // === FENCES - Beautiful wooden fencing (FIXED alignment) ===
     
     // CORNER POSTS (explicitly placed for perfect alignment)
-    drawFence(-COURT_LENGTH/2 - 8, -COURT_WIDTH/2 - 5, 0);  // Bottom-left corner
-    drawFence(COURT_LENGTH/2 + 8, -COURT_WIDTH/2 - 5, 0);   // Bottom-right corner
-    drawFence(-COURT_LENGTH/2 - 8, COURT_WIDTH/2 + 5, 0);   // Top-left corner
-    drawFence(COURT_LENGTH/2 + 8, COURT_WIDTH/2 + 5, 0);    // Top-right corner
+    queueFence(-COURT_LENGTH/2 - 8, -COURT_WIDTH/2 - 5, 0);  // Bottom-left corner
+    queueFence(COURT_LENGTH/2 + 8, -COURT_WIDTH/2 - 5, 0);   // Bottom-right corner
+    queueFence(-COURT_LENGTH/2 - 8, COURT_WIDTH/2 + 5, 0);   // Top-left corner
+    queueFence(COURT_LENGTH/2 + 8, COURT_WIDTH/2 + 5, 0);    // Top-right corner
     
     // Bottom fence line (horizontal) - excluding corners
     for (float x = -COURT_LENGTH/2 - 8 + 1.2f; x < COURT_LENGTH/2 + 8; x += 1.2f) {
-        drawFence(x, -COURT_WIDTH/2 - 5, 0);
+        queueFence(x, -COURT_WIDTH/2 - 5, 0);
     }
     // Top fence line (horizontal) - excluding corners
     for (float x = -COURT_LENGTH/2 - 8 + 1.2f; x < COURT_LENGTH/2 + 8; x += 1.2f) {
-        drawFence(x, COURT_WIDTH/2 + 5, 0);
+        queueFence(x, COURT_WIDTH/2 + 5, 0);
     }
     // Left fence line (vertical) - excluding corners
     for (float z = -COURT_WIDTH/2 - 5 + 1.2f; z < COURT_WIDTH/2 + 5; z += 1.2f) {
-        drawFence(-COURT_LENGTH/2 - 8, z, 90);
+        queueFence(-COURT_LENGTH/2 - 8, z, 90);
     }
     // Right fence line (vertical) - excluding corners
     for (float z = -COURT_WIDTH/2 - 5 + 1.2f; z < COURT_WIDTH/2 + 5; z += 1.2f) {
-        drawFence(COURT_LENGTH/2 + 8, z, 90);
+        queueFence(COURT_LENGTH/2 + 8, z, 90);
     }
     
     // === TREES - Lush forest-like environment ===
     // Corner trees (large, prominent)
-    // drawTree(-COURT_LENGTH/2 - 4, -COURT_WIDTH/2 - 4);
-    // drawTree(-COURT_LENGTH/2 - 4, COURT_WIDTH/2 + 4);
-    // drawTree(COURT_LENGTH/2 + 4, -COURT_WIDTH/2 - 4);
-    // drawTree(COURT_LENGTH/2 + 4, COURT_WIDTH/2 + 4);
+    // queueTree(-COURT_LENGTH/2 - 4, -COURT_WIDTH/2 - 4);
+    // queueTree(-COURT_LENGTH/2 - 4, COURT_WIDTH/2 + 4);
+    // queueTree(COURT_LENGTH/2 + 4, -COURT_WIDTH/2 - 4);
+    // queueTree(COURT_LENGTH/2 + 4, COURT_WIDTH/2 + 4);
     
     // Perimeter trees (creating a natural border)
-    drawTree(-COURT_LENGTH/2 - 6, 0);
-    drawTree(COURT_LENGTH/2 + 6, 0);
-    // drawTree(0, -COURT_WIDTH/2 - 6);
-    // drawTree(0, COURT_WIDTH/2 + 6);
+    queueTree(-COURT_LENGTH/2 - 6, 0);
+    queueTree(COURT_LENGTH/2 + 6, 0);
+    // queueTree(0, -COURT_WIDTH/2 - 6);
+    // queueTree(0, COURT_WIDTH/2 + 6);
     
     // Additional decorative trees - MORE for park feel!
-    drawTree(-COURT_LENGTH/2 - 7, -COURT_WIDTH/2 + 2);
-    drawTree(-COURT_LENGTH/2 - 7, COURT_WIDTH/2 - 2);
-    drawTree(COURT_LENGTH/2 + 7, -COURT_WIDTH/2 + 2);
-    drawTree(COURT_LENGTH/2 + 7, COURT_WIDTH/2 - 2);
+    queueTree(-COURT_LENGTH/2 - 7, -COURT_WIDTH/2 + 2);
+    queueTree(-COURT_LENGTH/2 - 7, COURT_WIDTH/2 - 2);
+    queueTree(COURT_LENGTH/2 + 7, -COURT_WIDTH/2 + 2);
+    queueTree(COURT_LENGTH/2 + 7, COURT_WIDTH/2 - 2);
     
     // Mid-distance trees for depth
-    drawTree(-COURT_LENGTH/2 - 5, -COURT_WIDTH/2 - 1);
-    drawTree(-COURT_LENGTH/2 - 5, COURT_WIDTH/2 + 1);
-    drawTree(COURT_LENGTH/2 + 5, -COURT_WIDTH/2 - 1);
-    drawTree(COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 1);
+    queueTree(-COURT_LENGTH/2 - 5, -COURT_WIDTH/2 - 1);
+    queueTree(-COURT_LENGTH/2 - 5, COURT_WIDTH/2 + 1);
+    queueTree(COURT_LENGTH/2 + 5, -COURT_WIDTH/2 - 1);
+    queueTree(COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 1);
     
     // Far background trees (smaller perspective)
-    // drawTree(-COURT_LENGTH/2 - 9, -COURT_WIDTH/2 - 6);
-    // drawTree(-COURT_LENGTH/2 - 9, COURT_WIDTH/2 + 6);
-    // drawTree(COURT_LENGTH/2 + 9, -COURT_WIDTH/2 - 6);
-    // drawTree(COURT_LENGTH/2 + 9, COURT_WIDTH/2 + 6);
+    // queueTree(-COURT_LENGTH/2 - 9, -COURT_WIDTH/2 - 6);
+    // queueTree(-COURT_LENGTH/2 - 9, COURT_WIDTH/2 + 6);
+    // queueTree(COURT_LENGTH/2 + 9, -COURT_WIDTH/2 - 6);
+    // queueTree(COURT_LENGTH/2 + 9, COURT_WIDTH/2 + 6);
     
     // Clustered trees for natural look
-    drawTree(-COURT_LENGTH/2 - 8, -COURT_WIDTH/2);
-    drawTree(COURT_LENGTH/2 + 8, COURT_WIDTH/2);
-    // drawTree(-3, -COURT_WIDTH/2 - 7);
-    // drawTree(3, COURT_WIDTH/2 + 7);
+    queueTree(-COURT_LENGTH/2 - 8, -COURT_WIDTH/2);
+    queueTree(COURT_LENGTH/2 + 8, COURT_WIDTH/2);
+    // queueTree(-3, -COURT_WIDTH/2 - 7);
+    // queueTree(3, COURT_WIDTH/2 + 7);
     
     // === BUSHES - Abundant low greenery ===
     // Corner bushes
-    drawBush(-COURT_LENGTH/2 - 3, -COURT_WIDTH/2 - 2);
-    drawBush(-COURT_LENGTH/2 - 3, COURT_WIDTH/2 + 2);
-    drawBush(COURT_LENGTH/2 + 3, -COURT_WIDTH/2 - 2);
-    drawBush(COURT_LENGTH/2 + 3, COURT_WIDTH/2 + 2);
+    queueBush(-COURT_LENGTH/2 - 3, -COURT_WIDTH/2 - 2);
+    queueBush(-COURT_LENGTH/2 - 3, COURT_WIDTH/2 + 2);
+    queueBush(COURT_LENGTH/2 + 3, -COURT_WIDTH/2 - 2);
+    queueBush(COURT_LENGTH/2 + 3, COURT_WIDTH/2 + 2);
     
     // Bushes along paths - MANY MORE!
-    drawBush(-COURT_LENGTH/2 - 1.5f, -COURT_WIDTH/2 - 3.5f);
-    drawBush(COURT_LENGTH/2 + 1.5f, -COURT_WIDTH/2 - 3.5f);
-    drawBush(-COURT_LENGTH/2 - 1.5f, COURT_WIDTH/2 + 3.5f);
-    drawBush(COURT_LENGTH/2 + 1.5f, COURT_WIDTH/2 + 3.5f);
+    queueBush(-COURT_LENGTH/2 - 1.5f, -COURT_WIDTH/2 - 3.5f);
+    queueBush(COURT_LENGTH/2 + 1.5f, -COURT_WIDTH/2 - 3.5f);
+    queueBush(-COURT_LENGTH/2 - 1.5f, COURT_WIDTH/2 + 3.5f);
+    queueBush(COURT_LENGTH/2 + 1.5f, COURT_WIDTH/2 + 3.5f);
     
     // Additional decorative bushes
-    drawBush(-COURT_LENGTH/2 - 4.5f, -COURT_WIDTH/2 - 3);
-    drawBush(-COURT_LENGTH/2 - 4.5f, COURT_WIDTH/2 + 3);
-    drawBush(COURT_LENGTH/2 + 4.5f, -COURT_WIDTH/2 - 3);
-    drawBush(COURT_LENGTH/2 + 4.5f, COURT_WIDTH/2 + 3);
+    queueBush(-COURT_LENGTH/2 - 4.5f, -COURT_WIDTH/2 - 3);
+    queueBush(-COURT_LENGTH/2 - 4.5f, COURT_WIDTH/2 + 3);
+    queueBush(COURT_LENGTH/2 + 4.5f, -COURT_WIDTH/2 - 3);
+    queueBush(COURT_LENGTH/2 + 4.5f, COURT_WIDTH/2 + 3);
     
     // Bushes near benches
-    drawBush(-COURT_LENGTH/2 - 3, -COURT_WIDTH/2 + 0.5f);
-    drawBush(-COURT_LENGTH/2 - 3, COURT_WIDTH/2 - 0.5f);
-    drawBush(COURT_LENGTH/2 + 3, -COURT_WIDTH/2 + 0.5f);
-    drawBush(COURT_LENGTH/2 + 3, COURT_WIDTH/2 - 0.5f);
+    queueBush(-COURT_LENGTH/2 - 3, -COURT_WIDTH/2 + 0.5f);
+    queueBush(-COURT_LENGTH/2 - 3, COURT_WIDTH/2 - 0.5f);
+    queueBush(COURT_LENGTH/2 + 3, -COURT_WIDTH/2 + 0.5f);
+    queueBush(COURT_LENGTH/2 + 3, COURT_WIDTH/2 - 0.5f);
     
     // Random scattered bushes for natural look
-    drawBush(-COURT_LENGTH/2 - 6.5f, -COURT_WIDTH/2 - 4.5f);
-    drawBush(COURT_LENGTH/2 + 6.5f, COURT_WIDTH/2 + 4.5f);
-    // drawBush(-2.5f, -COURT_WIDTH/2 - 6);
-    // drawBush(2.5f, COURT_WIDTH/2 + 6);
-    drawBush(-COURT_LENGTH/2 - 7.5f, 1);
-    drawBush(COURT_LENGTH/2 + 7.5f, -1);
+    queueBush(-COURT_LENGTH/2 - 6.5f, -COURT_WIDTH/2 - 4.5f);
+    queueBush(COURT_LENGTH/2 + 6.5f, COURT_WIDTH/2 + 4.5f);
+    // queueBush(-2.5f, -COURT_WIDTH/2 - 6);
+    // queueBush(2.5f, COURT_WIDTH/2 + 6);
+    queueBush(-COURT_LENGTH/2 - 7.5f, 1);
+    queueBush(COURT_LENGTH/2 + 7.5f, -1);
     
     // === FLOWERS - Beautiful colorful gardens! ===
     // Corner flower beds (prominent)
-    drawFlowers(-COURT_LENGTH/2 - 5, -COURT_WIDTH/2 - 3);
-    drawFlowers(-COURT_LENGTH/2 - 5, COURT_WIDTH/2 + 3);
-    drawFlowers(COURT_LENGTH/2 + 5, -COURT_WIDTH/2 - 3);
-    drawFlowers(COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 3);
+    queueFlowers(-COURT_LENGTH/2 - 5, -COURT_WIDTH/2 - 3);
+    queueFlowers(-COURT_LENGTH/2 - 5, COURT_WIDTH/2 + 3);
+    queueFlowers(COURT_LENGTH/2 + 5, -COURT_WIDTH/2 - 3);
+    queueFlowers(COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 3);
     
     // Flower gardens along paths
-    drawFlowers(-COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 4);
-    drawFlowers(COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 4);
-    drawFlowers(0, -COURT_WIDTH/2 - 7);
-    drawFlowers(0, COURT_WIDTH/2 + 7.5f);
+    queueFlowers(-COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 4);
+    queueFlowers(COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 4);
+    queueFlowers(0, -COURT_WIDTH/2 - 7);
+    queueFlowers(0, COURT_WIDTH/2 + 7.5f);
     
     // Additional flower clusters - MUCH MORE COLOR!
-    drawFlowers(-COURT_LENGTH/2 - 6, -COURT_WIDTH/2 - 5);
-    drawFlowers(COURT_LENGTH/2 + 6, COURT_WIDTH/2 + 5);
-    drawFlowers(-COURT_LENGTH/2 - 4, -COURT_WIDTH/2 - 5.5f);
-    drawFlowers(COURT_LENGTH/2 + 4, COURT_WIDTH/2 + 5.5f);
+    queueFlowers(-COURT_LENGTH/2 - 6, -COURT_WIDTH/2 - 5);
+    queueFlowers(COURT_LENGTH/2 + 6, COURT_WIDTH/2 + 5);
+    queueFlowers(-COURT_LENGTH/2 - 4, -COURT_WIDTH/2 - 5.5f);
+    queueFlowers(COURT_LENGTH/2 + 4, COURT_WIDTH/2 + 5.5f);
     
     // Flowers near benches
-    drawFlowers(-COURT_LENGTH/2 - 2.5f, -COURT_WIDTH/2 + 2);
-    drawFlowers(-COURT_LENGTH/2 - 2.5f, COURT_WIDTH/2 - 2);
-    drawFlowers(COURT_LENGTH/2 + 2.5f, -COURT_WIDTH/2 + 2);
-    drawFlowers(COURT_LENGTH/2 + 2.5f, COURT_WIDTH/2 - 2);
+    queueFlowers(-COURT_LENGTH/2 - 2.5f, -COURT_WIDTH/2 + 2);
+    queueFlowers(-COURT_LENGTH/2 - 2.5f, COURT_WIDTH/2 - 2);
+    queueFlowers(COURT_LENGTH/2 + 2.5f, -COURT_WIDTH/2 + 2);
+    queueFlowers(COURT_LENGTH/2 + 2.5f, COURT_WIDTH/2 - 2);
     
     // Scattered flower patches
-    drawFlowers(-4, -COURT_WIDTH/2 - 6.5f);
-    drawFlowers(4, COURT_WIDTH/2 + 6.5f);
-    drawFlowers(-COURT_LENGTH/2 - 7, -COURT_WIDTH/2 - 2);
-    drawFlowers(COURT_LENGTH/2 + 7, COURT_WIDTH/2 + 2);
+    queueFlowers(-4, -COURT_WIDTH/2 - 6.5f);
+    queueFlowers(4, COURT_WIDTH/2 + 6.5f);
+    queueFlowers(-COURT_LENGTH/2 - 7, -COURT_WIDTH/2 - 2);
+    queueFlowers(COURT_LENGTH/2 + 7, COURT_WIDTH/2 + 2);
     
     // Front entrance flowers
-    drawFlowers(-1.5f, -COURT_WIDTH/2 - 8);
-    drawFlowers(1.5f, -COURT_WIDTH/2 - 8);
+    queueFlowers(-1.5f, -COURT_WIDTH/2 - 8);
+    queueFlowers(1.5f, -COURT_WIDTH/2 - 8);
     
     // === BENCHES - Plenty of seating! ===
     // Side benches (watching the game)
-    drawBench(-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 + 1, 90);
-    drawBench(-COURT_LENGTH/2 - 2, COURT_WIDTH/2 - 1, 90);
-    drawBench(COURT_LENGTH/2 + 2, -COURT_WIDTH/2 + 1, -90);
-    drawBench(COURT_LENGTH/2 + 2, COURT_WIDTH/2 - 1, -90);
+    queueBench(-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 + 1, 90);
+    queueBench(-COURT_LENGTH/2 - 2, COURT_WIDTH/2 - 1, 90);
+    queueBench(COURT_LENGTH/2 + 2, -COURT_WIDTH/2 + 1, -90);
+    queueBench(COURT_LENGTH/2 + 2, COURT_WIDTH/2 - 1, -90);
     
     // Additional side benches
-    drawBench(-COURT_LENGTH/2 - 2, 0, 90);
-    drawBench(COURT_LENGTH/2 + 2, 0, -90);
+    queueBench(-COURT_LENGTH/2 - 2, 0, 90);
+    queueBench(COURT_LENGTH/2 + 2, 0, -90);
     
     // End zone benches
-    drawBench(0, -COURT_WIDTH/2 - 4, 0);
-    drawBench(0, COURT_WIDTH/2 + 4, 180);
-    drawBench(-3, COURT_WIDTH/2 + 4, 180);
-    drawBench(3, COURT_WIDTH/2 + 4, 180);
+    queueBench(0, -COURT_WIDTH/2 - 4, 0);
+    queueBench(0, COURT_WIDTH/2 + 4, 180);
+    queueBench(-3, COURT_WIDTH/2 + 4, 180);
+    queueBench(3, COURT_WIDTH/2 + 4, 180);
     
     // Resting area benches (away from court)
-    drawBench(-COURT_LENGTH/2 - 6, -COURT_WIDTH/2 - 2, 45);
-    drawBench(COURT_LENGTH/2 + 6, COURT_WIDTH/2 + 2, -135);
+    queueBench(-COURT_LENGTH/2 - 6, -COURT_WIDTH/2 - 2, 45);
+    queueBench(COURT_LENGTH/2 + 6, COURT_WIDTH/2 + 2, -135);
     
     // === COURT FLOODLIGHTS - Professional stadium lighting ===
     // 4 tall floodlights at corners (auto ON at night, OFF during day)
-    drawCourtFloodlight(-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 - 2);  // Bottom-left
-    drawCourtFloodlight(COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 2);   // Bottom-right
-    drawCourtFloodlight(-COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 2);   // Top-left
-    drawCourtFloodlight(COURT_LENGTH/2 + 2, COURT_WIDTH/2 + 2);    // Top-right
+    queueCourtFloodlight(-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 - 2);  // Bottom-left
+    queueCourtFloodlight(COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 2);   // Bottom-right
+    queueCourtFloodlight(-COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 2);   // Top-left
+    queueCourtFloodlight(COURT_LENGTH/2 + 2, COURT_WIDTH/2 + 2);    // Top-right
     
     // === TRASH BINS - Clean park maintenance ===
-    drawTrashBin(-COURT_LENGTH/2 - 2.5f, -COURT_WIDTH/2 - 1.5f);
-    drawTrashBin(COURT_LENGTH/2 + 2.5f, COURT_WIDTH/2 + 1.5f);
-    drawTrashBin(0, -COURT_WIDTH/2 - 4.5f);
-    drawTrashBin(0, COURT_WIDTH/2 + 4.5f);
-    drawTrashBin(-COURT_LENGTH/2 - 6, -COURT_WIDTH/2 - 6);
-    drawTrashBin(COURT_LENGTH/2 + 6, COURT_WIDTH/2 + 6);
+    queueTrashBin(-COURT_LENGTH/2 - 2.5f, -COURT_WIDTH/2 - 1.5f);
+    queueTrashBin(COURT_LENGTH/2 + 2.5f, COURT_WIDTH/2 + 1.5f);
+    queueTrashBin(0, -COURT_WIDTH/2 - 4.5f);
+    queueTrashBin(0, COURT_WIDTH/2 + 4.5f);
+    queueTrashBin(-COURT_LENGTH/2 - 6, -COURT_WIDTH/2 - 6);
+    queueTrashBin(COURT_LENGTH/2 + 6, COURT_WIDTH/2 + 6);
     
     // === SIGNPOSTS - Informative signs ===
-    drawSignpost(-COURT_LENGTH/2 - 6.5f, -COURT_WIDTH/2 - 6, "Welcome");
-    drawSignpost(COURT_LENGTH/2 + 6.5f, COURT_WIDTH/2 + 6, "Pickleball");
-    drawSignpost(-COURT_LENGTH/2 - 7.5f, COURT_WIDTH/2 + 5, "Park Rules");
+    queueSignpost(-COURT_LENGTH/2 - 6.5f, -COURT_WIDTH/2 - 6, "Welcome");
+    queueSignpost(COURT_LENGTH/2 + 6.5f, COURT_WIDTH/2 + 6, "Pickleball");
+    queueSignpost(-COURT_LENGTH/2 - 7.5f, COURT_WIDTH/2 + 5, "Park Rules");
     
     // === FOUNTAINS REMOVED AS REQUESTED ===
     // drawFountain(0, COURT_WIDTH/2 + 7);
@@ -3454,129 +3492,321 @@ void display() {
     
     // === PICNIC TABLES - Park seating and gathering areas ===
     // Main picnic area (back of court)
-    drawPicnicTable(-4, COURT_WIDTH/2 + 6, 0);
-    drawPicnicTable(4, COURT_WIDTH/2 + 6, 0);
+    queuePicnicTable(-4, COURT_WIDTH/2 + 6, 0);
+    queuePicnicTable(4, COURT_WIDTH/2 + 6, 0);
     
     // Side picnic areas
-    // drawPicnicTable(-COURT_LENGTH/2 - 7, -COURT_WIDTH/2 - 4.5f, 45);
-    // drawPicnicTable(COURT_LENGTH/2 + 7, COURT_WIDTH/2 + 4.5f, -45);
+    // queuePicnicTable(-COURT_LENGTH/2 - 7, -COURT_WIDTH/2 - 4.5f, 45);
+    // queuePicnicTable(COURT_LENGTH/2 + 7, COURT_WIDTH/2 + 4.5f, -45);
     
     // Additional scattered tables
-    drawPicnicTable(-COURT_LENGTH/2 - 6, COURT_WIDTH/2 + 1, 90);
-    drawPicnicTable(COURT_LENGTH/2 + 6, -COURT_WIDTH/2 - 1, -90);
+    queuePicnicTable(-COURT_LENGTH/2 - 6, COURT_WIDTH/2 + 1, 90);
+    queuePicnicTable(COURT_LENGTH/2 + 6, -COURT_WIDTH/2 - 1, -90);
     
     // Front entrance area table
-    drawPicnicTable(0, -COURT_WIDTH/2 - 7, 0);
+    queuePicnicTable(0, -COURT_WIDTH/2 - 7, 0);
     
     // === DECORATIVE ROCK CLUSTERS - Natural landscaping elements ===
     // Corner rock clusters (natural borders)
-    drawRockCluster(-COURT_LENGTH/2 - 7.5f, -COURT_WIDTH/2 - 6.5f);
-    drawRockCluster(COURT_LENGTH/2 + 7.5f, COURT_WIDTH/2 + 6.5f);
-    drawRockCluster(-COURT_LENGTH/2 - 8.5f, COURT_WIDTH/2 + 6.5f);
-    drawRockCluster(COURT_LENGTH/2 + 8.5f, -COURT_WIDTH/2 - 6.5f);
+    queueRockCluster(-COURT_LENGTH/2 - 7.5f, -COURT_WIDTH/2 - 6.5f);
+    queueRockCluster(COURT_LENGTH/2 + 7.5f, COURT_WIDTH/2 + 6.5f);
+    queueRockCluster(-COURT_LENGTH/2 - 8.5f, COURT_WIDTH/2 + 6.5f);
+    queueRockCluster(COURT_LENGTH/2 + 8.5f, -COURT_WIDTH/2 - 6.5f);
     
     // Accent rock clusters near paths
-    drawRockCluster(-COURT_LENGTH/2 - 4, -COURT_WIDTH/2 - 6);
-    drawRockCluster(COURT_LENGTH/2 + 4, COURT_WIDTH/2 + 6);
-    drawRockCluster(-5, -COURT_WIDTH/2 - 7.5f);
-    drawRockCluster(5, COURT_WIDTH/2 + 8);
+    queueRockCluster(-COURT_LENGTH/2 - 4, -COURT_WIDTH/2 - 6);
+    queueRockCluster(COURT_LENGTH/2 + 4, COURT_WIDTH/2 + 6);
+    queueRockCluster(-5, -COURT_WIDTH/2 - 7.5f);
+    queueRockCluster(5, COURT_WIDTH/2 + 8);
     
     // Decorative rocks near fountains
-    drawRockCluster(-COURT_LENGTH/2 - 9, 1);
-    drawRockCluster(COURT_LENGTH/2 + 9, -1);
-    drawRockCluster(-1.5f, COURT_WIDTH/2 + 8);
-    drawRockCluster(1.5f, COURT_WIDTH/2 + 8);
+    queueRockCluster(-COURT_LENGTH/2 - 9, 1);
+    queueRockCluster(COURT_LENGTH/2 + 9, -1);
+    queueRockCluster(-1.5f, COURT_WIDTH/2 + 8);
+    queueRockCluster(1.5f, COURT_WIDTH/2 + 8);
     
     // Natural scattered rocks
-    drawRockCluster(-COURT_LENGTH/2 - 6.5f, -COURT_WIDTH/2 - 2.5f);
-    drawRockCluster(COURT_LENGTH/2 + 6.5f, COURT_WIDTH/2 + 2.5f);
-    drawRockCluster(-COURT_LENGTH/2 - 3, -COURT_WIDTH/2 - 7);
-    drawRockCluster(COURT_LENGTH/2 + 3, COURT_WIDTH/2 + 7);
+    queueRockCluster(-COURT_LENGTH/2 - 6.5f, -COURT_WIDTH/2 - 2.5f);
+    queueRockCluster(COURT_LENGTH/2 + 6.5f, COURT_WIDTH/2 + 2.5f);
+    queueRockCluster(-COURT_LENGTH/2 - 3, -COURT_WIDTH/2 - 7);
+    queueRockCluster(COURT_LENGTH/2 + 3, COURT_WIDTH/2 + 7);
 
     
-    // === CLOUDS - Fluffy sky decoration ===
-    if (timeOfDay > 0.25f && timeOfDay < 0.75f) {  // Only during day
-        // Large background clouds
-        drawCloud(-15, 20, -10, 1.5f);
-        drawCloud(15, 22, 5, 1.2f);
-        drawCloud(0, 25, -15, 1.8f);
-        drawCloud(-8, 18, 10, 1.0f);
-        drawCloud(12, 21, -5, 1.3f);
-        
-        // Additional mid-range clouds
-        drawCloud(-20, 19, 8, 1.4f);
-        drawCloud(18, 23, -12, 1.1f);
-        drawCloud(-5, 24, 12, 1.6f);
-        
-        // Small foreground clouds
-        drawCloud(8, 17, -8, 0.9f);
-        drawCloud(-12, 21, 3, 1.0f);
-    }
-    
     // === TREES OUTSIDE PERIMETER FENCE - Natural forest border ===
     // Hàng rào đen ở vị trí ±15.0f từ tâm sân
     // Đặt cây bên ngoài (xa hơn 15.0f) với các kích thước khác nhau
     
     // Bottom fence line (horizontal) - Outside trees
-    drawLargeTree(-COURT_LENGTH/2 - 17, -COURT_WIDTH/2 - 15.5f);
-    drawMediumTree(-COURT_LENGTH/2 - 19, -COURT_WIDTH/2 - 15.2f);
-    drawSmallTree(-COURT_LENGTH/2 - 21, -COURT_WIDTH/2 - 15.8f);
-    drawMediumTree(-COURT_LENGTH/2 - 10, -COURT_WIDTH/2 - 16.0f);
-    drawLargeTree(-COURT_LENGTH/2 - 5, -COURT_WIDTH/2 - 15.5f);
-    drawSmallTree(-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 - 16.2f);
+    queueLargeTree(-COURT_LENGTH/2 - 17, -COURT_WIDTH/2 - 15.5f);
+    queueMediumTree(-COURT_LENGTH/2 - 19, -COURT_WIDTH/2 - 15.2f);
+    queueSmallTree(-COURT_LENGTH/2 - 21, -COURT_WIDTH/2 - 15.8f);
+    queueMediumTree(-COURT_LENGTH/2 - 10, -COURT_WIDTH/2 - 16.0f);
+    queueLargeTree(-COURT_LENGTH/2 - 5, -COURT_WIDTH/2 - 15.5f);
+    queueSmallTree(-COURT_LENGTH/2 - 2, -COURT_WIDTH/2 - 16.2f);
     // Skip center area for gate
-    drawMediumTree(COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 15.7f);
-    drawLargeTree(COURT_LENGTH/2 + 5, -COURT_WIDTH/2 - 16.0f);
-    drawSmallTree(COURT_LENGTH/2 + 10, -COURT_WIDTH/2 - 15.5f);
-    drawMediumTree(COURT_LENGTH/2 + 17, -COURT_WIDTH/2 - 15.8f);
-    drawLargeTree(COURT_LENGTH/2 + 19, -COURT_WIDTH/2 - 16.2f);
-    drawSmallTree(COURT_LENGTH/2 + 21, -COURT_WIDTH/2 - 15.6f);
+    queueMediumTree(COURT_LENGTH/2 + 2, -COURT_WIDTH/2 - 15.7f);
+    queueLargeTree(COURT_LENGTH/2 + 5, -COURT_WIDTH/2 - 16.0f);
+    queueSmallTree(COURT_LENGTH/2 + 10, -COURT_WIDTH/2 - 15.5f);
+    queueMediumTree(COURT_LENGTH/2 + 17, -COURT_WIDTH/2 - 15.8f);
+    queueLargeTree(COURT_LENGTH/2 + 19, -COURT_WIDTH/2 - 16.2f);
+    queueSmallTree(COURT_LENGTH/2 + 21, -COURT_WIDTH/2 - 15.6f);
     
     // Top fence line (horizontal) - Outside trees
-    drawMediumTree(-COURT_LENGTH/2 - 17, COURT_WIDTH/2 + 15.5f);
-    drawLargeTree(-COURT_LENGTH/2 - 19, COURT_WIDTH/2 + 16.0f);
-    drawSmallTree(-COURT_LENGTH/2 - 21, COURT_WIDTH/2 + 15.7f);
-    drawLargeTree(-COURT_LENGTH/2 - 10, COURT_WIDTH/2 + 15.8f);
-    drawMediumTree(-COURT_LENGTH/2 - 5, COURT_WIDTH/2 + 16.2f);
-    drawSmallTree(-COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 15.5f);
-
-    drawMediumTree(-COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 15.5f);
-    drawSmallTree(-COURT_LENGTH/2 + 6.8, COURT_WIDTH/2 + 15.5f);
-    drawLargeTree(-COURT_LENGTH/2 + 9, COURT_WIDTH/2 + 15.5f);
-    drawMediumTree(-COURT_LENGTH/2 + 12, COURT_WIDTH/2 + 15.5f);
-
-    drawLargeTree(COURT_LENGTH/2 + 2, COURT_WIDTH/2 + 15.9f);
-    drawMediumTree(COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 16.1f);
-    drawSmallTree(COURT_LENGTH/2 + 10, COURT_WIDTH/2 + 15.6f);
-    drawLargeTree(COURT_LENGTH/2 + 17, COURT_WIDTH/2 + 15.8f);
-    drawMediumTree(COURT_LENGTH/2 + 19, COURT_WIDTH/2 + 16.3f);
-    drawSmallTree(COURT_LENGTH/2 + 21, COURT_WIDTH/2 + 15.4f);
+    queueMediumTree(-COURT_LENGTH/2 - 17, COURT_WIDTH/2 + 15.5f);
+    queueLargeTree(-COURT_LENGTH/2 - 19, COURT_WIDTH/2 + 16.0f);
+    queueSmallTree(-COURT_LENGTH/2 - 21, COURT_WIDTH/2 + 15.7f);
+    queueLargeTree(-COURT_LENGTH/2 - 10, COURT_WIDTH/2 + 15.8f);
+    queueMediumTree(-COURT_LENGTH/2 - 5, COURT_WIDTH/2 + 16.2f);
+    queueSmallTree(-COURT_LENGTH/2 - 2, COURT_WIDTH/2 + 15.5f);
+
+    queueMediumTree(-COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 15.5f);
+    queueSmallTree(-COURT_LENGTH/2 + 6.8, COURT_WIDTH/2 + 15.5f);
+    queueLargeTree(-COURT_LENGTH/2 + 9, COURT_WIDTH/2 + 15.5f);
+    queueMediumTree(-COURT_LENGTH/2 + 12, COURT_WIDTH/2 + 15.5f);
+
+    queueLargeTree(COURT_LENGTH/2 + 2, COURT_WIDTH/2 + 15.9f);
+    queueMediumTree(COURT_LENGTH/2 + 5, COURT_WIDTH/2 + 16.1f);
+    queueSmallTree(COURT_LENGTH/2 + 10, COURT_WIDTH/2 + 15.6f);
+    queueLargeTree(COURT_LENGTH/2 + 17, COURT_WIDTH/2 + 15.8f);
+    queueMediumTree(COURT_LENGTH/2 + 19, COURT_WIDTH/2 + 16.3f);
+    queueSmallTree(COURT_LENGTH/2 + 21, COURT_WIDTH/2 + 15.4f);
     
     // Left fence line (vertical) - Outside trees
-    drawLargeTree(-COURT_LENGTH/2 - 16.0f, -COURT_WIDTH/2 - 10);
-    drawMediumTree(-COURT_LENGTH/2 - 15.5f, -COURT_WIDTH/2 - 5);
-    drawSmallTree(-COURT_LENGTH/2 - 16.2f, -COURT_WIDTH/2 - 2);
-    drawMediumTree(-COURT_LENGTH/2 - 15.8f, COURT_WIDTH/2 + 2);
-    drawLargeTree(-COURT_LENGTH/2 - 16.1f, COURT_WIDTH/2 + 5);
-    drawSmallTree(-COURT_LENGTH/2 - 15.6f, COURT_WIDTH/2 + 10);
+    queueLargeTree(-COURT_LENGTH/2 - 16.0f, -COURT_WIDTH/2 - 10);
+    queueMediumTree(-COURT_LENGTH/2 - 15.5f, -COURT_WIDTH/2 - 5);
+    queueSmallTree(-COURT_LENGTH/2 - 16.2f, -COURT_WIDTH/2 - 2);
+    queueMediumTree(-COURT_LENGTH/2 - 15.8f, COURT_WIDTH/2 + 2);
+    queueLargeTree(-COURT_LENGTH/2 - 16.1f, COURT_WIDTH/2 + 5);
+    queueSmallTree(-COURT_LENGTH/2 - 15.6f, COURT_WIDTH/2 + 10);
     
     // Right fence line (vertical) - Outside trees
-    drawMediumTree(COURT_LENGTH/2 + 15.7f, -COURT_WIDTH/2 - 10);
-    drawLargeTree(COURT_LENGTH/2 + 16.2f, -COURT_WIDTH/2 - 5);
-    drawSmallTree(COURT_LENGTH/2 + 15.5f, -COURT_WIDTH/2 - 2);
-    drawLargeTree(COURT_LENGTH/2 + 15.9f, COURT_WIDTH/2 + 2);
-    drawMediumTree(COURT_LENGTH/2 + 16.3f, COURT_WIDTH/2 + 5);
-    drawSmallTree(COURT_LENGTH/2 + 15.4f, COURT_WIDTH/2 + 10);
+    queueMediumTree(COURT_LENGTH/2 + 15.7f, -COURT_WIDTH/2 - 10);
+    queueLargeTree(COURT_LENGTH/2 + 16.2f, -COURT_WIDTH/2 - 5);
+    queueSmallTree(COURT_LENGTH/2 + 15.5f, -COURT_WIDTH/2 - 2);
+    queueLargeTree(COURT_LENGTH/2 + 15.9f, COURT_WIDTH/2 + 2);
+    queueMediumTree(COURT_LENGTH/2 + 16.3f, COURT_WIDTH/2 + 5);
+    queueSmallTree(COURT_LENGTH/2 + 15.4f, COURT_WIDTH/2 + 10);
     
     // Corner accent trees (extra large for emphasis)
-    drawLargeTree(-COURT_LENGTH/2 - 18, -COURT_WIDTH/2 - 17);
-    drawLargeTree(COURT_LENGTH/2 + 18, -COURT_WIDTH/2 - 17);
-    drawLargeTree(-COURT_LENGTH/2 - 18, COURT_WIDTH/2 + 17);
-    drawLargeTree(COURT_LENGTH/2 + 18, COURT_WIDTH/2 + 17);
+    queueLargeTree(-COURT_LENGTH/2 - 18, -COURT_WIDTH/2 - 17);
+    queueLargeTree(COURT_LENGTH/2 + 18, -COURT_WIDTH/2 - 17);
+    queueLargeTree(-COURT_LENGTH/2 - 18, COURT_WIDTH/2 + 17);
+    queueLargeTree(COURT_LENGTH/2 + 18, COURT_WIDTH/2 + 17);
     
     // === ENTRANCE GATE - Parabolic arch at park entrance ===
     // Position: Front center, outside the running track
-    drawArchGate(0, -COURT_WIDTH/2 - 15.0f);
+    queueArchGate(0, -COURT_WIDTH/2 - 15.0f);
+    
+    renderQueue.setZone(NULL);
+}
+
+// Advance the simulation by frameTime seconds and draw the result (no buffer swap).
+// Shared by the window (display) and the offscreen benchmark (scene_bench.cpp).
+void renderFrame(float frameTime) {
+    profiler.beginZone("Simulation");
+    stepSimulation(frameTime);
+    profiler.endZone();
+    
+    // Render the moment between the last two ticks; the live state is put back after drawing
+    SimulationState liveState = sim;
+    blendStates(previousState, liveState, simAccumulator * simTickRate, sim);
+    
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    // Set sky color - BRIGHT SKY BLUE!
+    glClearColor(0.53f, 0.81f, 0.92f, 1.0f);  // Sky blue!
+    
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    
+    // Camera position - Look at center of court
+    float camX = cameraDistance * cos(cameraAngle * PI / 180.0f);
+    float camZ = cameraDistance * sin(cameraAngle * PI / 180.0f);
+    gluLookAt(camX, cameraHeight, camZ,  // Camera position
+              0, 0, 0,                    // Look at center of court (FIXED!)
+              0, 1, 0);                   // Up vector
+    
+    // Update lighting based on time of day - CRITICAL!
+    profiler.beginZone("Lighting");
+    setupLighting();
+    profiler.endZone();
+    
+    // Static scenery is cached in the queue and only re-sorted when the camera moves
+    renderQueue.setCamera(camX, cameraHeight, camZ);
+    int variant = getSceneVariant();
+    if (variant != staticSceneVariant || !renderQueue.hasStatic()) {
+        ScopedCpuZone zone(profiler, "Static rebuild");
+        buildStaticScene(variant);
+    }
+    
+    profiler.beginZone("Submit");
+    shadowBatch.begin();
+    
+    // Sun: solid core with the opaque pass, glow and rays blended on top
+    float sunX, sunY, sunZ;
+    renderQueue.setZone("Sky");
+    if (isSunVisible(sunX, sunY, sunZ)) {
+        renderQueue.submit(makeOpaqueItem(sunX, sunY, sunZ, 1.0f, 1.0f, 0.8f, drawSunCore, false));
+        renderQueue.submit(makeTransparentItem(sunX, sunY, sunZ, BLEND_ALPHA, drawSunGlow));
+        shadowBatch.setLightPosition(sunX, sunY, sunZ);
+    } else {
+        shadowBatch.setLightPosition(0, 1, 0);  // Night: floodlights overhead, round shadows
+    }
+    
+    // Sky: every visible cloud in one textured batch
+    RenderItem clouds = makeTransparentItem(0, 22.0f, 0, BLEND_ALPHA,
+                                            []() { skyClouds.draw(getSceneVariant(), sim.windTime); });
+    clouds.texture = skyClouds.texture();
+    updateCloudTint();
+    renderQueue.submit(clouds);
+    
+    renderQueue.setZone("Ball");
+    renderQueue.submit(makeOpaqueItem(sim.ballPosX, sim.ballPosY, sim.ballPosZ, 1.0f, 0.9f, 0.1f, drawBall));
+    
+    // Draw players using DYNAMIC POSITIONS
+    renderQueue.setZone("Players");
+    renderQueue.submit(makeOpaqueItem(sim.player1.posX, 1.0f, sim.player1.posZ, 0.9f, 0.7f, 0.6f,
+                                      []() { drawPlayer(sim.player1.posX, sim.player1.posZ, sim.player1, true); }));
+    renderQueue.submit(makeOpaqueItem(sim.player2.posX, 1.0f, sim.player2.posZ, 0.9f, 0.7f, 0.6f,
+                                      []() { drawPlayer(sim.player2.posX, sim.player2.posZ, sim.player2, false); }));
+    shadowBatch.add(sim.player1.posX, sim.player1.posZ, 0.4f, 0.35f, 0.4f);
+    shadowBatch.add(sim.player2.posX, sim.player2.posZ, 0.4f, 0.35f, 0.4f);
+    
+    // === WALKERS ON RUNNING TRACK - People enjoying the park ===
+    // Walker 1: Person with dog (male, walking)
+    renderQueue.setZone("Walkers");
+    renderQueue.submit(makeOpaqueItem(sim.walkers[0].posX, 1.0f, sim.walkers[0].posZ, 0.9f, 0.7f, 0.6f,
+                                      []() { drawWalker(sim.walkers[0].posX, sim.walkers[0].posZ, sim.walkers[0], true, false); }));
+    renderQueue.submit(makeOpaqueItem(sim.dogPosX, 0.3f, sim.dogPosZ, 0.6f, 0.4f, 0.2f,
+                                      []() { drawDog(sim.dogPosX, sim.dogPosZ, sim.dogAngle); }));
+    
+    // Walker 2 & 3: Walking couple (close together)
+    renderQueue.submit(makeOpaqueItem(sim.walkers[1].posX, 1.0f, sim.walkers[1].posZ, 0.9f, 0.7f, 0.6f,
+                                      []() { drawWalker(sim.walkers[1].posX, sim.walkers[1].posZ, sim.walkers[1], true, false); }));   // Male
+    renderQueue.submit(makeOpaqueItem(sim.walkers[2].posX, 1.0f, sim.walkers[2].posZ, 0.9f, 0.7f, 0.6f,
+                                      []() { drawWalker(sim.walkers[2].posX, sim.walkers[2].posZ, sim.walkers[2], false, false); }));  // Female
+    
+    // Walker 4: Walker (male, walking at same speed)
+    renderQueue.submit(makeOpaqueItem(sim.walkers[3].posX, 1.0f, sim.walkers[3].posZ, 0.9f, 0.7f, 0.6f,
+                                      []() { drawWalker(sim.walkers[3].posX, sim.walkers[3].posZ, sim.walkers[3], true, false); }));
+    
+    shadowBatch.add(sim.walkers[0].posX, sim.walkers[0].posZ, 0.4f, 0.35f, 0.4f);
+    shadowBatch.add(sim.walkers[1].posX, sim.walkers[1].posZ, 0.4f, 0.35f, 0.4f);
+    shadowBatch.add(sim.walkers[2].posX, sim.walkers[2].posZ, 0.4f, 0.35f, 0.4f);
+    shadowBatch.add(sim.walkers[3].posX, sim.walkers[3].posZ, 0.4f, 0.35f, 0.4f);
+    shadowBatch.add(sim.dogPosX, sim.dogPosZ, 0.3f, 0.25f, 0.3f);
+    
+    // Ground shadows: static scenery + characters, stretched away from the sun
+    if (shadowDetail == 0) {
+        for (size_t i = 0; i < staticShadows.size(); i++) {
+            const ShadowCaster& c = staticShadows[i];
+            shadowBatch.add(c.x, c.z, c.radiusX, c.radiusZ, c.opacity, c.rotation);
+        }
+    }
+    if (shadowDetail < 2) {
+        RenderItem shadows = makeTransparentItem(0, 0, 0, BLEND_ALPHA, []() { shadowBatch.draw(); });
+        shadows.texture = shadowBatch.texture();
+        shadows.zone = "Shadows";
+        renderQueue.submit(shadows);
+    }
+    renderQueue.setZone(NULL);
+    profiler.endZone();
+    
+    // Opaque front-to-back, then transparent back-to-front
+    profiler.beginZone("Draw");
+    renderQueue.flush();
+    profiler.endZone();
+    
+    sim = liveState;
+}
+
+FrameCapture frameCapture;
+
+// Print what is still queued before exiting
+void stopRallyLog() {
+    rallyLog.stop();
+}
+
+// === ADAPTIVE QUALITY ===
+QualityGovernor governor;
+SceneRenderTarget sceneTarget;
+bool useSceneTarget = false;   // --budget given: scene drawn through sceneTarget
+
+// Knobs in the order they give way (cheapest to lose first)
+void registerQualityKnobs() {
+    governor.addKnob("MSAA", {"4x", "2x", "off"}, [](int level) {
+        static const int samples[] = {4, 2, 0};
+        sceneTarget.setSamples(samples[level]);
+    });
+    governor.addKnob("Clouds", {"all", "2/3", "1/3", "off"}, [](int level) {
+        static const float density[] = {1.0f, 0.67f, 0.34f, 0.0f};
+        skyClouds.setDensity(density[level]);
+    });
+    governor.addKnob("Shadow", {"all", "chars", "off"}, [](int level) {
+        shadowDetail = level;
+    });
+    governor.addKnob("LOD", {"full", "3/4", "1/2", "1/3"}, [](int level) {
+        static const float detail[] = {1.0f, 0.75f, 0.5f, 0.34f};
+        propDetail = detail[level];
+    });
+    governor.addKnob("Res", {"100%", "85%", "70%", "50%"}, [](int level) {
+        static const float scale[] = {1.0f, 0.85f, 0.7f, 0.5f};
+        sceneTarget.setScale(scale[level]);
+    });
+}
+
+void updateQualityStatus() {
+    if (!governor.isEnabled()) {
+        profiler.setStatus("");
+        return;
+    }
+    profiler.setStatus(governor.describe().c_str());
+}
+
+// Flush the frames still in flight and report how the capture went
+void stopCapture() {
+    if (!frameCapture.isCapturing()) return;
+    frameCapture.stop();
+    CaptureStats stats = frameCapture.stats();
+    printf("Capture: %lld frames written, %lld dropped, %lld resampled, %lld readback stalls\n",
+           stats.written, stats.dropped, stats.resampled, stats.stalls);
+}
+
+// Display function
+void display() {
+    float frameTime = pacer.beginFrame();
+    profiler.beginFrame();
+    governor.beginFrame();
+    int width = glutGet(GLUT_WINDOW_WIDTH);
+    int height = glutGet(GLUT_WINDOW_HEIGHT);
+    
+    // Advance the simulation by the real time since the last frame
+    if (useSceneTarget) sceneTarget.begin(width, height);
+    renderFrame(frameTime);
+    if (useSceneTarget) {
+        profiler.beginZone("Resolve");
+        sceneTarget.end(width, height);
+        profiler.endZone();
+    }
+    
+    // Footage without the profiler overlay
+    if (frameCapture.isCapturing()) {
+        profiler.beginZone("Capture");
+        frameCapture.captureFrame(width, height);
+        profiler.endZone();
+    }
+    
+    profiler.beginGpuZone("Overlay");
+    profiler.beginZone("Overlay");
+    profiler.drawOverlay(width, height);
+    profiler.endZone();
+    profiler.endFrame();
+    
+    if (governor.endFrame()) {
+        printf("Quality: %s\n", governor.lastChange());
+        profiler.markEvent(governor.lastChange());
+        updateQualityStatus();
+    }
     
     glutSwapBuffers();
 }
@@ -3590,22 +3820,23 @@ void reshape(int w, int h) {
     glMatrixMode(GL_MODELVIEW);
 }
 
-// Timer function
-void timer(int value) {
-    updateBall();
-    updateWalkers();  // Update people walking/jogging on track
-    glutPostRedisplay();
-    glutTimerFunc(16, timer, 0);  // ~60 FPS
+// Idle function - the pacer decides when the next frame is drawn;
+// the simulation catches up with the real time in display()
+void idle() {
+    if (pacer.waitForNextFrame()) glutPostRedisplay();
 }
 
-// Keyboard function
-void keyboard(unsigned char key, int x, int y) {
+void reportFramePacing() {
+    char text[160];
+    pacer.describe(text, sizeof(text));
+    printf("Frame pacing: %s\n", text);
+}
+
+// Keys that change the scene (recorded in, and replayed from, replay logs)
+void applyKey(unsigned char key) {
     switch (key) {
-        case 27:  // ESC
-            exit(0);
-            break;
         case ' ':  // Space - pause/resume
-            isPaused = !isPaused;
+            sim.isPaused = !sim.isPaused;
             break;
         case 'w':
         case 'W':
@@ -3637,22 +3868,58 @@ void keyboard(unsigned char key, int x, int y) {
             break;
         case 'r':
         case 'R':
-            windStrength += 0.1f;
-            if (windStrength > 3.0f) windStrength = 3.0f;
-            printf("Wind strength: %.1f\n", windStrength);
+            sim.windStrength += 0.1f;
+            if (sim.windStrength > 3.0f) sim.windStrength = 3.0f;
+            printf("Wind strength: %.1f\n", sim.windStrength);
             break;
         case 'f':
         case 'F':
-            windStrength -= 0.1f;
-            if (windStrength < 0.0f) windStrength = 0.0f;
-            printf("Wind strength: %.1f\n", windStrength);
+            sim.windStrength -= 0.1f;
+            if (sim.windStrength < 0.0f) sim.windStrength = 0.0f;
+            printf("Wind strength: %.1f\n", sim.windStrength);
             break;
     }
-    glutPostRedisplay();
 }
 
-// Special keyboard function for arrow keys
-void specialKeys(int key, int x, int y) {
+// Keyboard function
+void keyboard(unsigned char key, int x, int y) {
+    switch (key) {
+        case 27:  // ESC
+            exit(0);
+            break;
+        case 'p':
+        case 'P':
+            profiler.setEnabled(!profiler.isEnabled());
+            printf("Profiler overlay: %s\n", profiler.isEnabled() ? "ON" : "OFF");
+            break;
+        case 'g':
+        case 'G':
+            if (!useSceneTarget) {
+                printf("Adaptive quality needs --budget <ms> at startup\n");
+                break;
+            }
+            governor.setEnabled(!governor.isEnabled());
+            printf("Adaptive quality: %s\n", governor.isEnabled() ? "ON" : "OFF (full quality)");
+            profiler.markEvent(governor.isEnabled() ? "Quality governor on" : "Quality governor off");
+            updateQualityStatus();
+            break;
+        case '[':  // Replay: jump back
+            if (replayMode) seekReplay(sim.tick - (long long)(REPLAY_SEEK_SECONDS * simTickRate));
+            break;
+        case ']':  // Replay: jump forward
+            if (replayMode) seekReplay(sim.tick + (long long)(REPLAY_SEEK_SECONDS * simTickRate));
+            break;
+        default:
+            // During a replay the log drives the scene
+            if (replayMode) break;
+            replayRecorder.recordInput(sim.tick, REPLAY_KEY, key);
+            applyKey(key);
+            break;
+    }
+    // No redisplay here: the change shows in the next paced frame
+}
+
+void applySpecialKey(int key) {
     switch (key) {
         case GLUT_KEY_UP:
             timeOfDay += 0.02f;
@@ -3663,13 +3930,26 @@ void specialKeys(int key, int x, int y) {
             if (timeOfDay < 0.0f) timeOfDay = 1.0f;
             break;
     }
-    glutPostRedisplay();
+}
+
+// Special keyboard function for arrow keys
+void specialKeys(int key, int x, int y) {
+    if (!replayMode) {
+        replayRecorder.recordInput(sim.tick, REPLAY_SPECIAL_KEY, key);
+        applySpecialKey(key);
+    }
 }
 
 // Initialize OpenGL - LIGHTING ENABLED with color materials
 void init() {
     glEnable(GL_DEPTH_TEST);
     
+    // Sky/sun/light terms for the whole day, looked up every frame
+    bakeDayCycle();
+    
+    // Both interpolation endpoints start at the initial state
+    previousState = sim;
+    
     // === ENHANCED LIGHTING SETUP (Phong/Blinn-Phong) ===
     glEnable(GL_LIGHTING);
     glEnable(GL_LIGHT0);
@@ -3709,6 +3989,15 @@ void init() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
+    // Bake the cloud atlas once (needs the GL context)
+    setupClouds();
+    skyClouds.createAtlas();
+    shadowBatch.createTexture();
+    
+    // GPU timer queries for the profiler overlay (if the driver has them)
+    profiler.initGpu();
+    renderQueue.setProfiler(&profiler);
+    
     // Try to load 3D models - NEW!
     printf("\n=== Loading 3D Models ===\n");
     bool treeLoaded = treeModel.loadModel("models/tree.obj");
@@ -3728,21 +4017,174 @@ void init() {
     printf("========================\n\n");
 }
 
-// Main function
+// Main function (left out when the scene is linked into scene_bench)
+#ifndef PICKLEBALL_NO_MAIN
 int main(int argc, char** argv) {
+    // Optional: --tick-rate <Hz> (simulation), --fps <N> (render, 0 = uncapped)
+    //           --seed <N> (shot variation, same seed = same rally)
+    //           --headless --ticks <N> (no window, print rally statistics)
+    //           --checksums <file> (headless: per-tick state hashes)
+    //           --record <file> / --replay <file> (binary input log)
+    //           --capture <pattern> (PNG per frame, e.g. capture/frame_%05d.png)
+    //           --capture-pipe <command> (raw I420 frames to an encoder's stdin)
+    //           --capture-size <W>x<H> (window and capture size, default 1280x720)
+    //           --budget <ms> (adaptive quality holds this frame time, G toggles)
+    //           --event-log <file> (every rally event as CSV)
+    //           --vsync (display paces frames unless --fps is given too)
+    bool headless = false;
+    long long headlessTicks = 1000000;
+    uint64_t seed = DEFAULT_SIMULATION_SEED;
+    const char* checksumPath = NULL;
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    const char* captureTarget = NULL;
+    CaptureFormat captureFormat = CAPTURE_PNG;
+    int captureWidth = 1280, captureHeight = 720;
+    float qualityBudget = 0.0f;
+    const char* eventLogPath = NULL;
+    bool vsync = false;
+    bool fpsGiven = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "--ticks") == 0) {
+            headlessTicks = atoll(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--checksums") == 0) {
+            checksumPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--record") == 0) {
+            recordPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--replay") == 0) {
+            replayPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--capture") == 0) {
+            captureTarget = argv[++i];
+            captureFormat = CAPTURE_PNG;
+        } else if (i + 1 < argc && strcmp(argv[i], "--capture-pipe") == 0) {
+            captureTarget = argv[++i];
+            captureFormat = CAPTURE_YUV_PIPE;
+        } else if (i + 1 < argc && strcmp(argv[i], "--capture-size") == 0) {
+            if (sscanf(argv[++i], "%dx%d", &captureWidth, &captureHeight) != 2 ||
+                captureWidth <= 0 || captureHeight <= 0) {
+                fprintf(stderr, "--capture-size expects WIDTHxHEIGHT, e.g. 1920x1080\n");
+                return 1;
+            }
+        } else if (i + 1 < argc && strcmp(argv[i], "--budget") == 0) {
+            qualityBudget = (float)atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--event-log") == 0) {
+            eventLogPath = argv[++i];
+        } else if (strcmp(argv[i], "--vsync") == 0) {
+            vsync = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "--tick-rate") == 0) {
+            simTickRate = (float)atof(argv[++i]);
+            if (simTickRate < 10.0f) simTickRate = 10.0f;
+        } else if (i + 1 < argc && strcmp(argv[i], "--fps") == 0) {
+            targetFrameRate = atoi(argv[++i]);
+            if (targetFrameRate < 0) targetFrameRate = 0;
+            fpsGiven = true;
+        }
+    }
+    
+    // No GL context needed - run before glutInit so it works without a display
+    if (headless) {
+        FILE* checksumFile = NULL;
+        if (checksumPath) {
+            checksumFile = fopen(checksumPath, "w");
+            if (!checksumFile) {
+                fprintf(stderr, "Cannot open checksum file: %s\n", checksumPath);
+                return 1;
+            }
+        }
+        int result = runHeadlessSimulation(headlessTicks, simTickRate, seed, checksumFile);
+        if (checksumFile) fclose(checksumFile);
+        return result;
+    }
+    
+    // A replay brings its own seed and tick rate
+    if (replayPath) {
+        if (!replayPlayer.open(replayPath)) {
+            fprintf(stderr, "Cannot read replay log: %s\n", replayPath);
+            return 1;
+        }
+        if (replayPlayer.header().stateWords != (uint32_t)SIM_STATE_WORDS ||
+            replayPlayer.header().viewWords != (uint32_t)REPLAY_VIEW_WORDS) {
+            fprintf(stderr, "Replay log was recorded by an incompatible build: %s\n", replayPath);
+            return 1;
+        }
+        seed = replayPlayer.header().seed;
+        simTickRate = replayPlayer.header().tickRate;
+        replayMode = true;
+        recordPath = NULL;
+    }
+    
+    initSimulation(sim, seed);
+    
+    // Console output and the CSV log are written on the event thread
+    if (!rallyLog.start(rallyEvents, true, eventLogPath)) {
+        fprintf(stderr, "Cannot create event log: %s\n", eventLogPath);
+        return 1;
+    }
+    sim.events = &rallyEvents;
+    atexit(stopRallyLog);
+    
+    if (replayMode) {
+        seekReplay(0);
+    } else if (recordPath) {
+        if (!replayRecorder.start(recordPath, seed, simTickRate, SIM_STATE_WORDS,
+                                  REPLAY_VIEW_WORDS, REPLAY_KEYFRAME_INTERVAL)) {
+            fprintf(stderr, "Cannot create replay log: %s\n", recordPath);
+            return 1;
+        }
+        recordReplayKeyframe();
+        atexit(stopRecording);
+    }
+    
     glutInit(&argc, argv);
-    // Enable MSAA (Anti-aliasing) for smooth edges
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH | GLUT_MULTISAMPLE);
-    glutInitWindowSize(1280, 720);
+    // Enable MSAA (Anti-aliasing) for smooth edges - with --budget the
+    // scene framebuffer is multisampled instead, so the window is not
+    if (qualityBudget > 0.0f) {
+        glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
+    } else {
+        glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH | GLUT_MULTISAMPLE);
+    }
+    glutInitWindowSize(captureWidth, captureHeight);
     glutCreateWindow("Pickleball Playground Scene - Enhanced Graphics");
     
     init();
     
+    if (qualityBudget > 0.0f) {
+        if (sceneTarget.isSupported()) {
+            useSceneTarget = true;
+            registerQualityKnobs();
+            governor.initGpu();
+            governor.setBudget(qualityBudget);
+            governor.setEnabled(true);
+            updateQualityStatus();
+        } else {
+            printf("Adaptive quality needs framebuffer objects (GL 3.0), running at full quality\n");
+        }
+    }
+    
+    if (captureTarget) {
+        // Frames keep this size even if the window is resized later
+        if (!frameCapture.start(captureFormat, captureTarget, captureWidth, captureHeight)) return 1;
+        atexit(stopCapture);
+    }
+    
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
     glutKeyboardFunc(keyboard);
     glutSpecialFunc(specialKeys);
-    glutTimerFunc(0, timer, 0);
+    glutIdleFunc(idle);
+    
+    // Swap interval set either way, so a driver default does not fight the pacer
+    if (!FramePacer::setSwapInterval(vsync ? 1 : 0) && vsync) {
+        printf("Vsync is not available, pacing with the timer\n");
+        vsync = false;
+    }
+    if (vsync && !fpsGiven) targetFrameRate = 0;
+    pacer.setTargetRate(targetFrameRate);
+    atexit(reportFramePacing);
     
     printf("=== Enhanced Pickleball Park Scene ===\n");
     printf("Controls:\n");
@@ -3751,9 +4193,31 @@ int main(int argc, char** argv) {
     printf("  A/D: Rotate camera\n");
     printf("  Q/E: Adjust camera height\n");
     printf("  R/F: Increase/Decrease wind\n");
+    printf("  P: Toggle profiler overlay\n");
+    printf("  G: Toggle adaptive quality (--budget)\n");
     printf("  SPACE: Pause/Resume\n");
+    printf("  [ / ]: Replay back/forward 10 s (--replay)\n");
     printf("  ESC: Exit\n");
+    char renderMode[32];
+    if (targetFrameRate > 0) snprintf(renderMode, sizeof(renderMode), "%d FPS%s", targetFrameRate, vsync ? " + vsync" : "");
+    else snprintf(renderMode, sizeof(renderMode), "%s", vsync ? "vsync" : "uncapped");
+    printf("Simulation: %.0f ticks/s, seed %llu, render: %s\n", simTickRate,
+           (unsigned long long)seed, renderMode);
+    if (replayMode) {
+        printf("Replaying %s: %lld ticks, %lld keyframes\n", replayPath,
+               replayPlayer.lastTick(), replayPlayer.keyframeCount());
+    } else if (recordPath) {
+        printf("Recording to %s\n", recordPath);
+    }
+    if (useSceneTarget) {
+        printf("Adaptive quality: %.1f ms frame budget\n", qualityBudget);
+    }
+    if (captureTarget) {
+        printf("Capturing %dx%d %s to %s\n", captureWidth, captureHeight,
+               captureFormat == CAPTURE_PNG ? "PNG" : "I420", captureTarget);
+    }
     
     glutMainLoop();
     return 0;
 }
+#endif // PICKLEBALL_NO_MAIN
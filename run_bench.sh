@@ -0,0 +1,17 @@
+#!/bin/sh
+# Build and run the offscreen scene benchmark (Linux, EGL).
+# Needs no display or GPU: Mesa llvmpipe is fine (LIBGL_ALWAYS_SOFTWARE=1 forces it).
+#
+# Usage: ./run_bench.sh [--frames N] [--warmup N] [--width W] [--height H]
+#                       [--scenario overview|court_close|night|heavy_wind]
+#                       [--out bench_results.json]
+#                       [--capture frames/frame_%05d.png | --capture-pipe "encoder command"]
+set -e
+cd "$(dirname "$0")"
+
+g++ -std=c++11 -O2 -Wall -DPICKLEBALL_NO_MAIN \
+    pickleball_scene.cpp Simulation.cpp ReplayLog.cpp FrameCapture.cpp RallyEventLog.cpp ModelLoader.cpp \
+    OffscreenGlut.cpp scene_bench.cpp \
+    -o scene_bench -pthread -lEGL -lGL -lGLU -lassimp
+
+./scene_bench "$@"
@@ -0,0 +1,294 @@
+/*
+ * scene_bench.cpp
+ * Offscreen render benchmark for the pickleball scene
+ *
+ * Renders the real scene code (pickleball_scene.cpp built with
+ * PICKLEBALL_NO_MAIN) into an EGL pbuffer, so it runs on CI machines
+ * with Mesa llvmpipe and no display. Each scenario flies a scripted
+ * camera path for N frames with a fixed simulation step and reports
+ * frame time (mean, p50, p99, max), draw items, GL state changes and
+ * primitives per frame. Results are printed and written as JSON.
+ * With --capture / --capture-pipe every measured frame is also captured
+ * (see FrameCapture.h), so the capture cost shows up in the frame times.
+ *
+ * Usage: scene_bench [--frames N] [--warmup N] [--width W] [--height H]
+ *                    [--scenario name] [--out results.json]
+ *                    [--capture pattern.png | --capture-pipe command]
+ */
+
+#include "OffscreenGlut.h"
+#include "Simulation.h"
+#include "RenderQueue.h"
+#include "GLExtensions.h"
+#include "FrameCapture.h"
+#include <GL/glut.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+
+// ============================================================================
+// SCENE ENTRY POINTS (pickleball_scene.cpp)
+// ============================================================================
+
+extern float timeOfDay;
+extern float cameraDistance;
+extern float cameraAngle;
+extern float cameraHeight;
+extern float simTickRate;
+extern float simAccumulator;
+extern SimulationState sim;
+extern SimulationState previousState;
+extern RenderQueue renderQueue;
+
+void init();
+void reshape(int w, int h);
+void renderFrame(float frameTime);
+
+// ============================================================================
+// SCENARIOS
+// ============================================================================
+
+struct BenchScenario {
+    const char* name;
+    const char* description;
+    float timeOfDay;
+    float windStrength;
+    // Camera at path position t (0..1 over the run)
+    void (*camera)(float t);
+};
+
+// Full orbit around the park from high up
+static void overviewPath(float t) {
+    cameraAngle = t * 360.0f;
+    cameraDistance = 30.0f;
+    cameraHeight = 15.0f;
+}
+
+// Low and close, swinging back and forth along the sideline
+static void courtClosePath(float t) {
+    cameraAngle = 90.0f + 40.0f * sinf(t * 6.2831853f);
+    cameraDistance = 8.0f;
+    cameraHeight = 3.0f;
+}
+
+// Half orbit, pulling in and out
+static void nightPath(float t) {
+    cameraAngle = t * 180.0f;
+    cameraDistance = 20.0f + 8.0f * sinf(t * 6.2831853f);
+    cameraHeight = 10.0f;
+}
+
+static void windPath(float t) {
+    cameraAngle = 45.0f + t * 90.0f;
+    cameraDistance = 18.0f;
+    cameraHeight = 6.0f;
+}
+
+static const BenchScenario SCENARIOS[] = {
+    {"overview",    "Orbit at 30 m, noon",              0.5f,  1.0f, overviewPath},
+    {"court_close", "Sideline close-up at 8 m, noon",   0.5f,  1.0f, courtClosePath},
+    {"night",       "Floodlights and lamps on",         0.9f,  1.0f, nightPath},
+    {"heavy_wind",  "Wind strength 3 (max), afternoon", 0.45f, 3.0f, windPath},
+};
+static const int SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+struct BenchResult {
+    const BenchScenario* scenario;
+    int frames;
+    double meanMs, p50Ms, p99Ms, maxMs;
+    double drawItems;            // Render queue items per frame
+    double stateChanges;         // GL state changes per frame
+    double primitives;           // GL_PRIMITIVES_GENERATED per frame, < 0 = unavailable
+};
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = (size_t)ceil(p * sorted.size());
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+static BenchResult runScenario(const BenchScenario& scenario, int frames, int warmup,
+                               GLuint primitiveQuery, FrameCapture& capture) {
+    // Same rally and same lighting every run
+    initSimulation(sim);
+    sim.windStrength = scenario.windStrength;
+    previousState = sim;
+    simAccumulator = 0.0f;
+    timeOfDay = scenario.timeOfDay;
+
+    float dt = 1.0f / simTickRate;
+    std::vector<double> frameMs;
+    frameMs.reserve(frames);
+    double drawItems = 0.0, stateChanges = 0.0, primitives = 0.0;
+
+    for (int i = -warmup; i < frames; i++) {
+        scenario.camera(i < 0 ? 0.0f : (float)i / frames);
+
+        if (primitiveQuery) glExt().beginQuery(GL_PRIMITIVES_GENERATED, primitiveQuery);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        renderFrame(dt);
+        if (i >= 0) capture.captureFrame(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
+        glFinish();  // Count the GPU (or llvmpipe) work, not just submission
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (primitiveQuery) glExt().endQuery(GL_PRIMITIVES_GENERATED);
+
+        if (i < 0) continue;  // Warm-up: static scene build, texture uploads
+        frameMs.push_back(ms);
+        drawItems += renderQueue.drawCount;
+        stateChanges += renderQueue.stateChanges;
+        if (primitiveQuery) {
+            GLuint count = 0;
+            glExt().getQueryObjectiv(primitiveQuery, GL_QUERY_RESULT, (GLint*)&count);
+            primitives += count;
+        }
+    }
+
+    BenchResult result;
+    result.scenario = &scenario;
+    result.frames = frames;
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (size_t i = 0; i < frameMs.size(); i++) total += frameMs[i];
+    result.meanMs = frames > 0 ? total / frames : 0.0;
+    result.p50Ms = frames > 0 ? percentile(sorted, 0.50) : 0.0;
+    result.p99Ms = frames > 0 ? percentile(sorted, 0.99) : 0.0;
+    result.maxMs = frames > 0 ? sorted.back() : 0.0;
+    result.drawItems = frames > 0 ? drawItems / frames : 0.0;
+    result.stateChanges = frames > 0 ? stateChanges / frames : 0.0;
+    result.primitives = (primitiveQuery && frames > 0) ? primitives / frames : -1.0;
+    return result;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+// Escape for a JSON string value (driver strings may contain quotes)
+static std::string jsonString(const char* text) {
+    std::string out = "\"";
+    for (const char* c = text ? text : ""; *c; c++) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        if ((unsigned char)*c >= 0x20) out += *c;
+    }
+    return out + "\"";
+}
+
+static bool writeJson(const char* path, const std::vector<BenchResult>& results,
+                      int width, int height, int warmup) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n");
+    fprintf(f, "  \"renderer\": %s,\n", jsonString((const char*)glGetString(GL_RENDERER)).c_str());
+    fprintf(f, "  \"gl_version\": %s,\n", jsonString((const char*)glGetString(GL_VERSION)).c_str());
+    fprintf(f, "  \"width\": %d,\n  \"height\": %d,\n", width, height);
+    fprintf(f, "  \"tick_rate\": %.0f,\n  \"warmup_frames\": %d,\n", simTickRate, warmup);
+    fprintf(f, "  \"scenarios\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"name\": %s,\n", jsonString(r.scenario->name).c_str());
+        fprintf(f, "      \"description\": %s,\n", jsonString(r.scenario->description).c_str());
+        fprintf(f, "      \"frames\": %d,\n", r.frames);
+        fprintf(f, "      \"frame_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+                r.meanMs, r.p50Ms, r.p99Ms, r.maxMs);
+        fprintf(f, "      \"draw_items_per_frame\": %.1f,\n", r.drawItems);
+        fprintf(f, "      \"state_changes_per_frame\": %.1f,\n", r.stateChanges);
+        if (r.primitives >= 0.0) fprintf(f, "      \"primitives_per_frame\": %.0f\n", r.primitives);
+        else fprintf(f, "      \"primitives_per_frame\": null\n");
+        fprintf(f, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv) {
+    int frames = 300;
+    int warmup = 30;
+    int width = 1280;
+    int height = 720;
+    const char* only = NULL;
+    const char* outPath = "bench_results.json";
+    const char* captureTarget = NULL;
+    CaptureFormat captureFormat = CAPTURE_PNG;
+
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0) frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0) warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--width") == 0) width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--height") == 0) height = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scenario") == 0) only = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0) outPath = argv[++i];
+        else if (strcmp(argv[i], "--capture") == 0) {
+            captureTarget = argv[++i];
+            captureFormat = CAPTURE_PNG;
+        } else if (strcmp(argv[i], "--capture-pipe") == 0) {
+            captureTarget = argv[++i];
+            captureFormat = CAPTURE_YUV_PIPE;
+        }
+    }
+    if (frames < 1) frames = 1;
+    if (warmup < 0) warmup = 0;
+
+    if (!createOffscreenContext(width, height)) return 1;
+
+    init();
+    reshape(width, height);
+
+    // Primitive counts need GL 3.0 queries (llvmpipe has them)
+    GLExtensions& ext = loadGLExtensions();
+    GLuint primitiveQuery = 0;
+    if (ext.genQueries && hasGLVersion(3, 0)) ext.genQueries(1, &primitiveQuery);
+    
+    FrameCapture capture;
+    if (captureTarget && !capture.start(captureFormat, captureTarget, width, height)) return 1;
+
+    printf("=== Scene benchmark ===\n");
+    printf("Renderer: %s (%s)\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    printf("%dx%d, %d frames per scenario (+%d warm-up)\n\n", width, height, frames, warmup);
+    printf("%-12s %9s %9s %9s %9s %7s %7s %10s\n",
+           "scenario", "mean ms", "p50 ms", "p99 ms", "max ms", "items", "states", "prims");
+
+    std::vector<BenchResult> results;
+    for (int s = 0; s < SCENARIO_COUNT; s++) {
+        if (only && strcmp(only, SCENARIOS[s].name) != 0) continue;
+        BenchResult r = runScenario(SCENARIOS[s], frames, warmup, primitiveQuery, capture);
+        printf("%-12s %9.3f %9.3f %9.3f %9.3f %7.0f %7.0f %10.0f\n",
+               r.scenario->name, r.meanMs, r.p50Ms, r.p99Ms, r.maxMs,
+               r.drawItems, r.stateChanges, r.primitives);
+        results.push_back(r);
+    }
+
+    if (capture.isCapturing()) {
+        capture.stop();
+        CaptureStats stats = capture.stats();
+        printf("\nCapture: %lld frames written, %lld dropped, %lld readback stalls\n",
+               stats.written, stats.dropped, stats.stalls);
+    }
+    
+    if (results.empty()) {
+        fprintf(stderr, "Unknown scenario: %s\n", only);
+        return 1;
+    }
+    if (!writeJson(outPath, results, width, height, warmup)) {
+        fprintf(stderr, "Cannot write %s\n", outPath);
+        return 1;
+    }
+    printf("\nResults written to %s\n", outPath);
+
+    if (primitiveQuery) ext.deleteQueries(1, &primitiveQuery);
+    destroyOffscreenContext();
+    return 0;
+}